@@ -25,6 +25,44 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "bitmapeffectblur.h"
 
+// The box blur's window sums are computed four at a time using SSE2 on x86
+// (under the same conditions as the SSE2 combiners).
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#define BLUR_SSE2
+#include <emmintrin.h>
+extern bool surface_has_sse2(void);
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The blurs divide every output value by a constant (the area of the box, for
+// example). This structure does such divisions with a multiply and shift
+// instead, which gives exactly the same result as '/' for any value less than
+// 2^31 (using the round-up method of Granlund and Montgomery).
+struct MCBitmapEffectDivisor
+{
+	uint32_t multiplier;
+	uint32_t shift;
+
+	void Initialize(uint32_t p_divisor)
+	{
+		// The shift is 31 + ceil(log2(divisor)), the multiplier is then the
+		// 2^shift / divisor rounded up (which always fits in 32 bits).
+		uint32_t t_log;
+		t_log = 0;
+		while ((1u << t_log) < p_divisor)
+			t_log += 1;
+
+		shift = 31 + t_log;
+		multiplier = (uint32_t)(((uint64_t)1 << shift) / p_divisor + 1);
+	}
+
+	uint32_t Divide(uint32_t p_value) const
+	{
+		return (uint32_t)(((uint64_t)p_value * multiplier) >> shift);
+	}
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 
 // This is the MCBitmapEffectBlur opaque type definition. Its implemented as a
@@ -283,6 +321,10 @@ struct MCBitmapEffectFastGaussianBlur: public MCBitmapEffectBlur
 	void Process(uint8_t *mask);
 	void Finalize(void);
 
+	////
+
+	void SumRow(uint32_t *p_row, int32_t p_from, int32_t p_to);
+
 	int32_t radius;
 	uint32_t *kernel;
 
@@ -300,6 +342,10 @@ struct MCBitmapEffectFastGaussianBlur: public MCBitmapEffectBlur
 	uint32_t buffer_stride;
 	uint32_t buffer_height;
 	uint32_t buffer_nextrow;
+
+	// This is true if the horizontal and vertical sums can't overflow, in which
+	// case the saturation checks can be skipped.
+	bool unsaturated;
 };
 
 bool MCBitmapEffectFastGaussianBlur::Initialize(const MCBitmapEffectBlurParameters& params, const MCRectangle& input_rect, const MCRectangle& output_rect, uint32_t *src_pixels, uint32_t src_stride)
@@ -330,10 +376,26 @@ bool MCBitmapEffectFastGaussianBlur::Initialize(const MCBitmapEffectBlurParamete
 			kernel[i] = (uint32_t) (lk[t_spread_radius] * 0x10000 / t_sum);
 
 		// MW-2009-08-24: Memory leak :o)
-		delete lk;
+		delete[] lk;
+
+		// The largest horizontal sum is 255 times the kernel total, and the
+		// largest vertical sum is the kernel total times the largest horizontal
+		// sum (shifted down by 16 bits).
+		uint64_t t_kernel_total;
+		t_kernel_total = 0;
+		for(uint32_t i = 0; i < t_width; i++)
+			t_kernel_total += kernel[i];
+
+		uint64_t t_max_hsum, t_max_vsum;
+		t_max_hsum = t_kernel_total * 255;
+		t_max_vsum = t_kernel_total * ((t_max_hsum < 0xFFFFFFFF ? t_max_hsum : 0xFFFFFFFF) >> 16);
+		unsaturated = t_max_hsum <= 0xFFFFFFFF && t_max_vsum <= 0xFFFFFFFF;
 	}
 	else
+	{
 		kernel = 0;
+		unsaturated = false;
+	}
 
 	width = output_rect . width;
 	height = output_rect . height;
@@ -356,6 +418,44 @@ bool MCBitmapEffectFastGaussianBlur::Initialize(const MCBitmapEffectBlurParamete
 	return true;
 }
 
+// Compute the horizontal sums for the current source row for x in
+// [p_from, p_to), clamping the kernel to the input and saturating.
+void MCBitmapEffectFastGaussianBlur::SumRow(uint32_t *p_row, int32_t p_from, int32_t p_to)
+{
+	uint32_t *t_kernel;
+	t_kernel = kernel + radius; // point to kernel midpoint
+
+	for(int32_t x = p_from; x < p_to; x++)
+	{
+		int32_t t_left, t_right;
+		t_left = MCU_max(-radius, left - x);
+		t_right = MCU_min(right - x - 1, radius);
+
+		int32_t t_hcount;
+		t_hcount = t_right - t_left;
+
+		uint32_t *t_kernel_ptr;
+		t_kernel_ptr = t_kernel + t_left;
+
+		uint32_t *t_pixel_ptr;
+		t_pixel_ptr = pixels + x + t_left;
+
+		uint32_t t_alpha;
+		t_alpha = 0;
+
+		for(int32_t j = t_hcount; j >= 0; j--)
+		{
+			uint32_t t_weighted = t_kernel_ptr[j] * (t_pixel_ptr[j] >> 24);
+			if ((0xFFFFFFFF - t_alpha) > t_weighted)
+				t_alpha += t_weighted;
+			else
+				t_alpha = 0xFFFFFFFF;
+		}
+
+		p_row[x] = t_alpha ;
+	}
+}
+
 void MCBitmapEffectFastGaussianBlur::Process(uint8_t *mask)
 {
 	if (kernel != NULL)
@@ -378,35 +478,38 @@ void MCBitmapEffectFastGaussianBlur::Process(uint8_t *mask)
 			{
 				uint32_t *t_mask = buffer + (buffer_stride * ((t_y + buffer_height) % buffer_height));
 
-				for(int32_t x = 0; x < width; x++)
+				// If the sums can't overflow, then the pixels for which the kernel
+				// lies entirely within the input can be done without clamping or
+				// saturation (with identical results).
+				int32_t t_inner_left, t_inner_right;
+				if (unsaturated)
 				{
-					int32_t t_left, t_right;
-					t_left = MCU_max(-radius, left - x);
-					t_right = MCU_min(right - x - 1, radius);
-
-					int32_t t_hcount;
-					t_hcount = t_right - t_left;
+					t_inner_left = MCU_min(MCU_max(0, left + radius), width);
+					t_inner_right = MCU_max(t_inner_left, MCU_min(width, right - radius));
+				}
+				else
+				{
+					t_inner_left = width;
+					t_inner_right = width;
+				}
 
-					uint32_t *t_kernel_ptr;
-					t_kernel_ptr = t_kernel + t_left;
+				SumRow(t_mask, 0, t_inner_left);
 
+				for(int32_t x = t_inner_left; x < t_inner_right; x++)
+				{
 					uint32_t *t_pixel_ptr;
-					t_pixel_ptr = pixels + x + t_left;
+					t_pixel_ptr = pixels + x - radius;
 
 					uint32_t t_alpha;
 					t_alpha = 0;
+					for(int32_t j = 2 * radius; j >= 0; j--)
+						t_alpha += kernel[j] * (t_pixel_ptr[j] >> 24);
 
-					for(int32_t j = t_hcount; j >= 0; j--)
-					{
-						uint32_t t_weighted = t_kernel_ptr[j] * (t_pixel_ptr[j] >> 24);
-						if ((0xFFFFFFFF - t_alpha) > t_weighted)
-							t_alpha += t_weighted;
-						else
-							t_alpha = 0xFFFFFFFF;
-					}
-
-					t_mask[x] = t_alpha ;
+					t_mask[x] = t_alpha;
 				}
+
+				SumRow(t_mask, t_inner_right, width);
+
 				pixels += stride;
 			}
 			buffer_nextrow = t_bottom + y + 1;
@@ -431,17 +534,31 @@ void MCBitmapEffectFastGaussianBlur::Process(uint8_t *mask)
 
 				int32_t t_y = t_top + y;
 
-				for (int32_t k = 0; k < t_vcount; k++)//, t_y++)
+				if (unsaturated)
 				{
-					uint32_t t_weighted = t_kernel_ptr[k] * (t_buffer_ptr[x] >> 16);
-					if ((0xFFFFFFFF - t_alpha) > t_weighted)
-						t_alpha += t_weighted;
-					else
-						t_alpha = 0xFFFFFFFF;
-					if (t_buffer_ptr < t_buffer_end)
-						t_buffer_ptr += buffer_stride;
-					else
-						t_buffer_ptr = buffer;
+					for (int32_t k = 0; k < t_vcount; k++)
+					{
+						t_alpha += t_kernel_ptr[k] * (t_buffer_ptr[x] >> 16);
+						if (t_buffer_ptr < t_buffer_end)
+							t_buffer_ptr += buffer_stride;
+						else
+							t_buffer_ptr = buffer;
+					}
+				}
+				else
+				{
+					for (int32_t k = 0; k < t_vcount; k++)//, t_y++)
+					{
+						uint32_t t_weighted = t_kernel_ptr[k] * (t_buffer_ptr[x] >> 16);
+						if ((0xFFFFFFFF - t_alpha) > t_weighted)
+							t_alpha += t_weighted;
+						else
+							t_alpha = 0xFFFFFFFF;
+						if (t_buffer_ptr < t_buffer_end)
+							t_buffer_ptr += buffer_stride;
+						else
+							t_buffer_ptr = buffer;
+					}
 				}
 
 				if (t_alpha < 0x1000000)
@@ -513,6 +630,9 @@ struct MCBitmapEffectBoxBlurPassInfo
 
 	int32_t buffer_nextrow;
 	int32_t buffer_needrow;
+
+	// Divides by the area of the box (window * window).
+	MCBitmapEffectDivisor divisor;
 };
 
 struct MCBitmapEffectBoxBlur: public MCBitmapEffectBlur
@@ -547,6 +667,10 @@ struct MCBitmapEffectBoxBlur: public MCBitmapEffectBlur
 	uint32_t *row_buffer;
 
 	uint32_t spread;
+
+	// Divides by the area of the last pass's box times 256 (the final scaling
+	// of the mask values).
+	MCBitmapEffectDivisor mask_divisor;
 };
 
 bool MCBitmapEffectBoxBlur::Initialize(const MCBitmapEffectBlurParameters& params, const MCRectangle& input_rect, const MCRectangle& output_rect, uint32_t *src_pixels, uint32_t src_stride)
@@ -609,6 +733,7 @@ bool MCBitmapEffectBoxBlur::Initialize(const MCBitmapEffectBlurParameters& param
 		t_radius -= t_pass->radius;
 
 		t_pass->window = t_pass->radius * 2 + 1;
+		t_pass->divisor . Initialize(t_pass->window * t_pass->window);
 		t_pass->left = MCU_max(t_left, t_buff_left);
 		t_pass->top = MCU_max(t_top, t_buff_top);
 		t_pass->right = MCU_min(t_right, t_buff_right);
@@ -645,6 +770,9 @@ bool MCBitmapEffectBoxBlur::Initialize(const MCBitmapEffectBlurParameters& param
 
 	row_buffer = new uint32_t[t_maxwidth];
 
+	if (m_passes > 0)
+		mask_divisor . Initialize(pass_info[m_passes - 1] . window * pass_info[m_passes - 1] . window * 256);
+
 	if (m_passes > 0)
 		pixels = src_pixels + stride * pass_info[0].top;
 	else
@@ -653,6 +781,49 @@ bool MCBitmapEffectBoxBlur::Initialize(const MCBitmapEffectBlurParameters& param
 	return true;
 }
 
+// Compute the box averages for x in [p_from, p_to) from the rows of the sum
+// buffer above and at the bottom of the box, when the box lies entirely within
+// the buffer.
+static void MCBitmapEffectBoxBlurSumRow(uint32_t *p_row, const uint32_t *p_top, const uint32_t *p_bottom, int32_t p_radius, const MCBitmapEffectDivisor& p_divisor, int32_t p_from, int32_t p_to)
+{
+	const uint32_t *t_top_left, *t_top_right, *t_bottom_left, *t_bottom_right;
+	t_top_left = p_top - p_radius - 1;
+	t_top_right = p_top + p_radius;
+	t_bottom_left = p_bottom - p_radius - 1;
+	t_bottom_right = p_bottom + p_radius;
+
+	int32_t x;
+	x = p_from;
+
+#ifdef BLUR_SSE2
+	if (surface_has_sse2())
+	{
+		// The division is done two lanes at a time as a 32x32->64-bit multiply
+		// and a shift, just as MCBitmapEffectDivisor does.
+		__m128i t_multiplier, t_shift;
+		t_multiplier = _mm_set1_epi32(p_divisor . multiplier);
+		t_shift = _mm_cvtsi32_si128(p_divisor . shift);
+
+		for(; x + 4 <= p_to; x += 4)
+		{
+			__m128i t_sum;
+			t_sum = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(t_top_left + x)), _mm_loadu_si128((const __m128i *)(t_bottom_right + x)));
+			t_sum = _mm_sub_epi32(t_sum, _mm_loadu_si128((const __m128i *)(t_top_right + x)));
+			t_sum = _mm_sub_epi32(t_sum, _mm_loadu_si128((const __m128i *)(t_bottom_left + x)));
+
+			__m128i t_even, t_odd;
+			t_even = _mm_srl_epi64(_mm_mul_epu32(t_sum, t_multiplier), t_shift);
+			t_odd = _mm_srl_epi64(_mm_mul_epu32(_mm_srli_epi64(t_sum, 32), t_multiplier), t_shift);
+
+			_mm_storeu_si128((__m128i *)(p_row + x), _mm_or_si128(t_even, _mm_slli_epi64(t_odd, 32)));
+		}
+	}
+#endif
+
+	for(; x < p_to; x++)
+		p_row[x] = p_divisor . Divide(t_top_left[x] + t_bottom_right[x] - t_top_right[x] - t_bottom_left[x]);
+}
+
 void MCBitmapEffectBoxBlur::CalculateRows(uint32_t p_pass)
 {
 	MCBitmapEffectBoxBlurPassInfo *t_pass = &pass_info[p_pass];
@@ -714,7 +885,16 @@ void MCBitmapEffectBoxBlur::CalculateRows(uint32_t p_pass)
 
 			int32_t t_area;
 			t_area = t_prev_pass->window * t_prev_pass->window;
-			for(int32_t x = 0; x < t_pass->width; x++)
+
+			// The pixels for which the box lies entirely within the previous
+			// pass don't need their offsets clamping.
+			int32_t t_inner_left, t_inner_right;
+			t_inner_left = MCU_min(MCU_max(0, t_rel_left + t_prev_pass->radius), t_pass->width);
+			t_inner_right = MCU_max(t_inner_left, MCU_min(t_pass->width, t_rel_right - t_prev_pass->radius));
+
+			int32_t x;
+			x = 0;
+			for(; x < t_inner_left; x++)
 			{
 				// calculate total = p(x-r, y-r) + p(x+r, y+r) - p(x+r, y-r) - p(x-r, y+r)
 				int32_t t_left, t_right;
@@ -723,6 +903,18 @@ void MCBitmapEffectBoxBlur::CalculateRows(uint32_t p_pass)
 				t_right = MCU_min(t_rel_right - x - 1, t_prev_pass->radius);
 				t_row_buffer[x] = (t_buff_top[x + t_left] + t_buff_bottom[x + t_right] - t_buff_top[x + t_right] - t_buff_bottom[x + t_left]) / t_area;
 			}
+
+			MCBitmapEffectBoxBlurSumRow(t_row_buffer, t_buff_top, t_buff_bottom, t_prev_pass->radius, t_prev_pass->divisor, x, t_inner_right);
+			x = t_inner_right;
+
+			for(; x < t_pass->width; x++)
+			{
+				int32_t t_left, t_right;
+				t_left = MCU_max(-t_prev_pass->radius, t_rel_left - x);
+				t_left -= 1;
+				t_right = MCU_min(t_rel_right - x - 1, t_prev_pass->radius);
+				t_row_buffer[x] = (t_buff_top[x + t_left] + t_buff_bottom[x + t_right] - t_buff_top[x + t_right] - t_buff_bottom[x + t_left]) / t_area;
+			}
 		}
 		else
 		{
@@ -830,7 +1022,15 @@ void MCBitmapEffectBoxBlur::Process(uint8_t *mask)
 				int32_t t_sum;
 				t_sum = t_buff_top[x + t_left] + t_buff_bottom[x + t_right] - t_buff_top[x + t_right] - t_buff_bottom[x + t_left];
 				if (t_sum <= t_max_val)
-					mask[x] = t_sum * spread / (t_area * 256);
+				{
+					// The divisor is only exact for values below 2^31.
+					uint32_t t_scaled;
+					t_scaled = t_sum * spread;
+					if (t_scaled < 0x80000000U)
+						mask[x] = mask_divisor . Divide(t_scaled);
+					else
+						mask[x] = t_scaled / (t_area * 256);
+				}
 				else
 					mask[x] = 0xFF;
 			}
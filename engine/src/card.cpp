@@ -84,6 +84,8 @@ MCCard::MCCard()
 
 	// MM-2012-11-05: [[ Object selection started/ended message ]]
 	m_selecting_objects = false;
+
+	m_name_index = nil;
 }
 
 MCCard::MCCard(const MCCard &cref) : MCObject(cref)
@@ -112,6 +114,8 @@ MCCard::MCCard(const MCCard &cref) : MCObject(cref)
 	
 	// MM-2012-11-05: [[ Object selection started/ended message ]]
 	m_selecting_objects = false;
+
+	m_name_index = nil;
 }
 
 MCCard::~MCCard()
@@ -136,6 +140,7 @@ MCCard::~MCCard()
 		MCDLlist *optr = savedata->remove(savedata);
 		delete optr;
 	}
+	freenameindex();
 }
 
 Chunk_term MCCard::gettype() const
@@ -230,6 +235,8 @@ void MCCard::close()
 	}
 	defbutton = odefbutton = NULL;
 	MCtooltip->clearmatch(this);
+	if (!opened)
+		freenameindex();
 }
 
 void MCCard::kfocus()
@@ -1324,6 +1331,50 @@ Exec_stat MCCard::handle(Handler_type htype, MCNameRef mess, MCParameter *params
 	return stat;
 }
 
+bool MCCard::resolvehandler(Handler_type htype, MCNameRef mess, MCObject *pass_from, MCObject*& r_owner, MCHandler*& r_handler)
+{
+	// A card which isn't open has to be prepared before it can handle a
+	// message, so the path can only be followed by sending it.
+	if (!opened)
+		return false;
+
+	if (!resolveself(htype, mess, r_handler))
+		return false;
+
+	if (r_handler != nil)
+	{
+		r_owner = this;
+		return true;
+	}
+
+	if (pass_from != nil)
+	{
+		// This follows the same order through the background groups as 'handle'.
+		if (objptrs != NULL)
+		{
+			MCObjptr *tptr = objptrs->prev();
+			do
+			{
+				MCGroup *optr = tptr->getrefasgroup();
+				if (optr != pass_from && optr != nil && optr -> isbackground())
+				{
+					if (!optr -> resolvehandler(htype, mess, nil, r_owner, r_handler))
+						return false;
+					if (r_handler != nil)
+						return true;
+				}
+				tptr = tptr->prev();
+			}
+			while (tptr != objptrs->prev());
+		}
+
+		if (parent != NULL)
+			return parent -> resolvehandler(htype, mess, this, r_owner, r_handler);
+	}
+
+	return true;
+}
+
 void MCCard::recompute()
 {
 	if (objptrs != NULL)
@@ -1578,6 +1629,8 @@ void MCCard::relayercontrol(MCControl *p_source, MCControl *p_target)
 	// Otherwise, remove the layer.
 	t_source_ptr -> remove(objptrs);
 	layer_removed(p_source, t_previous, t_next);
+	MCscriptepoch++;
+	MCcontrolepoch++;
 
 	// Now, replace the layer.
 	if (t_target_ptr != nil)
@@ -1604,6 +1657,7 @@ void MCCard::relayercontrol_remove(MCControl *p_control)
 	// Remove the control from the card's objptr list.
 	t_control_ptr -> remove(objptrs);
 	delete t_control_ptr;
+	MCcontrolepoch++;
 
 	// Remove the control from the stack's list.
 	getstack() -> removecontrol(p_control);
@@ -1620,6 +1674,7 @@ void MCCard::relayercontrol_insert(MCControl *p_control, MCControl *p_target)
 	t_control_ptr -> setparent(this);
 	t_control_ptr -> setref(p_control);
 	p_control -> setparent(this);
+	MCcontrolepoch++;
 
 	// Add the control to the stack's object list.
 	getstack() -> appendcontrol(p_control);
@@ -1651,6 +1706,7 @@ Exec_stat MCCard::relayer(MCControl *optr, uint2 newlayer)
 	uint2 oldlayer = 0;
 	if (!MCrelayergrouped)
 		count(CT_LAYER, CT_UNDEFINED, optr, oldlayer, True);
+	MCcontrolepoch++;
 	// MW-2011-08-18: [[ Redraw ]] Update to use redraw.
 	MCRedrawLockScreen();
 	optr->open(); // removing closes object
@@ -1818,6 +1874,18 @@ Boolean MCCard::countme(uint4 groupid, Boolean marked)
 	return False;
 }
 
+// Returns true if the given layer of the card should be searched for an object
+// of type 'otype' belonging to a 'ptype' (card or background).
+// MW-2011-08-08: [[ Groups ]] Use 'isbackground()' rather than !F_GROUP_ONLY.
+static bool MCCardLayerMatches(MCControl *p_layer, Chunk_term otype, Chunk_term ptype)
+{
+	Chunk_term ttype = p_layer -> gettype();
+	return ptype == CT_UNDEFINED
+	        || (otype == CT_GROUP && ttype == CT_GROUP)
+	        || (ptype != CT_BACKGROUND && ttype != CT_GROUP)
+	        || (ttype == CT_GROUP && ptype == CT_BACKGROUND) == static_cast<MCGroup *>(p_layer) -> isbackground();
+}
+
 Boolean MCCard::count(Chunk_term otype, Chunk_term ptype,
                       MCObject *stop, uint2 &num, Boolean dohc)
 {
@@ -1832,13 +1900,7 @@ Boolean MCCard::count(Chunk_term otype, Chunk_term ptype,
 		MCObjptr *optr = objptrs;
 		do
 		{
-			Chunk_term ttype = optr->getref()->gettype();
-
-			// MW-2011-08-08: [[ Groups ]] Use 'isbackground()' rather than !F_GROUP_ONLY.
-			if (ptype == CT_UNDEFINED
-			        || otype == CT_GROUP && ttype == CT_GROUP
-			        || ptype != CT_BACKGROUND && ttype != CT_GROUP
-			        || (ttype == CT_GROUP && ptype == CT_BACKGROUND) == static_cast<MCGroup *>(optr->getref())->isbackground())
+			if (MCCardLayerMatches(optr->getref(), otype, ptype))
 				if (optr->getref()->count(otype, stop, num))
 				{
 					if (!opened)
@@ -1926,11 +1988,7 @@ MCControl *MCCard::getchild(Chunk_term etype, const MCString &expression,
 					t_parent = t_parent -> getparent();
 				if (t_parent == this)
 				{
-					Chunk_term ttype = optr->getref()->gettype();
-					if (ptype == CT_UNDEFINED
-				        || otype == CT_GROUP && ttype == CT_GROUP
-				        || ptype != CT_BACKGROUND && ttype != CT_GROUP
-				        || (ttype == CT_GROUP && ptype == CT_BACKGROUND) == static_cast<MCGroup *>(optr->getref())->isbackground())
+					if (MCCardLayerMatches(optr->getref(), otype, ptype))
 					{
 						if (otype == CT_LAYER && t_object -> gettype() > CT_CARD || t_object -> gettype() == otype)
 							return (MCControl *)t_object;
@@ -1941,13 +1999,8 @@ MCControl *MCCard::getchild(Chunk_term etype, const MCString &expression,
 			do
 			{
 				MCControl *foundobj = NULL;
-				Chunk_term ttype = optr->getref()->gettype();
 
-				// MW-2011-08-08: [[ Groups ]] Use 'isbackground()' rather than !F_GROUP_ONLY.
-				if (ptype == CT_UNDEFINED
-				        || otype == CT_GROUP && ttype == CT_GROUP
-				        || ptype != CT_BACKGROUND && ttype != CT_GROUP
-				        || (ttype == CT_GROUP && ptype == CT_BACKGROUND) == static_cast<MCGroup *>(optr->getref())->isbackground())
+				if (MCCardLayerMatches(optr->getref(), otype, ptype))
 				{
 					if (!optr->getref()->getopened())
 						optr->getref()->setparent(this);
@@ -1983,13 +2036,8 @@ MCControl *MCCard::getchild(Chunk_term etype, const MCString &expression,
 				do
 				{
 					MCControl *foundobj = NULL;
-					Chunk_term ttype = optr->getref()->gettype();
 
-					// MW-2011-08-08: [[ Groups ]] Use 'isbackground()' rather than !F_GROUP_ONLY.
-					if (ptype == CT_UNDEFINED
-							|| otype == CT_GROUP && ttype == CT_GROUP
-							|| ptype != CT_BACKGROUND && ttype != CT_GROUP
-							|| (ttype == CT_GROUP && ptype == CT_BACKGROUND) == static_cast<MCGroup *>(optr->getref())->isbackground())
+					if (MCCardLayerMatches(optr->getref(), otype, ptype))
 						foundobj = optr->getref()->findid(otype, tofindid, True);
 					if (foundobj != NULL)
 					{
@@ -2012,15 +2060,14 @@ MCControl *MCCard::getchild(Chunk_term etype, const MCString &expression,
 		}
 		else
 		{
+			MCControl *t_indexed;
+			if (findcontrolbyname(otype, ptype, expression, t_indexed))
+				return t_indexed;
+
 			do
 			{
 				MCControl *foundobj = NULL;
-				Chunk_term ttype = optr->getref()->gettype();					
-				// MW-2011-08-08: [[ Groups ]] Use 'isbackground()' rather than !F_GROUP_ONLY.
-				if (ptype == CT_UNDEFINED
-					|| otype == CT_GROUP && ttype == CT_GROUP
-					|| ptype != CT_BACKGROUND && ttype != CT_GROUP
-					|| (ttype == CT_GROUP && ptype == CT_BACKGROUND) == static_cast<MCGroup *>(optr->getref())->isbackground())
+				if (MCCardLayerMatches(optr->getref(), otype, ptype))
 				{
 					if (!optr->getref()->getopened())
 						optr->getref()->setparent(this);
@@ -2044,13 +2091,8 @@ MCControl *MCCard::getchild(Chunk_term etype, const MCString &expression,
 	do
 	{
 		MCControl *foundobj = NULL;
-		Chunk_term ttype = optr->getref()->gettype();
 		
-		// MW-2011-08-08: [[ Groups ]] Use 'isbackground()' rather than !F_GROUP_ONLY.
-		if (ptype == CT_UNDEFINED
-		        || otype == CT_GROUP && ttype == CT_GROUP
-		        || ptype != CT_BACKGROUND && ttype != CT_GROUP
-		        || (ttype == CT_GROUP && ptype == CT_BACKGROUND) == static_cast<MCGroup *>(optr->getref())->isbackground())
+		if (MCCardLayerMatches(optr->getref(), otype, ptype))
 		{
 			if (!optr->getref()->getopened())
 				optr->getref()->setparent(this);
@@ -2184,6 +2226,7 @@ Boolean MCCard::removecontrol(MCControl *cptr, Boolean needredraw, Boolean cf)
 			// Remove the control from the card and close it.
 			optr->remove(objptrs);
 			delete optr;
+			MCcontrolepoch++;
 			if (opened)
 			{
 				cptr->close();
@@ -2245,6 +2288,7 @@ MCObjptr *MCCard::newcontrol(MCControl *cptr, Boolean needredraw)
 	newptr->setparent(this);
 	newptr->setref(cptr);
 	newptr->appendto(objptrs);
+	MCcontrolepoch++;
 
 	// MW-2011-08-19: [[ Layers ]] Notify the stack that a layer may have ben inserted.
 	layer_added(cptr, objptrs != newptr ? newptr -> prev() : nil, nil);
@@ -2368,6 +2412,204 @@ MCObjptr *MCCard::getobjptrforcontrol(MCControl *p_control)
 	return nil;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+// The name index holds every named control on the card, including those within
+// groups, in the order that getchild() searches them. Entries with the same
+// (caseless) name are chained in that order so the first which matches the type
+// of control being looked for is the one a search would have found. The index
+// is rebuilt when it is next used after MCcontrolepoch changes.
+
+#define NAME_INDEX_END 0xffffffffU
+
+struct MCCardNameIndexEntry
+{
+	// The caseless search key of the control's name.
+	uintptr_t key;
+	// The control, and the control in the card's layer list it is (or is within).
+	MCControl *control;
+	MCControl *layer;
+	// The next entry in the same bucket.
+	uint32_t next;
+};
+
+struct MCCardNameIndex
+{
+	uint32_t epoch;
+	uint32_t *buckets;
+	uint32_t bucket_count;
+	MCCardNameIndexEntry *entries;
+	uint32_t entry_count;
+	uint32_t entry_capacity;
+};
+
+static inline uint32_t MCCardNameIndexHash(uintptr_t p_key)
+{
+	uint32_t t_hash;
+	t_hash = (uint32_t)(p_key >> 3) * 2654435761U;
+	return t_hash ^ (t_hash >> 16);
+}
+
+static void MCCardNameIndexAdd(MCCardNameIndex *p_index, MCControl *p_control, MCControl *p_layer)
+{
+	// Controls with empty names never match.
+	if (!p_control -> isunnamed())
+	{
+		if (p_index -> entry_count == p_index -> entry_capacity)
+		{
+			uint32_t t_new_capacity;
+			t_new_capacity = p_index -> entry_capacity == 0 ? 64 : p_index -> entry_capacity * 2;
+			MCCardNameIndexEntry *t_new_entries;
+			t_new_entries = new MCCardNameIndexEntry[t_new_capacity];
+			if (p_index -> entry_count != 0)
+				memcpy(t_new_entries, p_index -> entries, sizeof(MCCardNameIndexEntry) * p_index -> entry_count);
+			delete[] p_index -> entries;
+			p_index -> entries = t_new_entries;
+			p_index -> entry_capacity = t_new_capacity;
+		}
+
+		MCCardNameIndexEntry& t_entry = p_index -> entries[p_index -> entry_count++];
+		t_entry . key = MCNameGetCaselessSearchKey(p_control -> getname());
+		t_entry . control = p_control;
+		t_entry . layer = p_layer;
+		t_entry . next = NAME_INDEX_END;
+	}
+
+	// A group is searched before its controls (see MCGroup::findname).
+	if (p_control -> gettype() == CT_GROUP)
+	{
+		MCControl *t_controls;
+		t_controls = static_cast<MCGroup *>(p_control) -> getfirstcontrol();
+		if (t_controls != NULL)
+		{
+			MCControl *t_control;
+			t_control = t_controls;
+			do
+			{
+				MCCardNameIndexAdd(p_index, t_control, p_layer);
+				t_control = t_control -> next();
+			}
+			while (t_control != t_controls);
+		}
+	}
+}
+
+static void MCCardNameIndexBuild(MCCardNameIndex *p_index, MCObjptr *p_objptrs)
+{
+	p_index -> entry_count = 0;
+
+	MCObjptr *t_objptr;
+	t_objptr = p_objptrs;
+	do
+	{
+		MCControl *t_layer;
+		t_layer = t_objptr -> getref();
+		if (t_layer != NULL)
+			MCCardNameIndexAdd(p_index, t_layer, t_layer);
+		t_objptr = t_objptr -> next();
+	}
+	while (t_objptr != p_objptrs);
+
+	// Keep the load factor at most one.
+	uint32_t t_bucket_count;
+	t_bucket_count = 16;
+	while (t_bucket_count < p_index -> entry_count)
+		t_bucket_count *= 2;
+	if (t_bucket_count != p_index -> bucket_count)
+	{
+		delete[] p_index -> buckets;
+		p_index -> buckets = new uint32_t[t_bucket_count];
+		p_index -> bucket_count = t_bucket_count;
+	}
+	for(uint32_t i = 0; i < t_bucket_count; i++)
+		p_index -> buckets[i] = NAME_INDEX_END;
+
+	// Chain the entries in reverse, so that each chain ends up in search order.
+	for(uint32_t i = p_index -> entry_count; i > 0; i--)
+	{
+		uint32_t t_bucket;
+		t_bucket = MCCardNameIndexHash(p_index -> entries[i - 1] . key) & (t_bucket_count - 1);
+		p_index -> entries[i - 1] . next = p_index -> buckets[t_bucket];
+		p_index -> buckets[t_bucket] = i - 1;
+	}
+
+	p_index -> epoch = MCcontrolepoch;
+}
+
+bool MCCard::findcontrolbyname(Chunk_term otype, Chunk_term ptype, const MCString& p_name, MCControl*& r_control)
+{
+	// The controls of a closed card are looked up again every time it is
+	// searched (see clean()) so the index is only used for open cards. Names
+	// with quotes might be of the form 'field "name"', which only a search
+	// will match.
+	if (!opened || objptrs == NULL || memchr(p_name . getstring(), '"', p_name . getlength()) != NULL)
+		return false;
+
+	if (m_name_index == nil)
+	{
+		m_name_index = new MCCardNameIndex;
+		memset(m_name_index, 0, sizeof(MCCardNameIndex));
+		MCCardNameIndexBuild(m_name_index, objptrs);
+	}
+	else if (m_name_index -> epoch != MCcontrolepoch)
+		MCCardNameIndexBuild(m_name_index, objptrs);
+
+	r_control = NULL;
+
+	// If there is no name of this form then no control can have it.
+	MCNameRef t_name;
+	t_name = MCNameLookupWithOldString(p_name, kMCCompareCaseless);
+	if (t_name == nil)
+		return true;
+
+	uintptr_t t_key;
+	t_key = MCNameGetCaselessSearchKey(t_name);
+
+	uint32_t t_entry_index;
+	t_entry_index = m_name_index -> buckets[MCCardNameIndexHash(t_key) & (m_name_index -> bucket_count - 1)];
+	while (t_entry_index != NAME_INDEX_END)
+	{
+		MCCardNameIndexEntry& t_entry = m_name_index -> entries[t_entry_index];
+		t_entry_index = t_entry . next;
+		if (t_entry . key != t_key)
+			continue;
+
+		if (!MCCardLayerMatches(t_entry . layer, otype, ptype))
+			continue;
+
+		// A group matches by name only itself, the other controls check the
+		// type in their findname().
+		if (t_entry . control -> gettype() == CT_GROUP)
+		{
+			if (otype != CT_GROUP && otype != CT_LAYER)
+				continue;
+		}
+		else if (t_entry . control -> findname(otype, p_name) == NULL)
+			continue;
+
+		if (!t_entry . layer -> getopened())
+			t_entry . layer -> setparent(this);
+		if (t_entry . control -> getparent() -> gettype() == CT_STACK)
+			t_entry . control -> setparent(this);
+
+		r_control = t_entry . control;
+		break;
+	}
+
+	return true;
+}
+
+void MCCard::freenameindex(void)
+{
+	if (m_name_index == nil)
+		return;
+
+	delete[] m_name_index -> buckets;
+	delete[] m_name_index -> entries;
+	delete m_name_index;
+	m_name_index = nil;
+}
+
 void MCCard::clean()
 {
 	if (objptrs == NULL || state & CS_OWN_CONTROLS)
@@ -2398,6 +2640,7 @@ void MCCard::clear()
 {
 	if (state & CS_OWN_CONTROLS)
 		return;
+	MCcontrolepoch++;
 	MCObjptr *tptr = objptrs;
 	do
 	{
@@ -19,6 +19,8 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "object.h"
 
+struct MCCardNameIndex;
+
 class MCCard : public MCObject
 {
 	friend class MCHccard;
@@ -40,6 +42,10 @@ protected:
 	// MM-2012-11-05: [[ Object selection started/ended message ]]
 	bool m_selecting_objects : 1;
 
+	// The index of the card's controls by name - only kept while the card is
+	// open.
+	MCCardNameIndex *m_name_index;
+
 	static MCRectangle selrect;
 	static int2 startx;
 	static int2 starty;
@@ -78,6 +84,7 @@ public:
 	virtual void paste(void);
 
 	virtual Exec_stat handle(Handler_type, MCNameRef, MCParameter *, MCObject *pass_from);
+	virtual bool resolvehandler(Handler_type, MCNameRef, MCObject *pass_from, MCObject*& r_owner, MCHandler*& r_handler);
 	virtual void recompute();
 	
 	// MW-2011-09-20: [[ Collision ]] Compute shape of card.
@@ -147,6 +154,12 @@ public:
 	MCObjptr *getobjptrs(void) { return objptrs; }
 	MCObjptr *getobjptrforcontrol(MCControl *control);
 
+	// Look up the first control with the given name using the name index. This
+	// returns false if the index can't be used, in which case the objptrs must
+	// be searched.
+	bool findcontrolbyname(Chunk_term otype, Chunk_term ptype, const MCString& p_name, MCControl*& r_control);
+	void freenameindex(void);
+
 	void selectedbutton(uint2 n, Boolean bg, MCExecPoint &ep);
 	void grab()
 	{
@@ -307,6 +307,8 @@ Parse_stat MCDo::parse(MCScriptPoint &sp)
 {
 	initpoint(sp);
 	h = sp.gethandler();
+	if (h != nil)
+		h -> setcanpass();
 	if (sp.parseexp(False, True, &source) != PS_NORMAL)
 	{
 		MCperror->add(PE_DO_BADEXP, sp);
@@ -1335,17 +1335,19 @@ class MCFilter : public MCStatement
 {
 	MCChunk *container;
 	MCExpression *pattern;
+	Filter_pattern type;
 	Boolean out;
 public:
 	MCFilter()
 	{
 		container = NULL;
 		pattern = NULL;
+		type = FP_WILDCARD;
 		out = False;
 	}
 	virtual ~MCFilter();
-	Boolean match(char *s, char *p, Boolean casesensitive);
-	char *filterlines(char *sstring, char *pstring, Boolean casesensitive);
+	Boolean match(const char *s, const char *e, const char *p, Boolean casesensitive);
+	char *filterlines(const char *sptr, uint4 slength, const char *pstring, regexp *regex, Boolean casesensitive, uint4& r_length);
 	virtual Parse_stat parse(MCScriptPoint &);
 	virtual Exec_stat exec(MCExecPoint &);
 };
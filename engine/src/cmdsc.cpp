@@ -1944,6 +1944,7 @@ Exec_stat MCRemove::exec(MCExecPoint &ep)
 			lptr = lptr->next();
 		}
 		while (lptr != listptr);
+		MCscriptepoch++;
 	}
 	else
 	{
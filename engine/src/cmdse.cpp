@@ -119,11 +119,7 @@ Exec_stat MCAccept::exec(MCExecPoint &ep)
 
 	MCSocket *s = MCS_accept(port, ep.getobj(), t_message_name, datagram, secure, secureverify, NULL);
 	if (s != NULL)
-	{
-		MCU_realloc((char **)&MCsockets, MCnsockets,
-		            MCnsockets + 1, sizeof(MCSocket *));
-		MCsockets[MCnsockets++] = s;
-	}
+		IO_addsocket(s);
 
 	return ES_NORMAL;
 }
@@ -617,6 +613,7 @@ Exec_stat MCInsert::exec(MCExecPoint &ep)
 	}
 	MCObjectList *olptr = new MCObjectList(optr);
 	olptr->insertto(listptr);
+	MCscriptepoch++;
 	return ES_NORMAL;
 }
 
@@ -1977,6 +1974,7 @@ Exec_stat MCStart::exec(MCExecPoint &ep)
 		}
 		MCU_realloc((char **)&MCusing, MCnusing, MCnusing + 1, sizeof(MCStack *));
 		MCusing[MCnusing++] = sptr;
+		MCscriptepoch++;
 		if (sptr->message(MCM_library_stack) == ES_ERROR)
 			return ES_ERROR;
 	}
@@ -2185,6 +2183,7 @@ Exec_stat MCStop::exec(MCExecPoint &ep)
 						MCusing[i] = MCusing[i + 1];
 						i++;
 					}
+					MCscriptepoch++;
 					break;
 				}
 			sptr->message(MCM_release_stack);
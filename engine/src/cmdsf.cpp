@@ -40,6 +40,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "stacklst.h"
 #include "sellst.h"
 #include "util.h"
+#include "regex.h"
 #include "printer.h"
 #include "hc.h"
 #include "globals.h"
@@ -112,6 +113,7 @@ Exec_stat MCClose::exec(MCExecPoint &ep)
 {
 	char *name;
 	uint2 index;
+	uint4 sindex;
 
 	switch (arg)
 	{
@@ -163,9 +165,9 @@ Exec_stat MCClose::exec(MCExecPoint &ep)
 			return ES_ERROR;
 		}
 		name = ep.getsvalue().clone();
-		if (IO_findsocket(name, index))
+		if (IO_findsocket(name, sindex))
 		{
-			MCS_close_socket(MCsockets[index]);
+			MCS_close_socket(MCsockets[sindex]);
 			MCresult->clear(False);
 		}
 		else
@@ -1119,11 +1121,13 @@ MCFilter::~MCFilter()
 #define OPEN_BRACKET '['
 #define CLOSE_BRACKET ']'
 
-Boolean MCFilter::match(char *s, char *p, Boolean casesensitive)
+// The subject is the range [s, e) so that lines can be matched where they are
+// in the source, rather than being copied out and terminated first.
+Boolean MCFilter::match(const char *s, const char *e, const char *p, Boolean casesensitive)
 {
 	uint1 scc, c;
 
-	while (*s)
+	while (s < e)
 	{
 		scc = *s++;
 		c = *p++;
@@ -1144,7 +1148,7 @@ Boolean MCFilter::match(char *s, char *p, Boolean casesensitive)
 				{
 					c = *p++;
 					if (c == CLOSE_BRACKET && lc >= 0)
-						return ok ? match(s, p, casesensitive) : 0;
+						return ok ? match(s, e, p, casesensitive) : 0;
 					else
 						if (c == '-' && lc >= 0 && *p != CLOSE_BRACKET)
 						{
@@ -1188,16 +1192,16 @@ Boolean MCFilter::match(char *s, char *p, Boolean casesensitive)
 				return True;
 			--s;
 			c = *p;
-			while (*s)
+			while (s < e)
 				if ((casesensitive ? c != *s : MCS_tolower(c) != MCS_tolower(*s))
 				        && *p != '?' && *p != OPEN_BRACKET)
 					s++;
 				else
-					if (match(s++, p, casesensitive))
+					if (match(s++, e, p, casesensitive))
 						return True;
 			return False;
 		case 0:
-			return scc == 0;
+			return False;
 		default:
 			if (casesensitive)
 			{
@@ -1215,12 +1219,15 @@ Boolean MCFilter::match(char *s, char *p, Boolean casesensitive)
 	return *p == 0;
 }
 
-char *MCFilter::filterlines(char *sstring, char *pstring,
-                            Boolean casesensitive)
+// Copy the lines of the source which match the pattern (or don't, if filtering
+// 'without') into a new buffer, returning it and the length of its contents.
+// The source is scanned in place and each kept line is copied just once. If
+// 'regex' is not nil, it is used to match lines - otherwise 'pstring' is used
+// as a wildcard pattern.
+char *MCFilter::filterlines(const char *sptr, uint4 slength, const char *pstring, regexp *regex, Boolean casesensitive, uint4& r_length)
 {
 	uint4 offset = 0;
-	char *dstring = new char[strlen(sstring) + 1];
-	char *line;
+	char *dstring = new char[slength + 1];
 
 	// OK-2010-01-11: Bug 7649 - Filter command was incorrectly removing empty lines.
 	// Now does:
@@ -1228,65 +1235,62 @@ char *MCFilter::filterlines(char *sstring, char *pstring,
 	// 2. Do the filtering (now using strchr instead of strtok to fix the original bug)
 	// 3. If the filtered list is non-empty and had a terminal delimiter, put a return after it.
 
-	// Duplicate input string because the algorithm needs to change it.
-	char *t_string;
-	t_string = strdup(sstring);
-
-	// Keep a copy of the original pointer so it can be freed
-	char *t_original_string;
-	t_original_string = t_string;
-
-	// MW-2010-10-05: [[ Bug 9034 ]] If t_string is of zero length, then the next couple
+	// MW-2010-10-05: [[ Bug 9034 ]] If the source is of zero length, then the next couple
 	//   of lines will cause problems so return empty in this case.
-	uint32_t t_length;
-	t_length = strlen(t_string);
-	if (t_length == 0)
+	if (slength == 0)
 	{
-		free(t_original_string);
-		*dstring = '\0';
+		r_length = 0;
 		return dstring;
 	}
 
 	// Record whether or not the string was terminated with a trailing delimiter,
-	// if it was, then remove this trailing delimiter.
+	// if it was, then leave this trailing delimiter out of the scan.
+	const char *t_end;
+	t_end = sptr + slength;
+
 	bool t_was_terminated;
-	t_was_terminated = (t_string[t_length - 1] == '\n');
+	t_was_terminated = (t_end[-1] == '\n');
 	if (t_was_terminated)
-		t_string[t_length - 1] = '\0';
+		t_end -= 1;
 
+	const char *t_line;
+	t_line = sptr;
 	for(;;)
 	{
-		char *t_return;
-		t_return = strchr(t_string, '\n');
+		const char *t_return;
+		t_return = (const char *)memchr(t_line, '\n', t_end - t_line);
 
-		if (t_return != nil)
-			*t_return = '\0';
+		const char *t_line_end;
+		t_line_end = t_return != nil ? t_return : t_end;
 
-		line = t_string;
-		if (match(line, pstring, casesensitive) != out)
+		Boolean t_matched;
+		if (regex != nil)
+			t_matched = MCR_exec(regex, t_line, t_line_end - t_line) != 0;
+		else
+			t_matched = match(t_line, t_line_end, pstring, casesensitive);
+
+		if (t_matched != out)
 		{
 			if (offset)
 				dstring[offset++] = '\n';
 
 			// MW-2010-10-18: [[ Bug 7864 ]] This should be a 32-bit integer - removing 65535 char limit.
-			uint32_t length = strlen(line);
-			memcpy(&dstring[offset], line, length);
+			uint32_t length = t_line_end - t_line;
+			memcpy(&dstring[offset], t_line, length);
 			offset += length;
 		}
 
 		if (t_return == nil)
 			break;
 
-		t_string = t_return + 1;
+		t_line = t_return + 1;
 	}
 
 	if (offset != 0 && t_was_terminated)
 		dstring[offset++] = '\n';
 
-
-	free(t_original_string);
-
 	dstring[offset] = '\0';
+	r_length = offset;
 	return dstring;
 }
 
@@ -1316,6 +1320,24 @@ Parse_stat MCFilter::parse(MCScriptPoint &sp)
 	else
 		if (stat == PS_NORMAL)
 			out = True;
+
+	// The pattern can be qualified as either a 'wildcard pattern' (the default)
+	// or a 'regex pattern'. As these aren't reserved words, only treat them as
+	// such if followed by 'pattern'.
+	MCScriptPoint oldsp(sp);
+	if (sp.skip_token(SP_SUGAR, TT_UNDEFINED, SG_REGEX) == PS_NORMAL)
+	{
+		if (sp.skip_token(SP_SUGAR, TT_UNDEFINED, SG_PATTERN) == PS_NORMAL)
+			type = FP_REGEX;
+		else
+			sp = oldsp;
+	}
+	else if (sp.skip_token(SP_SUGAR, TT_UNDEFINED, SG_WILDCARD) == PS_NORMAL)
+	{
+		if (sp.skip_token(SP_SUGAR, TT_UNDEFINED, SG_PATTERN) != PS_NORMAL)
+			sp = oldsp;
+	}
+
 	if (sp.parseexp(False, True, &pattern) != PS_NORMAL)
 	{
 		MCperror->add
@@ -1332,19 +1354,44 @@ Exec_stat MCFilter::exec(MCExecPoint &ep)
 		MCeerror->add(EE_FILTER_CANTGET, line, pos);
 		return ES_ERROR;
 	}
-	char *sptr = ep.getsvalue().clone();
-	if (pattern->eval(ep) != ES_NORMAL)
+
+	// The pattern is evaluated into its own exec point, so that the source can
+	// be scanned where it is rather than being copied. The source may still
+	// refer to the container's value though, so it is only left there if the
+	// pattern is a literal or variable that cannot change it.
+	if (pattern -> getliteralvalue() == nil && pattern -> getrootvarref() == nil)
+		ep.grabsvalue();
+
+	MCExecPoint ep2(ep);
+	if (pattern->eval(ep2) != ES_NORMAL)
 	{
 		MCeerror->add(EE_FILTER_CANTGETPATTERN, line, pos);
-		delete sptr;
 		return ES_ERROR;
 	}
-	char *pptr = ep.getsvalue().clone();
-	char *dptr = filterlines(sptr, pptr, ep.getcasesensitive());
-	delete sptr;
+
+	// Regex patterns come from the compiled pattern cache, and are caseless
+	// unless caseSensitive is true (as for wildcard patterns).
+	regexp *t_regex;
+	t_regex = nil;
+	char *pptr;
+	pptr = nil;
+	if (type == FP_REGEX)
+	{
+		t_regex = MCR_compilecached(ep2.getsvalue().getstring(), ep2.getsvalue().getlength(), ep.getcasesensitive() ? 0 : MCR_CASELESS);
+		if (t_regex == nil)
+		{
+			MCeerror->add(EE_FILTER_BADREGEX, line, pos, MCR_geterror());
+			return ES_ERROR;
+		}
+	}
+	else
+		pptr = ep2.getsvalue().clone();
+
+	uint4 t_length;
+	char *dptr;
+	dptr = filterlines(ep.getsvalue().getstring(), ep.getsvalue().getlength(), pptr, t_regex, ep.getcasesensitive(), t_length);
 	delete pptr;
-	ep.copysvalue(dptr, strlen(dptr));
-	delete dptr;
+	ep.grabbuffer(dptr, t_length);
 	if (container->set(ep, PT_INTO) != ES_NORMAL)
 	{
 		MCeerror->add(EE_FILTER_CANTSET, line, pos);
@@ -2131,6 +2178,7 @@ Exec_stat MCOpen::exec(MCExecPoint &ep)
 	}
 	char *name = ep.getsvalue().clone();
 	uint2 index;
+	uint4 sindex;
 	IO_handle istream = NULL;
 	IO_handle ostream = NULL;
 	switch (arg)
@@ -2201,7 +2249,7 @@ Exec_stat MCOpen::exec(MCExecPoint &ep)
 			MCeerror->add(EE_NETWORK_NOPERM, line, pos);
 			return ES_ERROR;
 		}
-		if (IO_findsocket(name, index))
+		if (IO_findsocket(name, sindex))
 		{
 			MCresult->sets("socket is already open");
 			delete name;
@@ -2223,10 +2271,7 @@ Exec_stat MCOpen::exec(MCExecPoint &ep)
 			MCresult -> clear(True);
 			MCSocket *s = MCS_open_socket(name, datagram, ep.getobj(), t_message_name, secure, secureverify, NULL);
 			if (s != NULL)
-			{
-				MCU_realloc((char **)&MCsockets, MCnsockets, MCnsockets + 1, sizeof(MCSocket *));
-				MCsockets[MCnsockets++] = s;
-			}
+				IO_addsocket(s);
 			else
 				delete name;
 		}
@@ -2724,6 +2769,7 @@ Exec_stat MCRead::exec(MCExecPoint &ep)
 {
 	IO_handle stream = NULL;
 	uint2 index;
+	uint4 sindex;
 	int4 pindex = -1;
 	IO_stat stat = IO_NORMAL;
 	real8 duration = MAXUINT4;
@@ -2832,10 +2878,10 @@ Exec_stat MCRead::exec(MCExecPoint &ep)
 			pindex = index;
 			break;
 		case OA_SOCKET:
-			if (IO_findsocket(*name, index))
+			if (IO_findsocket(*name, sindex))
 			{
 				MCAutoNameRef t_message_name;
-				if (MCsockets[index] -> datagram && at == nil)
+				if (MCsockets[sindex] -> datagram && at == nil)
 				{
 					MCeerror -> add(EE_READ_NOTVALIDFORDATAGRAM, line, pos);
 					return ES_ERROR;
@@ -2875,7 +2921,7 @@ Exec_stat MCRead::exec(MCExecPoint &ep)
 					}
 					// MW-2012-10-26: [[ Bug 10062 ]] Make sure we clear the result.
 					MCresult->clear(False);
-					MCS_read_socket(MCsockets[index], ep, size, until, t_message_name);
+					MCS_read_socket(MCsockets[sindex], ep, size, until, t_message_name);
 				}
 				else
 				{
@@ -2891,7 +2937,7 @@ Exec_stat MCRead::exec(MCExecPoint &ep)
 					}
 					// MW-2012-10-26: [[ Bug 10062 ]] Make sure we clear the result.
 					MCresult->clear(False);
-					MCS_read_socket(MCsockets[index], ep, 0, sptr, t_message_name);
+					MCS_read_socket(MCsockets[sindex], ep, 0, sptr, t_message_name);
 				}
 				if (t_message_name == NULL)
 					it->set(ep);
@@ -3189,6 +3235,7 @@ Parse_stat MCWrite::parse(MCScriptPoint &sp)
 Exec_stat MCWrite::exec(MCExecPoint &ep)
 {
 	uint2 index;
+	uint4 sindex;
 	IO_handle stream = NULL;
 	IO_stat stat = IO_NORMAL;
 	Boolean textmode = False;
@@ -3263,7 +3310,7 @@ Exec_stat MCWrite::exec(MCExecPoint &ep)
 				textmode = MCprocesses[index].textmode;
 				break;
 			case OA_SOCKET:
-				if (IO_findsocket(name, index))
+				if (IO_findsocket(name, sindex))
 				{
 					MCAutoNameRef t_message_name;
 					if (at != NULL)
@@ -3283,7 +3330,7 @@ Exec_stat MCWrite::exec(MCExecPoint &ep)
 						return ES_ERROR;
 					}
 					MCresult->clear(False);
-					MCS_write_socket(ep.getsvalue(), MCsockets[index], ep.getobj(), t_message_name);
+					MCS_write_socket(ep.getsvalue(), MCsockets[sindex], ep.getobj(), t_message_name);
 				}
 				else
 					MCresult->sets("socket is not open");
@@ -298,6 +298,47 @@ Exec_stat MCDispatch::handle(Handler_type htype, MCNameRef mess, MCParameter *pa
 	return stat;
 }
 
+bool MCDispatch::resolvehandler(Handler_type htype, MCNameRef mess, MCObject *pass_from, MCObject*& r_owner, MCHandler*& r_handler)
+{
+	// This follows the same order through library stacks and backscripts as
+	// 'handle'.
+	for (uint32_t i = MCnusing; i > 0; i -= 1)
+	{
+		if (!MCusing[i - 1] -> resolvehandler(htype, mess, nil, r_owner, r_handler))
+			return false;
+		if (r_handler != nil)
+			return true;
+	}
+
+	if (MCbackscripts != NULL)
+	{
+		MCObjectList *optr = MCbackscripts;
+		do
+		{
+			if (!optr->getremoved())
+			{
+				if (!optr -> getobject() -> resolvehandler(htype, mess, nil, r_owner, r_handler))
+					return false;
+				if (r_handler != nil)
+					return true;
+			}
+			optr = optr->next();
+		}
+		while (optr != MCbackscripts);
+	}
+
+	// Externals and platform messages can't be looked up without calling them.
+	if (m_externals != nil)
+		return false;
+
+#if defined(TARGET_SUBPLATFORM_IPHONE) || defined(_MOBILE)
+	return false;
+#else
+	r_handler = nil;
+	return true;
+#endif
+}
+
 void MCDispatch::getmainstacknames(MCExecPoint &ep)
 {
 	ep.clear();
@@ -1572,7 +1613,10 @@ bool MCDispatch::loadexternal(const char *p_external)
 #endif
 	
 	if (m_externals == nil)
+	{
 		m_externals = new MCExternalHandlerList;
+		MCscriptepoch++;
+	}
 	
 	bool t_loaded;
 	t_loaded = m_externals -> Load(t_filename);
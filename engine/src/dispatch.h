@@ -64,6 +64,7 @@ public:
 	// dummy cut function for checking licensing
 	virtual Boolean cut(Boolean home);
 	virtual Exec_stat handle(Handler_type, MCNameRef, MCParameter *params, MCObject *pass_from);
+	virtual bool resolvehandler(Handler_type, MCNameRef, MCObject *pass_from, MCObject*& r_owner, MCHandler*& r_handler);
 	// MCDispatch functions
 	const char *getl(const MCString &s);
 	void getmainstacknames(MCExecPoint &);
@@ -167,3 +167,10 @@ const char *MCS_get_session_id(void)
 {
 	return "";
 }
+
+void MCS_get_script_cache_stats(uint32_t& r_hits, uint32_t& r_misses, uint32_t& r_invalidations)
+{
+	r_hits = 0;
+	r_misses = 0;
+	r_invalidations = 0;
+}
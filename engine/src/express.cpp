@@ -55,6 +55,11 @@ MCVarref *MCExpression::getrootvarref(void)
 	return NULL;
 }
 
+MCNameRef MCExpression::getliteralvalue(void)
+{
+	return nil;
+}
+
 MCVariable *MCExpression::evalvar(MCExecPoint& ep)
 {
 	return NULL;
@@ -595,6 +600,10 @@ MCFuncref::MCFuncref(MCNameRef inname)
 	/* UNCHECKED */ MCNameClone(inname, name);
 	handler = nil;
 	params = NULL;
+	pathcache . object = nil;
+	pathcache . owner = nil;
+	pathcache . handler = nil;
+	pathcache . epoch = 0;
 	resolved = false;
 }
 
@@ -738,7 +747,7 @@ Exec_stat MCFuncref::eval(MCExecPoint &ep)
 		{
 			// PASS STATE FIX
 			Exec_stat oldstat = stat;
-			stat = p->handle(HT_FUNCTION, name, params, p);
+			stat = p -> handlecached(pathcache, HT_FUNCTION, name, params);
 			if (oldstat == ES_PASS && stat == ES_NOT_HANDLED)
 				stat = ES_PASS;
 		}
@@ -56,6 +56,11 @@ public:
 	// same variable. It is designed to be used at parse-time, not exec-time.
 	virtual MCVarref *getrootvarref(void);
 
+	// Return the value of the expression if it is a (string) literal, or nil
+	// if it is anything else. Like 'getrootvarref' this is designed to be
+	// used at parse-time.
+	virtual MCNameRef getliteralvalue(void);
+
 	void setrank(Factor_rank newrank)
 	{
 		rank = newrank;
@@ -122,6 +127,7 @@ class MCFuncref : public MCExpression
 		MCHandler *handler;
 	MCObject *parent;
 	MCParameter *params;
+	MCHandlerPathCache pathcache;
 	bool resolved : 1;
 public:
 	MCFuncref(MCNameRef);
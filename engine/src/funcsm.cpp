@@ -38,25 +38,107 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "globals.h"
 
+// Parses the simplest (and most common) form of number - an optionally negative
+// decimal of at most 15 digits - directly. Such a number is an exact integer
+// divided by an exact power of ten, so the one division gives the correctly
+// rounded value just as strtod does. Anything else is left to MCU_stor8.
+static bool MCFunctionParseSimpleReal(const char *p_chars, uint4 p_length, real8& r_value)
+{
+	static const real8 s_powers_of_ten[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+		1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+	};
+
+	uint4 i;
+	i = 0;
+	bool t_negative;
+	t_negative = false;
+	if (p_length != 0 && p_chars[0] == '-')
+	{
+		t_negative = true;
+		i++;
+	}
+
+	uint64_t t_mantissa;
+	t_mantissa = 0;
+	uint4 t_digits, t_whole_digits, t_fraction_digits;
+	t_digits = t_whole_digits = t_fraction_digits = 0;
+	bool t_has_point;
+	t_has_point = false;
+	for(; i < p_length; i++)
+	{
+		char t_char;
+		t_char = p_chars[i];
+		if (t_char >= '0' && t_char <= '9')
+		{
+			if (++t_digits > 15)
+				return false;
+			t_mantissa = t_mantissa * 10 + (t_char - '0');
+			if (t_has_point)
+				t_fraction_digits++;
+			else
+				t_whole_digits++;
+		}
+		else if (t_char == '.' && !t_has_point && t_whole_digits != 0)
+			t_has_point = true;
+		else
+			return false;
+	}
+
+	if (t_whole_digits == 0)
+		return false;
+
+#if defined(__FLT_EVAL_METHOD__) && __FLT_EVAL_METHOD__ != 0
+	// With extended precision intermediates the division could be rounded twice.
+	if (t_fraction_digits != 0)
+		return false;
+#endif
+
+	// MCU_stor8 converts anything with an integer value through MCU_strtol, so
+	// '-0' (and '-0.0') is positive zero.
+	if (t_mantissa == 0)
+	{
+		r_value = 0.0;
+		return true;
+	}
+
+	real8 t_value;
+	t_value = (real8)(int64_t)t_mantissa;
+	if (t_fraction_digits != 0)
+		t_value /= s_powers_of_ten[t_fraction_digits];
+	r_value = t_negative ? -t_value : t_value;
+	return true;
+}
+
+static void MCFunctionAppendReal(real8*& x_values, uint4& x_count, uint4& x_capacity, real8 p_value)
+{
+	if (x_count == x_capacity)
+	{
+		uint4 t_new_capacity;
+		t_new_capacity = x_capacity == 0 ? 64 : x_capacity * 2;
+		real8 *t_new_values;
+		t_new_values = new real8[t_new_capacity];
+		if (x_count != 0)
+			memcpy(t_new_values, x_values, x_count * sizeof(real8));
+		delete[] x_values;
+		x_values = t_new_values;
+		x_capacity = t_new_capacity;
+	}
+	x_values[x_count++] = p_value;
+}
+
+// The values of the aggregate functions are collected into one buffer - either
+// from a comma-separated list, the elements of an array or a list of
+// parameters - and then the function is applied to the buffer as a whole by
+// MCU_dofunc.
 Exec_stat MCFunction::evalparams(Functions func, MCParameter *params,
                                  MCExecPoint &ep)
 {
-	uint4 nparams = 0;
-	real8 n, tn, oldn;
-	n = oldn = 0.0;
-	MCSortnode *mditems = NULL;
-	if (func == F_STD_DEV)
-	{ //use recursion to get average first
-		if (evalparams(F_AVERAGE, params, ep) != ES_NORMAL)
-			return ES_ERROR;
-		oldn = ep.getnvalue();
-	}
-	if (func == F_MEDIAN)
-	{ //use recursion to count items first
-		if (evalparams(F_UNDEFINED, params, ep) != ES_NORMAL)
-			return ES_ERROR;
-		mditems = new MCSortnode[(uint4)ep.getnvalue()];
-	}
+	real8 *t_values;
+	uint4 t_count, t_capacity;
+	t_values = NULL;
+	t_count = t_capacity = 0;
 	if (params != NULL && params->getnext() == NULL)
 	{
 		if (params->eval(ep) != ES_NORMAL)
@@ -66,10 +148,19 @@ Exec_stat MCFunction::evalparams(Functions func, MCParameter *params,
 		}
 		if (ep.getformat() == VF_ARRAY)
 		{
-			if (ep.getarray() -> is_array() && ep.getarray()->get_array()->dofunc(ep, func, nparams, n, oldn, mditems) != ES_NORMAL)
+			if (ep.getarray() -> is_array())
 			{
-				MCeerror->add(EE_FUNCTION_BADSOURCE, line, pos);
-				return ES_ERROR;
+				MCVariableArray *t_array;
+				t_array = ep.getarray() -> get_array();
+				t_capacity = t_array -> getnfilled();
+				if (t_capacity != 0)
+					t_values = new real8[t_capacity];
+				if (t_array -> getreals(ep, t_values, t_count) != ES_NORMAL)
+				{
+					delete[] t_values;
+					MCeerror->add(EE_FUNCTION_BADSOURCE, line, pos);
+					return ES_ERROR;
+				}
 			}
 		}
 		else
@@ -92,16 +183,17 @@ Exec_stat MCFunction::evalparams(Functions func, MCParameter *params,
 					MCU_skip_char(sptr, length);
 					MCU_skip_spaces(sptr, length);
 				}
+				real8 tn;
 				if (s.getlength() == 0)
 					tn = 0.0;
-				else
-					if (!MCU_stor8(s, tn))
-					{
-						MCeerror->add
-						(EE_FUNCTION_NAN, 0, 0, s);
-						return ES_ERROR;
-					}
-				MCU_dofunc(func, nparams, n, tn, oldn, mditems);
+				else if (!MCFunctionParseSimpleReal(s.getstring(), s.getlength(), tn) && !MCU_stor8(s, tn))
+				{
+					delete[] t_values;
+					MCeerror->add
+					(EE_FUNCTION_NAN, 0, 0, s);
+					return ES_ERROR;
+				}
+				MCFunctionAppendReal(t_values, t_count, t_capacity, tn);
 			}
 		}
 	}
@@ -112,41 +204,16 @@ Exec_stat MCFunction::evalparams(Functions func, MCParameter *params,
 		{
 			if (tparam->eval(ep) != ES_NORMAL || ep.ton() != ES_NORMAL)
 			{
+				delete[] t_values;
 				MCeerror->add(EE_FUNCTION_BADSOURCE, line, pos);
 				return ES_ERROR;
 			}
-			MCU_dofunc(func, nparams, n, ep.getnvalue(), oldn, mditems);
+			MCFunctionAppendReal(t_values, t_count, t_capacity, ep.getnvalue());
 			tparam = tparam->getnext();
 		}
 	}
-	if (nparams != 0)
-		switch (func)
-		{
-		case F_AVERAGE:
-			n /= nparams;
-			break;
-		case F_MEDIAN:
-			{
-				uint4 toffset;
-				MCU_sort(mditems, nparams, ST_ASCENDING, ST_NUMERIC);
-				toffset = (nparams + 1)/2 - 1;
-				if ((nparams % 2) != 0) //odd
-					n = mditems[toffset].nvalue;
-				else //even average 2 closest values
-					n = (mditems[toffset].nvalue + mditems[toffset+1].nvalue)/2;
-				break;
-			}
-		case F_STD_DEV:
-			n = sqrt(n/(nparams - 1));
-			break;
-		case F_UNDEFINED:
-			n = nparams;
-			break;
-		default:
-			break;
-		}
-	ep.setnvalue(n);
-	delete mditems;
+	ep.setnvalue(MCU_dofunc(func, t_values, t_count));
+	delete[] t_values;
 	return ES_NORMAL;
 }
 
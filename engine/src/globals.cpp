@@ -29,6 +29,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "stacklst.h"
 #include "dispatch.h"
 #include "hndlrlst.h"
+#include "handler.h"
 #include "pxmaplst.h"
 #include "cardlst.h"
 
@@ -223,7 +224,7 @@ real8 MCsockettimeout = 10.0;
 real8 MCmaxwait = 60.0;
 uint2 MCnfiles;
 uint2 MCnprocesses;
-uint2 MCnsockets;
+uint4 MCnsockets;
 MCStack **MCusing;
 uint2 MCnusing;
 uint2 MCiconicstacks;
@@ -257,6 +258,8 @@ MCStack *MCclickstackptr;
 MCStack *MCfocusedstackptr;
 MCCard *MCdynamiccard;
 Boolean MCdynamicpath;
+uint4 MCscriptepoch;
+uint4 MCcontrolepoch;
 MCObject *MCerrorptr;
 MCObject *MCerrorlockptr;
 MCObject *MCtargetptr;
@@ -643,6 +646,8 @@ void X_clear_globals(void)
 	MCfocusedstackptr = nil;
 	MCdynamiccard = nil;
 	MCdynamicpath = False;
+	MCscriptepoch = 0;
+	MCcontrolepoch = 0;
 	MCerrorptr = nil;
 	MCerrorlockptr = nil;
 	MCtargetptr = nil;
@@ -810,11 +815,8 @@ void X_clear_globals(void)
 	MCnullmcstring = NULL;
 
 	// MW-2013-03-11: [[ Bug 10713 ]] Make sure we reset the regex cache globals to nil.
-	for(uindex_t i = 0; i < PATTERN_CACHE_SIZE; i++)
-	{
-		MCregexpatterns[i] = nil;
-		MCregexcache[i] = nil;
-	}
+	MCR_initcache();
+	MCHandlerInitFragmentCache();
 
 	for(uint32_t i = 0; i < PI_NCURSORS; i++)
 		MCcursors[i] = nil;
@@ -1027,11 +1029,7 @@ int X_close(void)
 		delete MCfiles;
 	if (MCprocesses != NULL)
 		delete MCprocesses;
-	if (MCnsockets)
-		while (MCnsockets)
-			delete MCsockets[--MCnsockets];
-	if (MCsockets != NULL)
-		delete MCsockets;
+	IO_freesockets();
 
 	while (MCsavegroupptr != NULL)
 	{
@@ -1091,12 +1089,8 @@ int X_close(void)
 		MCglobals = MCglobals->getnext();
 		delete tvar;
 	}
-	uint2 i;
-	for (i = 0 ; i < PATTERN_CACHE_SIZE ; i++)
-	{
-		delete MCregexpatterns[i];
-		MCR_free(MCregexcache[i]);
-	}
+	MCR_freecache();
+	MCHandlerFreeFragmentCache();
 	delete MCperror;
 	delete MCeerror;
 
@@ -148,7 +148,7 @@ extern real8 MCsockettimeout;
 extern real8 MCmaxwait;
 extern uint2 MCnfiles;
 extern uint2 MCnprocesses;
-extern uint2 MCnsockets;
+extern uint4 MCnsockets;
 extern MCStack **MCusing;
 extern uint2 MCnusing;
 extern uint2 MCiconicstacks;
@@ -174,6 +174,15 @@ extern MCObject *MCtargetptr;
 extern MCObject *MCmenuobjectptr;
 extern MCCard *MCdynamiccard;
 extern Boolean MCdynamicpath;
+// Incremented whenever anything that affects where a message sent to an
+// object ends up changes - scripts, parentScripts, object ownership, open
+// state, inserted scripts and library stacks. Any cached message path
+// resolution is only valid while this is unchanged.
+extern uint4 MCscriptepoch;
+// Incremented whenever a control is renamed, or controls are added to, removed
+// from or moved within a card or group. Any cached lookup of controls by name is
+// only valid while this is unchanged.
+extern uint4 MCcontrolepoch;
 extern MCObject *MCerrorptr;
 extern MCObject *MCerrorlockptr;
 extern MCGroup *MCsavegroupptr;
@@ -1140,6 +1140,9 @@ Exec_stat MCGroup::setprop(uint4 parid, Properties p, MCExecPoint &ep, Boolean e
 		flags ^= F_GROUP_ONLY;
 		dirty = False;
 
+		// Background groups are part of the message path of their cards.
+		MCscriptepoch++;
+
 		// Compute whether the parent is a group
 		bool t_parent_is_group;
 		t_parent_is_group = false;
@@ -1884,6 +1887,7 @@ MCControl *MCGroup::getcontrols()
 void MCGroup::setcontrols(MCControl *newcontrols)
 {
 	controls = newcontrols;
+	MCcontrolepoch++;
 	if (controls != NULL)
 	{
 		MCControl *cptr = controls;
@@ -1908,6 +1912,7 @@ void MCGroup::setcontrols(MCControl *newcontrols)
 void MCGroup::appendcontrol(MCControl *newcontrol)
 {
 	newcontrol->appendto(controls);
+	MCcontrolepoch++;
 	computeminrect(False);
 	if (opened)
 	{
@@ -1926,6 +1931,7 @@ void MCGroup::appendcontrol(MCControl *newcontrol)
 void MCGroup::removecontrol(MCControl *cptr, Boolean cf)
 {
 	cptr = cptr->remove(controls);
+	MCcontrolepoch++;
 	if (opened)
 	{
 		cptr->close();
@@ -3147,6 +3153,7 @@ void MCGroup::relayercontrol(MCControl *p_source, MCControl *p_target)
 		return;
 
 	p_source -> remove(controls);
+	MCcontrolepoch++;
 	if (p_target == nil)
 		p_source -> appendto(controls);
 	else if (p_target == controls)
@@ -3161,6 +3168,7 @@ void MCGroup::relayercontrol(MCControl *p_source, MCControl *p_target)
 void MCGroup::relayercontrol_remove(MCControl *p_control)
 {
 	p_control -> remove(controls);
+	MCcontrolepoch++;
 	if (!computeminrect(False))
 		layer_redrawrect(p_control -> geteffectiverect());
 		
@@ -3169,6 +3177,7 @@ void MCGroup::relayercontrol_remove(MCControl *p_control)
 void MCGroup::relayercontrol_insert(MCControl *p_control, MCControl *p_target)
 {
 	p_control -> setparent(this);
+	MCcontrolepoch++;
 
 	if (p_target == nil)
 		p_control -> appendto(controls);
@@ -163,6 +163,10 @@ public:
 	// MW-2011-09-07: Return the group's minrect (contained control bounds).
 	const MCRectangle& getminrect(void) { return minrect; }
 
+	// Returns the first of the group's controls - unlike getcontrols() this
+	// doesn't update the group's layer number.
+	MCControl *getfirstcontrol(void) const { return controls; }
+
 	// MW-2012-03-01: [[ Bug 10045 ]] Clear the mfocus setting of the group without
 	//   dispatching any messages.
 	void clearmfocus(void);
@@ -41,6 +41,312 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 Boolean MCHandler::gotpass;
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Every time a handler executes it needs an array of parameter variables and
+// an array of local variables - its activation frame. Rather than allocating
+// these afresh on each call, the arrays and the variables in them are recycled
+// through free-lists. Arrays are kept in power-of-two size classes, and the
+// number of arrays and variables kept is bounded so that a deep recursion does
+// not hold on to its peak memory use forever.
+
+#define HANDLER_FRAME_CLASSES 17
+#define HANDLER_FRAME_MAX_ARRAYS 64
+#define HANDLER_FRAME_MAX_VARIABLES 1024
+
+static MCVariable **s_frame_arrays[HANDLER_FRAME_CLASSES];
+static uint32_t s_frame_array_counts[HANDLER_FRAME_CLASSES];
+static MCVariable *s_frame_variables = nil;
+static uint32_t s_frame_variable_count = 0;
+
+static MCVariable **MCHandlerFrameAcquireArray(uint32_t p_count, uint32_t& r_capacity)
+{
+	// Use the smallest class whose arrays are big enough.
+	uint32_t t_class;
+	t_class = 0;
+	while ((1U << t_class) < p_count)
+		t_class++;
+
+	r_capacity = 1 << t_class;
+
+	MCVariable **t_array;
+	t_array = s_frame_arrays[t_class];
+	if (t_array == nil)
+		return new MCVariable *[r_capacity];
+
+	s_frame_arrays[t_class] = *(MCVariable ***)t_array;
+	s_frame_array_counts[t_class]--;
+
+	return t_array;
+}
+
+static void MCHandlerFrameReleaseArray(MCVariable **p_array, uint32_t p_capacity)
+{
+	if (p_array == nil)
+		return;
+
+	// Use the largest class the array is big enough for - arrays which have been
+	// grown by 'newvar' need not have a power-of-two capacity.
+	uint32_t t_class;
+	t_class = 0;
+	while (t_class + 1 < HANDLER_FRAME_CLASSES && (2U << t_class) <= p_capacity)
+		t_class++;
+
+	if (s_frame_array_counts[t_class] >= HANDLER_FRAME_MAX_ARRAYS)
+	{
+		delete[] p_array;
+		return;
+	}
+
+	*(MCVariable ***)p_array = s_frame_arrays[t_class];
+	s_frame_arrays[t_class] = p_array;
+	s_frame_array_counts[t_class]++;
+}
+
+static MCVariable *MCHandlerFrameAcquireVariable(MCNameRef p_name)
+{
+	MCVariable *t_var;
+	t_var = s_frame_variables;
+	if (t_var == nil)
+	{
+		/* UNCHECKED */ MCVariable::createwithname(p_name, t_var);
+		return t_var;
+	}
+
+	s_frame_variables = t_var -> getnext();
+	s_frame_variable_count--;
+
+	t_var -> reset(p_name);
+
+	return t_var;
+}
+
+static void MCHandlerFrameReleaseVariable(MCVariable *p_var)
+{
+	if (s_frame_variable_count >= HANDLER_FRAME_MAX_VARIABLES)
+	{
+		delete p_var;
+		return;
+	}
+
+	// Drop the value and name straight away so that the pool doesn't keep them
+	// alive.
+	p_var -> reset(kMCEmptyName);
+	p_var -> setnext(s_frame_variables);
+	s_frame_variables = p_var;
+	s_frame_variable_count++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The fragment cache holds the statement lists parsed by 'do' and the
+// expressions parsed by 'value' (and the arguments of 'send'). A fragment can
+// only be reused in the context it was parsed in, so entries are keyed on the
+// text together with the object, handler list and handler of that context, the
+// line the fragment is reported at and the explicitVariables setting.
+//
+// As with the regex cache, entries are kept in an MCLRUCache. Fragments may
+// be executing (and so may be re-entered) when they are discarded, so each
+// entry counts its current uses and is only freed once the last of these is
+// done.
+
+#define HANDLER_FRAGMENT_CACHE_SIZE 256
+
+struct MCHandlerFragment: public MCLRUCacheEntry
+{
+	char *text;
+	uint4 length;
+	MCObject *object;
+	MCHandlerlist *hlist;
+	MCHandler *handler;
+	uint2 line;
+	bool is_expression : 1;
+	bool explicit_vars : 1;
+	bool discarded : 1;
+	MCStatement *statements;
+	MCExpression *expression;
+	uint4 line_count;
+	uint4 references;
+};
+
+static MCLRUCache s_fragment_cache;
+static uint4 s_fragment_capacity = HANDLER_FRAGMENT_CACHE_SIZE;
+static uint4 s_fragment_hits = 0;
+static uint4 s_fragment_misses = 0;
+
+static uint4 MCHandlerHashFragment(const MCString& p_text, MCHandler *p_handler, uint2 p_line)
+{
+	return MCHashChars(p_text . getstring(), p_text . getlength(), kMCCompareExact, (uint4)(uintptr_t)p_handler ^ p_line);
+}
+
+static void MCHandlerDeleteFragment(MCHandlerFragment *p_fragment)
+{
+	while (p_fragment -> statements != NULL)
+	{
+		MCStatement *t_statement;
+		t_statement = p_fragment -> statements;
+		p_fragment -> statements = t_statement -> getnext();
+		delete t_statement;
+	}
+	delete p_fragment -> expression;
+	delete[] p_fragment -> text;
+	delete p_fragment;
+}
+
+static void MCHandlerDiscardFragment(MCHandlerFragment *p_fragment)
+{
+	MCLRUCacheRemove(s_fragment_cache, p_fragment);
+
+	// If the fragment is still executing, the last use frees it.
+	if (p_fragment -> references != 0)
+		p_fragment -> discarded = true;
+	else
+		MCHandlerDeleteFragment(p_fragment);
+}
+
+static void MCHandlerTrimFragments(uint4 p_count)
+{
+	while(s_fragment_cache . count > p_count)
+		MCHandlerDiscardFragment(static_cast<MCHandlerFragment *>(s_fragment_cache . last_used));
+}
+
+// Look for a fragment parsed from the text in 'ep' in the given context. If
+// found, it is marked as in use until MCHandlerReleaseFragment is called.
+static MCHandlerFragment *MCHandlerFindFragment(MCExecPoint& ep, MCHandler *p_handler, uint2 p_line, bool p_expression)
+{
+	if (s_fragment_capacity == 0)
+		return NULL;
+
+	const MCString& t_text = ep . getsvalue();
+
+	uint4 t_hash;
+	t_hash = MCHandlerHashFragment(t_text, p_handler, p_line);
+
+	bool t_explicit_vars;
+	t_explicit_vars = p_expression && MCexplicitvariables == True;
+
+	for(MCLRUCacheEntry *t_link = MCLRUCacheGetBucket(s_fragment_cache, t_hash); t_link != NULL; t_link = t_link -> next_in_bucket)
+	{
+		MCHandlerFragment *t_fragment;
+		t_fragment = static_cast<MCHandlerFragment *>(t_link);
+		if (t_fragment -> hash == t_hash && t_fragment -> handler == p_handler &&
+			t_fragment -> hlist == ep . gethlist() && t_fragment -> object == ep . getobj() &&
+			t_fragment -> line == p_line && t_fragment -> is_expression == p_expression &&
+			t_fragment -> explicit_vars == t_explicit_vars &&
+			t_fragment -> length == t_text . getlength() && memcmp(t_fragment -> text, t_text . getstring(), t_fragment -> length) == 0)
+		{
+			s_fragment_hits++;
+			MCLRUCacheTouch(s_fragment_cache, t_fragment);
+			t_fragment -> references++;
+			return t_fragment;
+		}
+	}
+
+	s_fragment_misses++;
+
+	return NULL;
+}
+
+// Add a newly parsed fragment to the cache, marked as in use. The fragment
+// is only kept if reparsing it would give the same result, otherwise nil is
+// returned and the caller retains ownership. 'p_scope_size' is the size of the
+// handler's scope before parsing.
+static MCHandlerFragment *MCHandlerAddFragment(MCExecPoint& ep, MCHandler *p_handler, uint2 p_line, uint4 p_scope_size, MCStatement *p_statements, MCExpression *p_expression, uint4 p_line_count)
+{
+	if (s_fragment_capacity == 0)
+		return NULL;
+
+	// If the fragment declared or implicitly created any variables, reparsing
+	// it would do so again. If the handler has variables created by an earlier
+	// 'do', the fragment may refer to them but they vanish when the handler
+	// returns. When debugging, names can be resolved in other contexts.
+	if (p_handler == NULL || !p_handler -> hasonlydeclaredvars() ||
+		p_handler -> getscopesize() != p_scope_size || MCdebugcontext != MAXUINT2)
+		return NULL;
+
+	const MCString& t_text = ep . getsvalue();
+
+	MCHandlerTrimFragments(s_fragment_capacity - 1);
+
+	MCHandlerFragment *t_fragment;
+	t_fragment = new MCHandlerFragment;
+	t_fragment -> text = new char[t_text . getlength() + 1];
+	memcpy(t_fragment -> text, t_text . getstring(), t_text . getlength());
+	t_fragment -> text[t_text . getlength()] = '\0';
+	t_fragment -> length = t_text . getlength();
+	t_fragment -> hash = MCHandlerHashFragment(t_text, p_handler, p_line);
+	t_fragment -> object = ep . getobj();
+	t_fragment -> hlist = ep . gethlist();
+	t_fragment -> handler = p_handler;
+	t_fragment -> line = p_line;
+	t_fragment -> is_expression = p_expression != NULL;
+	t_fragment -> explicit_vars = p_expression != NULL && MCexplicitvariables == True;
+	t_fragment -> discarded = false;
+	t_fragment -> statements = p_statements;
+	t_fragment -> expression = p_expression;
+	t_fragment -> line_count = p_line_count;
+	t_fragment -> references = 1;
+	MCLRUCacheInsert(s_fragment_cache, t_fragment);
+
+	return t_fragment;
+}
+
+static void MCHandlerReleaseFragment(MCHandlerFragment *p_fragment)
+{
+	p_fragment -> references--;
+	if (p_fragment -> references == 0 && p_fragment -> discarded)
+		MCHandlerDeleteFragment(p_fragment);
+}
+
+// Discard all the fragments parsed in the context of the given handler, as
+// they refer to it.
+static void MCHandlerFlushFragments(MCHandler *p_handler)
+{
+	MCHandlerFragment *t_fragment;
+	t_fragment = static_cast<MCHandlerFragment *>(s_fragment_cache . first_used);
+	while(t_fragment != NULL)
+	{
+		MCHandlerFragment *t_next;
+		t_next = static_cast<MCHandlerFragment *>(t_fragment -> next_used);
+		if (t_fragment -> handler == p_handler)
+			MCHandlerDiscardFragment(t_fragment);
+		t_fragment = t_next;
+	}
+}
+
+void MCHandlerInitFragmentCache(void)
+{
+	MCLRUCacheInitialize(s_fragment_cache);
+	s_fragment_capacity = HANDLER_FRAGMENT_CACHE_SIZE;
+	s_fragment_hits = 0;
+	s_fragment_misses = 0;
+}
+
+void MCHandlerFreeFragmentCache(void)
+{
+	MCHandlerTrimFragments(0);
+	MCLRUCacheFinalize(s_fragment_cache);
+}
+
+uint4 MCHandlerGetFragmentCacheSize(void)
+{
+	return s_fragment_capacity;
+}
+
+void MCHandlerSetFragmentCacheSize(uint4 p_size)
+{
+	s_fragment_capacity = p_size;
+	MCHandlerTrimFragments(s_fragment_capacity);
+}
+
+void MCHandlerGetFragmentCacheStats(uint4& r_hits, uint4& r_misses)
+{
+	r_hits = s_fragment_hits;
+	r_misses = s_fragment_misses;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 MCHandler::MCHandler(uint1 htype, bool p_is_private)
 {
 	statements = NULL;
@@ -50,6 +356,7 @@ MCHandler::MCHandler(uint1 htype, bool p_is_private)
 	vinfo = NULL;
 	cinfo = NULL;
 	nglobals = nparams = nvnames = npnames = nconstants = executing = 0;
+	ndeclaredvnames = 0;
 	globals = NULL;
 	nglobals = 0;
 	prop = False;
@@ -57,11 +364,15 @@ MCHandler::MCHandler(uint1 htype, bool p_is_private)
 	type = htype;
 	fileindex = 0;
 	is_private = p_is_private ? True : False;
+	can_pass = False;
 	name = nil;
 }
 
 MCHandler::~MCHandler()
 {
+	if (s_fragment_cache . count != 0)
+		MCHandlerFlushFragments(this);
+
 	MCStatement *stmp;
 	while (statements != NULL)
 	{
@@ -264,6 +575,7 @@ Parse_stat MCHandler::parse(MCScriptPoint &sp, Boolean isprop)
 				}
 				lastline = sp.getline();
 				sp.skip_eol();
+				ndeclaredvnames = nvnames;
 				return PS_NORMAL;
 			default:
 				MCperror->add(PE_HANDLER_NOTCOMMAND, sp);
@@ -297,10 +609,14 @@ Exec_stat MCHandler::exec(MCExecPoint &ep, MCParameter *plist)
 		tptr = tptr->getnext();
 	uint2 newnparams = MCU_max(npassedparams, npnames);
 	MCVariable **newparams;
+	uint32_t t_params_capacity;
 	if (newnparams == 0)
+	{
 		newparams = NULL;
+		t_params_capacity = 0;
+	}
 	else
-		newparams = new MCVariable *[newnparams];
+		newparams = MCHandlerFrameAcquireArray(newnparams, t_params_capacity);
 
 	Boolean err = False;
 	for (i = 0 ; i < newnparams ; i++)
@@ -322,7 +638,7 @@ Exec_stat MCHandler::exec(MCExecPoint &ep, MCParameter *plist)
 					err = True;
 					break;
 				}
-				/* UNCHECKED */ MCVariable::createwithname(i < npnames ? pinfo[i] . name : kMCEmptyName, newparams[i]);
+				newparams[i] = MCHandlerFrameAcquireVariable(i < npnames ? pinfo[i] . name : kMCEmptyName);
 				newparams[i]->store(ep, False);
 			}
 			plist = plist->getnext();
@@ -334,15 +650,15 @@ Exec_stat MCHandler::exec(MCExecPoint &ep, MCParameter *plist)
 				err = True;
 				break;
 			}
-			/* UNCHECKED */ MCVariable::createwithname(i < npnames ? pinfo[i] . name : kMCEmptyName, newparams[i]);
+			newparams[i] = MCHandlerFrameAcquireVariable(i < npnames ? pinfo[i] . name : kMCEmptyName);
 		}
 	}
 	if (err)
 	{
 		while (i--)
 			if (i >= npnames || !pinfo[i].is_reference)
-				delete newparams[i];
-		delete newparams;
+				MCHandlerFrameReleaseVariable(newparams[i]);
+		MCHandlerFrameReleaseArray(newparams, t_params_capacity);
 		MCeerror->add(EE_HANDLER_BADPARAM, firstline - 1, 1, name);
 		return ES_ERROR;
 	}
@@ -354,15 +670,19 @@ Exec_stat MCHandler::exec(MCExecPoint &ep, MCParameter *plist)
 	uint2 oldnconstants = nconstants;
 	params = newparams;
 	nparams = newnparams;
+	uint32_t t_vars_capacity;
 	if (nvnames == 0)
+	{
 		vars = NULL;
+		t_vars_capacity = 0;
+	}
 	else
 	{
-		vars = new MCVariable *[nvnames];
+		vars = MCHandlerFrameAcquireArray(nvnames, t_vars_capacity);
 		i = nvnames;
 		while (i--)
 		{
-			/* UNCHECKED */ MCVariable::createwithname(vinfo[i] . name, vars[i]);
+			vars[i] = MCHandlerFrameAcquireVariable(vinfo[i] . name);
 
 			// A UQL is indicated by 'init' being nil.
 			if (vinfo[i] . init != nil)
@@ -465,11 +785,16 @@ Exec_stat MCHandler::exec(MCExecPoint &ep, MCParameter *plist)
 		i = newnparams;
 		while (i--)
 			if (i >= npnames || !pinfo[i].is_reference)
-				delete params[i];
-		delete params;
+				MCHandlerFrameReleaseVariable(params[i]);
+		MCHandlerFrameReleaseArray(params, t_params_capacity);
 	}
 	if (vars != NULL)
 	{
+		// If any variables were added while executing, 'newvar' will have
+		// replaced the array with one of exactly the new size.
+		if (nvnames != oldnvnames)
+			t_vars_capacity = nvnames;
+
 		while (nvnames--)
 		{
 			if (nvnames >= oldnvnames)
@@ -477,9 +802,9 @@ Exec_stat MCHandler::exec(MCExecPoint &ep, MCParameter *plist)
 				MCNameDelete(vinfo[nvnames] . name);
 				MCNameDelete(vinfo[nvnames] . init);
 			}
-			delete vars[nvnames];
+			MCHandlerFrameReleaseVariable(vars[nvnames]);
 		}
-		delete vars;
+		MCHandlerFrameReleaseArray(vars, t_vars_capacity);
 	}
 	params = oldparams;
 	nparams = oldnparams;
@@ -573,7 +898,7 @@ Parse_stat MCHandler::newvar(MCNameRef p_name, MCNameRef p_init, MCVarref **r_re
 	if (executing)
 	{
 		MCU_realloc((char **)&vars, nvnames, nvnames + 1, sizeof(MCVariable *));
-		/* UNCHECKED */ MCVariable::createwithname(p_name, vars[nvnames]);
+		vars[nvnames] = MCHandlerFrameAcquireVariable(p_name);
 
 		if (p_init != nil)
 			vars[nvnames] -> setnameref_unsafe(p_init);
@@ -667,17 +992,37 @@ Exec_stat MCHandler::getvarnames(MCExecPoint &ep, Boolean all)
 
 Exec_stat MCHandler::eval(MCExecPoint &ep)
 {
-	MCScriptPoint sp(ep);
-	sp.sethandler(this);
 	MCExpression *exp = NULL;
-	Symbol_type type;
-	Exec_stat stat = ES_ERROR;
-	if (sp.parseexp(False, True, &exp) == PS_NORMAL && sp.next(type) == PS_EOF)
+	MCHandlerFragment *t_fragment;
+	t_fragment = MCHandlerFindFragment(ep, this, 0, true);
+	if (t_fragment != NULL)
+		exp = t_fragment -> expression;
+	else
 	{
-		stat = exp->eval(ep);
-		ep.grabsvalue();
+		uint4 t_scope_size;
+		t_scope_size = getscopesize();
+
+		MCScriptPoint sp(ep);
+		sp.sethandler(this);
+		Symbol_type type;
+		if (sp.parseexp(False, True, &exp) != PS_NORMAL || sp.next(type) != PS_EOF)
+		{
+			delete exp;
+			return ES_ERROR;
+		}
+
+		t_fragment = MCHandlerAddFragment(ep, this, 0, t_scope_size, NULL, exp, 0);
 	}
-	delete exp;
+
+	Exec_stat stat;
+	stat = exp->eval(ep);
+	ep.grabsvalue();
+
+	if (t_fragment != NULL)
+		MCHandlerReleaseFragment(t_fragment);
+	else
+		delete exp;
+
 	return stat;
 }
 
@@ -703,7 +1048,9 @@ void MCHandler::deletestatements(MCStatement *statements)
 	}
 }
 
-Exec_stat MCHandler::doscript(MCExecPoint &ep, uint2 line, uint2 pos)
+// Parse the statements of a 'do' from the text in 'ep'. If successful, the
+// statements and the number of lines they span are returned.
+static Exec_stat MCHandlerParseScript(MCExecPoint &ep, uint2 line, uint2 pos, MCStatement*& r_statements, uint4& r_count)
 {
 	MCScriptPoint sp(ep);
 	MCStatement *curstatement = NULL;
@@ -772,15 +1119,53 @@ Exec_stat MCHandler::doscript(MCExecPoint &ep, uint2 line, uint2 pos)
 	}
 	MCexplicitvariables = oldexplicit;
 
+	r_statements = statements;
+	r_count = count;
+
+	return stat;
+}
+
+Exec_stat MCHandler::doscript(MCExecPoint &ep, uint2 line, uint2 pos)
+{
+	MCStatement *statements = NULL;
+	Exec_stat stat = ES_NORMAL;
+	uint4 count = 0;
+
+	// The statements are parsed in the context of the handler 'ep' is executing,
+	// which isn't necessarily this one (e.g. 'do ... in caller').
+	MCHandler *t_handler;
+	t_handler = ep.gethandler();
+
+	MCHandlerFragment *t_fragment;
+	t_fragment = MCHandlerFindFragment(ep, t_handler, line, false);
+	if (t_fragment != NULL)
+	{
+		statements = t_fragment -> statements;
+		count = t_fragment -> line_count;
+	}
+	else
+	{
+		uint4 t_scope_size;
+		t_scope_size = t_handler != NULL ? t_handler -> getscopesize() : 0;
+
+		stat = MCHandlerParseScript(ep, line, pos, statements, count);
+		if (stat != ES_ERROR)
+			t_fragment = MCHandlerAddFragment(ep, t_handler, line, t_scope_size, statements, NULL, count);
+	}
+
 	if (MClicenseparameters . do_limit > 0 && count >= MClicenseparameters . do_limit)
 	{
 		MCeerror -> add(EE_DO_NOTLICENSED, line, pos, ep . getsvalue());
 		stat = ES_ERROR;
 	}
 
+	// Statements which aren't cached are deleted as they are executed.
 	if (stat == ES_ERROR)
 	{
-		deletestatements(statements);
+		if (t_fragment != NULL)
+			MCHandlerReleaseFragment(t_fragment);
+		else
+			deletestatements(statements);
 		return ES_ERROR;
 	}
 	MCExecPoint ep2(ep);
@@ -789,13 +1174,19 @@ Exec_stat MCHandler::doscript(MCExecPoint &ep, uint2 line, uint2 pos)
 		Exec_stat stat = statements->exec(ep2);
 		if (stat == ES_ERROR)
 		{
-			deletestatements(statements);
+			if (t_fragment != NULL)
+				MCHandlerReleaseFragment(t_fragment);
+			else
+				deletestatements(statements);
 			MCeerror->add(EE_DO_BADEXEC, line, pos, ep.getsvalue());
 			return ES_ERROR;
 		}
 		if (MCexitall || stat != ES_NORMAL)
 		{
-			deletestatements(statements);
+			if (t_fragment != NULL)
+				MCHandlerReleaseFragment(t_fragment);
+			else
+				deletestatements(statements);
 			if (stat != ES_ERROR)
 				stat = ES_NORMAL;
 			return stat;
@@ -804,9 +1195,12 @@ Exec_stat MCHandler::doscript(MCExecPoint &ep, uint2 line, uint2 pos)
 		{
 			MCStatement *tsptr = statements;
 			statements = statements->getnext();
-			delete tsptr;
+			if (t_fragment == NULL)
+				delete tsptr;
 		}
 	}
+	if (t_fragment != NULL)
+		MCHandlerReleaseFragment(t_fragment);
 	if (MCscreen->abortkey())
 	{
 		MCeerror->add(EE_DO_ABORT, line, pos);
@@ -52,6 +52,9 @@ class MCHandler
 	uint2 npassedparams;
 	uint2 nparams;
 	uint2 nvnames;
+	// The number of variables declared by the handler's script - any beyond
+	// this have been added by 'do' and only last until the handler returns.
+	uint2 ndeclaredvnames;
 	uint2 npnames;
 	uint2 nconstants;
 	uint2 executing;
@@ -64,6 +67,10 @@ class MCHandler
 	Boolean prop;
 	Boolean array;
 	Boolean is_private;
+	// Set if the handler contains a 'pass' (or a 'do', which could contain
+	// one) - such handlers can't be called directly from a call-site cache as
+	// passing needs the rest of the message path.
+	Boolean can_pass;
 	uint1 type;
 	static Boolean gotpass;
 public:
@@ -141,6 +148,30 @@ public:
 		return is_private == True;
 	}
 
+	void setcanpass(void)
+	{
+		can_pass = True;
+	}
+	bool canpass(void) const
+	{
+		return can_pass == True;
+	}
+
+	// Fragments parsed by 'do' and 'value' in the context of the handler can
+	// only be kept if they refer to none of the variables added by 'do'.
+	bool hasonlydeclaredvars(void) const
+	{
+		return nvnames == ndeclaredvnames;
+	}
+
+	// The number of variables, constants and globals in the handler's scope.
+	// As parsing only ever adds to these, a change means that a fragment has
+	// declared something.
+	uint4 getscopesize(void) const
+	{
+		return nvnames + nconstants + nglobals;
+	}
+
 	void getvarlist(MCVariable**& r_vars, uint32_t& r_var_count)
 	{
 		r_vars = vars;
@@ -178,4 +209,18 @@ public:
 private:
 	Parse_stat newparam(MCScriptPoint& sp);
 };
+
+// The statement lists and expressions parsed by 'do' and 'value' are cached,
+// keyed on their text and the context they were parsed in, so that evaluating
+// the same string again doesn't reparse it.
+void MCHandlerInitFragmentCache(void);
+void MCHandlerFreeFragmentCache(void);
+
+// The number of parsed fragments kept by the cache - the least recently used
+// fragments are discarded to stay within it. A size of 0 turns caching off.
+uint4 MCHandlerGetFragmentCacheSize(void);
+void MCHandlerSetFragmentCacheSize(uint4 size);
+
+void MCHandlerGetFragmentCacheStats(uint4& r_hits, uint4& r_misses);
+
 #endif
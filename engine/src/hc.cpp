@@ -2231,6 +2231,7 @@ MCStack *MCHcstak::build()
 		{
 			delete sptr->hlist;
 			sptr->hlist = NULL;
+			MCscriptepoch++;
 		}
 		sptr->flags |= F_SCRIPT;
 	}
@@ -386,6 +386,25 @@ void MCHandlerlist::newglobal(MCNameRef p_name)
 	globals[nglobals++] = gptr;
 }
 
+void MCHandlerlist::resetvars(void)
+{
+	uint2 i;
+	i = 0;
+	for(MCVariable *t_var = vars; t_var != NULL; t_var = t_var -> getnext(), i++)
+	{
+		// A nil initializer is a UQL created in server script scope (see newvar).
+		if (vinits[i] == nil)
+		{
+			t_var -> setnameref_unsafe(t_var -> getname());
+			t_var -> setuql();
+		}
+		else if (MCNameIsEmpty(vinits[i]))
+			t_var -> clear();
+		else
+			t_var -> setnameref_unsafe(vinits[i]);
+	}
+}
+
 Parse_stat MCHandlerlist::parse(MCObject *objptr, const char *script)
 {
 	Parse_stat status = PS_NORMAL;
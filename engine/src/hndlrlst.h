@@ -120,6 +120,8 @@ public:
 	void appendlocalnames(MCExecPoint &ep);
 	void appendglobalnames(MCExecPoint &ep, bool first);
 	void newglobal(MCNameRef name);
+	// Set the script locals back to the values they were declared with.
+	void resetvars(void);
 	Parse_stat parse(MCObject *, const char *);
 
 	Exec_stat findhandler(Handler_type, MCNameRef name, MCHandler *&);
@@ -24,6 +24,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "image.h"
 #include "image_rep.h"
+#include "osspec.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -61,6 +62,11 @@ void MCImageRep::Release()
 #define DEFAULT_IMAGE_REP_CACHE_SIZE (1024 * 1024 * 256)
 #endif
 
+// The least decode cost a rep is counted as having - this stops reps which
+// decode quickly all having the same priority, so that larger ones still go
+// first.
+#define MIN_IMAGE_REP_LOAD_COST 0.001
+
 MCCachedImageRep::MCCachedImageRep()
 {
 	m_lock_count = 0;
@@ -70,6 +76,9 @@ MCCachedImageRep::MCCachedImageRep()
 	m_frame_count = 0;
 
 	m_next = m_prev = nil;
+
+	m_load_cost = 0.0;
+	m_cache_priority = 0.0;
 }
 
 MCCachedImageRep::~MCCachedImageRep()
@@ -96,10 +105,17 @@ bool MCCachedImageRep::EnsureImageFrames()
 	if (m_frames != nil)
 		return true;
 	
+	real64_t t_start_time;
+	t_start_time = MCS_time();
+
 	if (!LoadImageFrames(m_frames, m_frame_count))
 		return false;
 	
+	m_load_cost = MCS_time() - t_start_time;
+	s_cache_misses++;
+
 	s_cache_size += GetFrameByteCount();
+	UpdateCachePriority();
 	
 	if (s_cache_size > s_cache_limit)
 	{
@@ -118,6 +134,8 @@ bool MCCachedImageRep::LockImageFrame(uindex_t p_frame, MCImageFrame *&r_frame)
 		if (!EnsureImageFrames())
 			return false;
 	}
+	else
+		s_cache_hits++;
 
 	if (p_frame < m_frame_count)
 	{
@@ -148,9 +166,10 @@ void MCCachedImageRep::UnlockImageFrame(uindex_t p_index, MCImageFrame *p_frame)
 
 	m_lock_count--;
 	//m_frame_locks[p_index]--;
-	Release();
-
+	UpdateCachePriority();
 	MoveRepToHead(this);
+
+	Release();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -174,33 +193,75 @@ void MCCachedImageRep::ReleaseFrames()
 	m_frames = nil;
 }
 
+// Reps are kept in the cache in a cost-aware fashion ('GreedyDual-Size'). Each
+// rep's priority is the cost of decoding it per byte it occupies, on top of an
+// inflation value which rises to the priority of each rep evicted. The rep with
+// the least priority is evicted first, so cheap to decode, large reps go before
+// expensive, small ones while reps which haven't been used for a while
+// gradually fall behind those which have. Amongst equal priorities, the least
+// recently used rep goes first.
+void MCCachedImageRep::UpdateCachePriority()
+{
+	uint32_t t_byte_count;
+	t_byte_count = GetFrameByteCount();
+	if (t_byte_count == 0)
+		return;
+
+	real64_t t_cost;
+	t_cost = m_load_cost;
+	if (t_cost < MIN_IMAGE_REP_LOAD_COST)
+		t_cost = MIN_IMAGE_REP_LOAD_COST;
+
+	m_cache_priority = s_cache_inflation + t_cost / t_byte_count;
+}
+
 void MCCachedImageRep::FlushCache()
 {
 	MCLog("MCImageRep::FlushCache() - %d bytes", s_cache_size);
-	while (s_tail != nil)
-	{
-		s_tail->ReleaseFrames();
-		
-		s_tail = s_tail->m_prev;
-	}
+	for (MCCachedImageRep *t_rep = s_head; t_rep != nil; t_rep = t_rep->m_next)
+		t_rep->ReleaseFrames();
 	MCLog("%d bytes remaining", s_cache_size);
 }
 
 void MCCachedImageRep::FlushCacheToLimit()
 {
-	// allow tail to move forward - anything beyond the tail will have no frames
-	// loaded or is locked & will move to head on unlock
-
 	MCLog("MCImageRep::FlushCacheToLimit() - %d bytes", s_cache_size);
-	while (s_cache_size > s_cache_limit && s_tail != nil)
+	while (s_cache_size > s_cache_limit)
 	{
-		s_tail->ReleaseFrames();
-
-		s_tail = s_tail->m_prev;
+		// Reps which are locked can't be flushed, nor can those which have no
+		// frames to release.
+		MCCachedImageRep *t_victim;
+		t_victim = nil;
+		for (MCCachedImageRep *t_rep = s_tail; t_rep != nil; t_rep = t_rep->m_prev)
+			if (t_rep->m_frames != nil && t_rep->m_lock_count == 0 &&
+				(t_victim == nil || t_rep->m_cache_priority < t_victim->m_cache_priority))
+				t_victim = t_rep;
+
+		if (t_victim == nil)
+			break;
+
+		if (t_victim->m_cache_priority > s_cache_inflation)
+			s_cache_inflation = t_victim->m_cache_priority;
+
+		t_victim->ReleaseFrames();
+		s_cache_evictions++;
 	}
 	MCLog("%d bytes remaining", s_cache_size);
 }
 
+void MCCachedImageRep::SetCacheLimit(uint32_t p_limit)
+{
+	s_cache_limit = p_limit;
+	FlushCacheToLimit();
+}
+
+void MCCachedImageRep::GetCacheStats(uint32_t &r_hits, uint32_t &r_misses, uint32_t &r_evictions)
+{
+	r_hits = s_cache_hits;
+	r_misses = s_cache_misses;
+	r_evictions = s_cache_evictions;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 bool MCCachedImageRep::GetGeometry(uindex_t &r_width, uindex_t &r_height)
@@ -223,6 +284,10 @@ MCCachedImageRep *MCCachedImageRep::s_head = nil;
 MCCachedImageRep *MCCachedImageRep::s_tail = nil;
 uint32_t MCCachedImageRep::s_cache_size = 0;
 uint32_t MCCachedImageRep::s_cache_limit = DEFAULT_IMAGE_REP_CACHE_SIZE;
+real64_t MCCachedImageRep::s_cache_inflation = 0.0;
+uint32_t MCCachedImageRep::s_cache_hits = 0;
+uint32_t MCCachedImageRep::s_cache_misses = 0;
+uint32_t MCCachedImageRep::s_cache_evictions = 0;
 
 void MCCachedImageRep::init()
 {
@@ -230,21 +295,21 @@ void MCCachedImageRep::init()
 
 	s_cache_size = 0;
 	s_cache_limit = DEFAULT_IMAGE_REP_CACHE_SIZE;
+
+	s_cache_inflation = 0.0;
+	s_cache_hits = 0;
+	s_cache_misses = 0;
+	s_cache_evictions = 0;
 }
 
 bool MCCachedImageRep::FindReferencedWithFilename(const char *p_filename, MCCachedImageRep *&r_rep)
 {
-	for (MCCachedImageRep *t_rep = s_head; t_rep != nil; t_rep = t_rep->m_next)
-	{
-		if (t_rep->GetType() == kMCImageRepReferenced &&
-			MCCStringEqual(static_cast<MCReferencedImageRep*>(t_rep)->GetFilename(), p_filename))
-		{
-			r_rep = t_rep;
-			return true;
-		}
-	}
+	MCReferencedImageRep *t_rep;
+	if (!MCReferencedImageRep::FindWithFilename(p_filename, t_rep))
+		return false;
 
-	return false;
+	r_rep = t_rep;
+	return true;
 }
 
 void MCCachedImageRep::AddRep(MCCachedImageRep *p_rep)
@@ -89,8 +89,9 @@ public:
 	static void FlushCacheToLimit();
 	
 	static uint32_t GetCacheUsage() { return s_cache_size; }
-	static void SetCacheLimit(uint32_t p_limit)	{ s_cache_limit = p_limit; }
+	static void SetCacheLimit(uint32_t p_limit);
 	static uint32_t GetCacheLimit() { return s_cache_limit; }
+	static void GetCacheStats(uint32_t &r_hits, uint32_t &r_misses, uint32_t &r_evictions);
 	
 
 protected:
@@ -102,6 +103,7 @@ protected:
 
 private:
 	bool EnsureImageFrames();
+	void UpdateCachePriority();
 	
 	uindex_t m_lock_count;
 
@@ -118,8 +120,18 @@ private:
 
 	//////////
 
+	// The time taken to decode the frames, and the rep's priority for keeping
+	// them in the cache.
+	real64_t m_load_cost;
+	real64_t m_cache_priority;
+
 	static uint32_t s_cache_size;
 	static uint32_t s_cache_limit;
+
+	static real64_t s_cache_inflation;
+	static uint32_t s_cache_hits;
+	static uint32_t s_cache_misses;
+	static uint32_t s_cache_evictions;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -171,6 +183,8 @@ public:
 
 	//////////
 
+	static bool FindWithFilename(const char *p_filename, MCReferencedImageRep *&r_rep);
+
 protected:
 	// open a datastream to the referenced image file
 	bool GetDataStream(IO_handle &r_stream);
@@ -180,6 +194,18 @@ protected:
 	// hold data from remote image
 	void *m_url_data;
 	uindex_t m_url_data_size;
+
+private:
+	static void AddToIndex(MCReferencedImageRep *p_rep);
+	static void RemoveFromIndex(MCReferencedImageRep *p_rep);
+
+	// Referenced reps are indexed by filename.
+	uint32_t m_file_hash;
+	MCReferencedImageRep *m_file_next;
+
+	static MCReferencedImageRep **s_file_index;
+	static uindex_t s_file_index_size;
+	static uindex_t s_file_count;
 };
 
 //////////
@@ -130,14 +130,103 @@ MCReferencedImageRep::MCReferencedImageRep(const char *p_file_name)
 {
 	/* UNCHECKED */ MCCStringClone(p_file_name, m_file_name);
 	m_url_data = nil;
+
+	AddToIndex(this);
 }
 
 MCReferencedImageRep::~MCReferencedImageRep()
 {
+	RemoveFromIndex(this);
+
 	MCCStringFree(m_file_name);
 	MCMemoryDeallocate(m_url_data);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+MCReferencedImageRep **MCReferencedImageRep::s_file_index = nil;
+uindex_t MCReferencedImageRep::s_file_index_size = 0;
+uindex_t MCReferencedImageRep::s_file_count = 0;
+
+static uint32_t MCReferencedImageRepHashFilename(const char *p_filename)
+{
+	return MCHashChars(p_filename, p_filename != nil ? strlen(p_filename) : 0, kMCCompareExact, 0);
+}
+
+void MCReferencedImageRep::AddToIndex(MCReferencedImageRep *p_rep)
+{
+	p_rep -> m_file_hash = MCReferencedImageRepHashFilename(p_rep -> m_file_name);
+	p_rep -> m_file_next = nil;
+
+	// Keep the index at most fully loaded - if it can't be grown, carry on with
+	// the existing one.
+	if (s_file_count >= s_file_index_size)
+	{
+		uindex_t t_new_size;
+		t_new_size = s_file_index_size == 0 ? 64 : s_file_index_size * 2;
+
+		MCReferencedImageRep **t_new_index;
+		if (MCMemoryNewArray(t_new_size, t_new_index))
+		{
+			for(uindex_t i = 0; i < s_file_index_size; i++)
+				while(s_file_index[i] != nil)
+				{
+					MCReferencedImageRep *t_rep;
+					t_rep = s_file_index[i];
+					s_file_index[i] = t_rep -> m_file_next;
+					t_rep -> m_file_next = t_new_index[t_rep -> m_file_hash & (t_new_size - 1)];
+					t_new_index[t_rep -> m_file_hash & (t_new_size - 1)] = t_rep;
+				}
+
+			MCMemoryDeleteArray(s_file_index);
+			s_file_index = t_new_index;
+			s_file_index_size = t_new_size;
+		}
+	}
+
+	if (s_file_index_size == 0)
+		return;
+
+	uindex_t t_bucket;
+	t_bucket = p_rep -> m_file_hash & (s_file_index_size - 1);
+	p_rep -> m_file_next = s_file_index[t_bucket];
+	s_file_index[t_bucket] = p_rep;
+	s_file_count++;
+}
+
+void MCReferencedImageRep::RemoveFromIndex(MCReferencedImageRep *p_rep)
+{
+	if (s_file_index_size == 0)
+		return;
+
+	for(MCReferencedImageRep **t_link = &s_file_index[p_rep -> m_file_hash & (s_file_index_size - 1)]; *t_link != nil; t_link = &(*t_link) -> m_file_next)
+		if (*t_link == p_rep)
+		{
+			*t_link = p_rep -> m_file_next;
+			s_file_count--;
+			break;
+		}
+}
+
+bool MCReferencedImageRep::FindWithFilename(const char *p_filename, MCReferencedImageRep *&r_rep)
+{
+	if (s_file_index_size == 0)
+		return false;
+
+	uint32_t t_hash;
+	t_hash = MCReferencedImageRepHashFilename(p_filename);
+	for(MCReferencedImageRep *t_rep = s_file_index[t_hash & (s_file_index_size - 1)]; t_rep != nil; t_rep = t_rep -> m_file_next)
+		if (t_rep -> m_file_hash == t_hash && MCCStringEqual(t_rep -> m_file_name, p_filename))
+		{
+			r_rep = t_rep;
+			return true;
+		}
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 bool MCReferencedImageRep::GetDataStream(IO_handle &r_stream)
 {
 	IO_handle t_stream = nil;
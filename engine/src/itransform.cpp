@@ -29,6 +29,14 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 // Universal double comparison threshold
 #define EPS 1e-8
 
+// The bilinear scaler combines pixels using SSE2 on x86 (under the same
+// conditions as the SSE2 combiners).
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#define ITRANSFORM_SSE2
+#include <emmintrin.h>
+extern bool surface_has_sse2(void);
+#endif
+
 #ifndef __VISUALC__
 #define __forceinline inline
 #endif
@@ -44,18 +52,52 @@ extern void surface_extract_alpha(void *p_pixels, uint4 p_pixel_stride, void *p_
 // ---------------
 // Resizing 32-32
 // ---------------
+
+// The channel values as reals - these are exactly the values GET used to
+// compute with a division for every sample.
+static real8 s_resize_levels[256];
+static bool s_resize_levels_initialized = false;
+
+static void resize_seq_initialize(void)
+{
+	if (s_resize_levels_initialized)
+		return;
+
+	for(int i = 0; i < 256; i++)
+		s_resize_levels[i] = (real8) i / 0xFF;
+
+	s_resize_levels_initialized = true;
+}
+
+// The 'aa' spline coefficients depend only on the length of the sequence, so
+// they are computed once for each pass rather than for every channel of every
+// row and column.
+static void resize_seq_coefficients(const int n, real8* const aa)
+{
+	if (n < 2)
+		return;
+
+	aa[n-1] = 2.0;
+	for(int i=n-2 ; i>0 ; i--)
+		aa[i] = 4.0 - 1.0/aa[i+1];
+	aa[0] = 2.0 - 1.0/aa[1];
+}
+
+// Resize a sequence of pixels, processing each of the channels at 'low_bits'
+// together. The spline coefficients of each channel are independent, but the
+// stepping through the source only depends on the lengths so is shared.
 static void resize_seq_32_32(	const uint1* const src_data, const int src_n, const int src_step,
                               uint1*       const dst_data, const int dst_n, const int dst_step,
-                              const uint1 low_bit,
-                              real8* const aa, real8* const bb)
+                              const uint1* const low_bits, const int channels,
+                              const real8* const aa, real8* const bb)
 {
-#define GETINT(offs) ( (*(const uint4*)(curs + (offs)) >> low_bit) & 0xFF )
-#define GET(offs)    ( (real8) GETINT(offs) / 0xFF )
-#define SETINT(tv)   ( \
-	*(uint4*)curd |= (tv) << low_bit )
-#define SET(tv)   ( SETINT((uint4)((tv) * 0xFF + 0.5)) )
+#define GETINT(offs, ch) ( (*(const uint4*)(curs + (offs)) >> low_bits[ch]) & 0xFF )
+#define GET(offs, ch)    ( s_resize_levels[GETINT(offs, ch)] )
+#define SETINT(tv, ch)   ( \
+	*(uint4*)curd |= (tv) << low_bits[ch] )
+#define SET(tv, ch)   ( SETINT((uint4)((tv) * 0xFF + 0.5), ch) )
 
-	int i;
+	int i, ch;
 
 	// Current source and destination pointers
 	const uint1* curs = src_data;
@@ -63,69 +105,87 @@ static void resize_seq_32_32(	const uint1* const src_data, const int src_n, cons
 
 	if(src_n == dst_n) // copy case
 	{
-		for(i = src_n ; i ; i--)
-			SETINT(GETINT(0)), curs += src_step, curd += dst_step;
+		for(i = src_n ; i ; i--, curs += src_step, curd += dst_step)
+			for(ch = 0 ; ch < channels ; ch++)
+				SETINT(GETINT(0, ch), ch);
 
 		return;
 	}
 
 	if(src_n == 1) // fill case
 	{
-		const real8 tv = GET(0);
+		real8 tv[4];
+		for(ch = 0 ; ch < channels ; ch++)
+			tv[ch] = GET(0, ch);
 
-		for(i = dst_n ; i ; i--)
-			SET(tv), curd += dst_step;
+		for(i = dst_n ; i ; i--, curd += dst_step)
+			for(ch = 0 ; ch < channels ; ch++)
+				SET(tv[ch], ch);
 
 		return;
 	}
 
 	if(dst_n == 1) // median case
 	{
-		real8 tv = 0.0;
+		real8 tv[4] = { 0.0, 0.0, 0.0, 0.0 };
 
-		for(i = src_n ; i ; i--)
-			tv += GET(0), curs += src_step;
+		for(i = src_n ; i ; i--, curs += src_step)
+			for(ch = 0 ; ch < channels ; ch++)
+				tv[ch] += GET(0, ch);
 
-		tv /= src_n;
+		for(ch = 0 ; ch < channels ; ch++)
+		{
+			tv[ch] /= src_n;
 
-		SET(tv);
+			SET(tv[ch], ch);
+		}
 
 		return;
 	}
 
 	if(src_n == 2) // linear case
 	{
-		const real8 v1 = (real8)GET(0);
-		const real8 v2 = (real8)GET(src_step);
+		real8 v1[4], k[4];
+		for(ch = 0 ; ch < channels ; ch++)
+		{
+			v1[ch] = (real8)GET(0, ch);
+			const real8 v2 = (real8)GET(src_step, ch);
 
-		const real8 k = (v2-v1)/(dst_n-1);
+			k[ch] = (v2-v1[ch])/(dst_n-1);
+		}
 
-		for(i=0 ; i<dst_n ; i++)
-			SET(v1 + k*i + 0.5), curd += dst_step;
+		for(i=0 ; i<dst_n ; i++, curd += dst_step)
+			for(ch = 0 ; ch < channels ; ch++)
+				SET(v1[ch] + k[ch]*i + 0.5, ch);
 
 		return;
 	}
 
-	// Evaluating derivatives gaussian coefs
+	// Evaluating derivatives gaussian coefs (bb holds 'channels' values for
+	// each source pixel)
 	curs = src_data + (src_n - 1) * src_step;
 
-	aa[src_n-1] = 2.0, bb[src_n-1] = 3.0*(GET(0) - GET(-src_step)), curs -= src_step;
+	for(ch = 0 ; ch < channels ; ch++)
+		bb[(src_n-1)*channels + ch] = 3.0*(GET(0, ch) - GET(-src_step, ch));
+	curs -= src_step;
 	for(i=src_n-2 ; i>0 ; i--, curs -= src_step)
-	{
-		aa[i] = 4.0 - 1.0/aa[i+1]; bb[i] = 3.0*(GET(src_step) - GET(-src_step)) - bb[i+1]/aa[i+1];
-	}
-	aa[0] = 2.0 - 1.0/aa[1], bb[0] = 3.0*(GET(src_step) - GET(0)) - bb[1]/aa[1];
+		for(ch = 0 ; ch < channels ; ch++)
+			bb[i*channels + ch] = 3.0*(GET(src_step, ch) - GET(-src_step, ch)) - bb[(i+1)*channels + ch]/aa[i+1];
+	for(ch = 0 ; ch < channels ; ch++)
+		bb[ch] = 3.0*(GET(src_step, ch) - GET(0, ch)) - bb[channels + ch]/aa[1];
 
 	real8 csx = 0.0; // current src x
 	int    cdx = 0;   // current dst x
 
-	real8 CD, ND = bb[0] / aa[0]; // initial derivative values
+	real8 CD[4], ND[4]; // current and next derivative values
+	for(ch = 0 ; ch < channels ; ch++)
+		ND[ch] = bb[ch] / aa[0]; // initial derivative values
 
 	const real8 k = (real8)(src_n-1) / dst_n;
 	const real8 _1_k = 1.0 / k;
 
 	real8 v1, v2;     // current value, next value
-	real8 a, b, c, d; // polynom coefs
+	real8 a[4], b[4], c[4], d[4]; // polynom coefs
 	real8 t;          // polynom argument
 
 	curs = src_data, curd = dst_data;
@@ -135,35 +195,40 @@ static void resize_seq_32_32(	const uint1* const src_data, const int src_n, cons
 		for(i=0 ; cdx < dst_n ; i++, curs += src_step)
 		{
 			if(i < src_n-1) // permission to move forwards
-			{
-				// Updating current and next derivative values
-				CD = ND, ND = (bb[i+1] - CD) / aa[i+1];
+				for(ch = 0 ; ch < channels ; ch++)
+				{
+					// Updating current and next derivative values
+					CD[ch] = ND[ch], ND[ch] = (bb[(i+1)*channels + ch] - CD[ch]) / aa[i+1];
 
-				v1 = GET(0), v2 = GET(src_step);
+					v1 = GET(0, ch), v2 = GET(src_step, ch);
 
-				// Updating polynom coefs
-				a = v1;
-				b = CD;
-				c = 3.0*(v2 - v1) - 2.0*CD - ND;
-				d = 2.0*(v1 - v2) + CD + ND;
-			}
+					// Updating polynom coefs
+					a[ch] = v1;
+					b[ch] = CD[ch];
+					c[ch] = 3.0*(v2 - v1) - 2.0*CD[ch] - ND[ch];
+					d[ch] = 2.0*(v1 - v2) + CD[ch] + ND[ch];
+				}
 
 			t = csx - i;
 
 			// Filling output pixels with corresponding source segment interpolated values
 			while(cdx < dst_n && (i == src_n-1 || t < 1.0 - EPS))
 			{
-				// Evaluating output color
-				real8 tv = a+t*(b+t*(c+t*d));
+				for(ch = 0 ; ch < channels ; ch++)
+				{
+					// Evaluating output color
+					real8 tv = a[ch]+t*(b[ch]+t*(c[ch]+t*d[ch]));
 
-				// Bounding output color
-				if(tv < 0)
-					tv = 0;
-				else if(tv > 1.0)
-					tv = 1.0;
+					// Bounding output color
+					if(tv < 0)
+						tv = 0;
+					else if(tv > 1.0)
+						tv = 1.0;
 
-				// Setting output color
-				SET(tv), curd += dst_step;
+					// Setting output color
+					SET(tv, ch);
+				}
+				curd += dst_step;
 
 				// Advancing to next destination pixel
 				cdx++, t+=k;
@@ -178,68 +243,89 @@ static void resize_seq_32_32(	const uint1* const src_data, const int src_n, cons
 		t = 0.0;
 
 		i = 0;
-		CD = ND, ND = (bb[i+1] - CD) / aa[i+1];
-		v1 = GET(0), v2 = GET(src_step);
-		a = v1;
-		b = CD * 0.5;
-		c = (v2 - v1) - (2.0*CD - ND) * 0.33333333333333;
-		d = 0.5*(v1 - v2) + (CD + ND) * 0.25;
+		for(ch = 0 ; ch < channels ; ch++)
+		{
+			CD[ch] = ND[ch], ND[ch] = (bb[(i+1)*channels + ch] - CD[ch]) / aa[i+1];
+			v1 = GET(0, ch), v2 = GET(src_step, ch);
+			a[ch] = v1;
+			b[ch] = CD[ch] * 0.5;
+			c[ch] = (v2 - v1) - (2.0*CD[ch] - ND[ch]) * 0.33333333333333;
+			d[ch] = 0.5*(v1 - v2) + (CD[ch] + ND[ch]) * 0.25;
+		}
 
 		for( ; cdx < dst_n ; cdx++)
 		{
-			real8 tv = 0.0; // total integral sum for this output pixel
+			real8 tv[4] = { 0.0, 0.0, 0.0, 0.0 }; // total integral sum for this output pixel
 			real8 cs = 0.0; // total source length run
 
 			if(t > EPS) // past segment start
 			{
 				// Adding current segment left-over
-				tv += a+b+c+d - t*(a+t*(b+t*(c+t*d))), cs += 1.0 - t, t = 0.0;
+				for(ch = 0 ; ch < channels ; ch++)
+					tv[ch] += a[ch]+b[ch]+c[ch]+d[ch] - t*(a[ch]+t*(b[ch]+t*(c[ch]+t*d[ch])));
+				cs += 1.0 - t, t = 0.0;
 
 				// Moving to the next segment
 				if(i<src_n-2)
 				{
 					i++, curs += src_step;
-					CD = ND, ND = (bb[i+1] - CD) / aa[i+1];
-					v1 = GET(0), v2 = GET(src_step);
-					a = v1;
-					b = CD * 0.5;
-					c = (v2 - v1) - (2.0*CD - ND) * 0.3333333333;
-					d = 0.5*(v1 - v2) + (CD + ND) * 0.25;
+					for(ch = 0 ; ch < channels ; ch++)
+					{
+						CD[ch] = ND[ch], ND[ch] = (bb[(i+1)*channels + ch] - CD[ch]) / aa[i+1];
+						v1 = GET(0, ch), v2 = GET(src_step, ch);
+						a[ch] = v1;
+						b[ch] = CD[ch] * 0.5;
+						c[ch] = (v2 - v1) - (2.0*CD[ch] - ND[ch]) * 0.3333333333;
+						d[ch] = 0.5*(v1 - v2) + (CD[ch] + ND[ch]) * 0.25;
+					}
 				}
 			}
 
 			// Adding completely covered segments
 			while(cs + 1.0 < k + EPS)
 			{
-				tv += a+b+c+d, cs += 1.0;
+				for(ch = 0 ; ch < channels ; ch++)
+					tv[ch] += a[ch]+b[ch]+c[ch]+d[ch];
+				cs += 1.0;
 
 				if(i<src_n-2)
 				{
 					i++, curs += src_step;
-					CD = ND, ND = (bb[i+1] - CD) / aa[i+1];
-					v1 = GET(0), v2 = GET(src_step);
-					a = v1;
-					b = CD * 0.5;
-					c = (v2 - v1) - (2.0*CD - ND) * 0.3333333333;
-					d = 0.5*(v1 - v2) + (CD + ND) * 0.25;
+					for(ch = 0 ; ch < channels ; ch++)
+					{
+						CD[ch] = ND[ch], ND[ch] = (bb[(i+1)*channels + ch] - CD[ch]) / aa[i+1];
+						v1 = GET(0, ch), v2 = GET(src_step, ch);
+						a[ch] = v1;
+						b[ch] = CD[ch] * 0.5;
+						c[ch] = (v2 - v1) - (2.0*CD[ch] - ND[ch]) * 0.3333333333;
+						d[ch] = 0.5*(v1 - v2) + (CD[ch] + ND[ch]) * 0.25;
+					}
 				}
 			}
 
 			// Adding first part of the last segment
 			if(cs < k - EPS)
-				t = k - cs, tv += t*(a+t*(b+t*(c+t*d)));
+			{
+				t = k - cs;
+				for(ch = 0 ; ch < channels ; ch++)
+					tv[ch] += t*(a[ch]+t*(b[ch]+t*(c[ch]+t*d[ch])));
+			}
 
-			// Normalizing output color
-			tv *= _1_k;
+			for(ch = 0 ; ch < channels ; ch++)
+			{
+				// Normalizing output color
+				tv[ch] *= _1_k;
 
-			// Bounding output color
-			if(tv < 0.0)
-				tv = 0.0;
-			else if(tv > 1.0)
-				tv = 1.0;
+				// Bounding output color
+				if(tv[ch] < 0.0)
+					tv[ch] = 0.0;
+				else if(tv[ch] > 1.0)
+					tv[ch] = 1.0;
 
-			// Setting output color
-			SET(tv), curd += dst_step;
+				// Setting output color
+				SET(tv[ch], ch);
+			}
+			curd += dst_step;
 		}
 	}
 
@@ -252,6 +338,45 @@ static void resize_seq_32_32(	const uint1* const src_data, const int src_n, cons
 #define GREEN_OFFSET 8
 #define BLUE_OFFSET 0
 
+// The channels resized by the bicubic scalers - alpha is only included when
+// all four are used.
+static const uint1 s_resize_channels[] = { RED_OFFSET, GREEN_OFFSET, BLUE_OFFSET, ALPHA_OFFSET };
+
+// Resize each column of the (row-resized) temporary image into the destination.
+// Each column is gathered into a contiguous buffer first, and the result is
+// scattered back once, so the resize itself doesn't walk down the images.
+// The destination must have been cleared.
+static void resize_cols_32_32(const uint1* const tmp_data, const int tmp_bytes_per_line, const int src_height,
+                              uint1* const dst_data, const int dst_bytes_per_line, const int dst_width, const int dst_height,
+                              const bool has_alpha, real8* const bb)
+{
+	real8* const aa = new real8[src_height];
+	resize_seq_coefficients(src_height, aa);
+
+	uint4* const src_col = new uint4[src_height];
+	uint4* const dst_col = new uint4[dst_height];
+
+	for(int i=0 ; i<dst_width ; i++)
+	{
+		for(int y=0 ; y<src_height ; y++)
+			src_col[y] = *(const uint4*)(tmp_data + y * tmp_bytes_per_line + (i << 2));
+
+		memset(dst_col, 0, dst_height * sizeof(uint4));
+
+		resize_seq_32_32(	(const uint1*)src_col, src_height, 4,
+		                  (uint1*)dst_col, dst_height, 4,
+		                  s_resize_channels, has_alpha ? 4 : 3,
+		                  aa, bb);
+
+		for(int y=0 ; y<dst_height ; y++)
+			*(uint4*)(dst_data + y * dst_bytes_per_line + (i << 2)) = dst_col[y];
+	}
+
+	delete[] dst_col;
+	delete[] src_col;
+	delete[] aa;
+}
+
 // Sizing
 void resize_bicubic_32_32(const MCBitmap& src, const MCBitmap& dst)
 {
@@ -266,58 +391,31 @@ void resize_bicubic_32_32(const MCBitmap& src, const MCBitmap& dst)
 	memset(tmp_data, 0, tmp_bytes_per_line * src.height);
 	memset(dst.data, 0, dst.bytes_per_line * dst.height);
 
+	resize_seq_initialize();
+
 	// Temporary derivative arrays
 	real8* aa;
 	real8* bb;
 
+	aa = new real8[src.width];
 	if(src.width > src.height)
-		aa = new real8[src.width], bb = new real8[src.width];
+		bb = new real8[src.width * 4];
 	else
-		aa = new real8[src.height], bb = new real8[src.height];
+		bb = new real8[src.height * 4];
+
+	resize_seq_coefficients(src.width, aa);
 
 	// resizing rows
 	for(i=0 ; i<src.height ; i++)
 	{
-		// R
-		resize_seq_32_32(	(const uint1*)src.data + i * src.bytes_per_line, src.width, 4,
-		                  (uint1*)tmp_data + i * tmp_bytes_per_line, dst.width, 4,
-		                  RED_OFFSET,
-		                  aa, bb);
-
-		// G
-		resize_seq_32_32(	(const uint1*)src.data + i * src.bytes_per_line, src.width, 4,
-		                  (uint1*)tmp_data + i * tmp_bytes_per_line, dst.width, 4,
-		                  GREEN_OFFSET,
-		                  aa, bb);
-
-		// B
 		resize_seq_32_32(	(const uint1*)src.data + i * src.bytes_per_line, src.width, 4,
 		                  (uint1*)tmp_data + i * tmp_bytes_per_line, dst.width, 4,
-		                  BLUE_OFFSET,
+		                  s_resize_channels, 3,
 		                  aa, bb);
 	}
 
 	// resizing cols
-	for(i=0 ; i<dst.width ; i++)
-	{
-		// R
-		resize_seq_32_32(	(const uint1*)tmp_data + (i << 2), src.height, tmp_bytes_per_line,
-		                  (uint1*)dst.data + (i << 2), dst.height, dst.bytes_per_line,
-		                  RED_OFFSET,
-		                  aa, bb);
-
-		// G
-		resize_seq_32_32(	(const uint1*)tmp_data + (i << 2), src.height, tmp_bytes_per_line,
-		                  (uint1*)dst.data + (i << 2), dst.height, dst.bytes_per_line,
-		                  GREEN_OFFSET,
-		                  aa, bb);
-
-		// B
-		resize_seq_32_32(	(const uint1*)tmp_data + (i << 2), src.height, tmp_bytes_per_line,
-		                  (uint1*)dst.data + (i << 2), dst.height, dst.bytes_per_line,
-		                  BLUE_OFFSET,
-		                  aa, bb);
-	}
+	resize_cols_32_32(tmp_data, tmp_bytes_per_line, src.height, (uint1*)dst.data, dst.bytes_per_line, dst.width, dst.height, false, bb);
 	
 	for(uint2 y = 0; y < dst.height; ++y)
 	{
@@ -423,6 +521,71 @@ __forceinline unsigned int packed_bilinear_combine_4(unsigned char x, unsigned c
 	return packed_bilinear_bounded_4(f00, ix_iy, f10, x_iy, f01, ix_y, f11, x_y);
 }
 
+#ifdef ITRANSFORM_SSE2
+// Compute the same value as packed_bilinear_combine_4 with the channels of the
+// four source pixels widened to 16 bits. p_row_0 holds f00 and f10, p_row_1
+// holds f01 and f11. All intermediate sums fit in 16 bits, so the result is
+// identical.
+static inline unsigned int sse2_bilinear_combine_4(unsigned char x, unsigned char y, __m128i p_row_0, __m128i p_row_1)
+{
+	unsigned char x_y, ix_y, x_iy, ix_iy;
+
+	unsigned int u;
+	u = x * y + 0x80;
+	u = (u + (u >> 8)) >> 8;
+
+	x_y = u ;
+	ix_y = y - x_y;
+	x_iy = x - x_y;
+	ix_iy = (255 - y) - x_iy;
+
+	__m128i t_weights_0, t_weights_1;
+	t_weights_0 = _mm_cvtsi32_si128(ix_iy | (x_iy << 16));
+	t_weights_0 = _mm_unpacklo_epi16(t_weights_0, t_weights_0);
+	t_weights_0 = _mm_unpacklo_epi32(t_weights_0, t_weights_0);
+	t_weights_1 = _mm_cvtsi32_si128(ix_y | (x_y << 16));
+	t_weights_1 = _mm_unpacklo_epi16(t_weights_1, t_weights_1);
+	t_weights_1 = _mm_unpacklo_epi32(t_weights_1, t_weights_1);
+
+	__m128i t_sum;
+	t_sum = _mm_add_epi16(_mm_mullo_epi16(p_row_0, t_weights_0), _mm_mullo_epi16(p_row_1, t_weights_1));
+	t_sum = _mm_add_epi16(t_sum, _mm_srli_si128(t_sum, 8));
+	t_sum = _mm_add_epi16(t_sum, _mm_set1_epi16(0x80));
+	t_sum = _mm_srli_epi16(_mm_add_epi16(t_sum, _mm_srli_epi16(t_sum, 8)), 8);
+
+	return (unsigned int)_mm_cvtsi128_si32(_mm_packus_epi16(t_sum, t_sum));
+}
+
+static void scaleimage_bilinear_row_sse2(const unsigned int *p_src_pixel_0, const unsigned int *p_src_pixel_1, unsigned int *p_dst_pixel, const unsigned int *p_columns, unsigned int p_width, unsigned int p_src_width, unsigned int p_fy)
+{
+	__m128i t_zero;
+	t_zero = _mm_setzero_si128();
+
+	for(unsigned int x = 0; x < p_width; x++)
+	{
+		unsigned int t_ix, t_fx;
+		t_ix = p_columns[x] / 256;
+		t_fx = p_columns[x] & 0xFF;
+
+		__m128i t_row_0, t_row_1;
+		if (t_ix < p_src_width - 1)
+		{
+			t_row_0 = _mm_loadl_epi64((const __m128i *)(p_src_pixel_0 + t_ix));
+			t_row_1 = _mm_loadl_epi64((const __m128i *)(p_src_pixel_1 + t_ix));
+		}
+		else
+		{
+			t_row_0 = _mm_cvtsi32_si128(p_src_pixel_0[t_ix]);
+			t_row_0 = _mm_unpacklo_epi32(t_row_0, t_row_0);
+			t_row_1 = _mm_cvtsi32_si128(p_src_pixel_1[t_ix]);
+			t_row_1 = _mm_unpacklo_epi32(t_row_1, t_row_1);
+		}
+
+		p_dst_pixel[x] = sse2_bilinear_combine_4(t_fx, p_fy, _mm_unpacklo_epi8(t_row_0, t_zero), _mm_unpacklo_epi8(t_row_1, t_zero));
+	}
+}
+#endif
+
 static void scaleimage_bilinear(void *p_src_ptr, uint4 p_src_stride, void *p_dst_ptr, uint4 p_dst_stride, uint4 p_src_width, uint4 p_src_height, uint4 p_dst_width, uint4 p_dst_height)
 {
 	unsigned int t_dst_stride;
@@ -453,6 +616,37 @@ static void scaleimage_bilinear(void *p_src_ptr, uint4 p_src_stride, void *p_dst
 	unsigned int t_ty;
 	t_ty = t_ay % t_by;
 
+	// The source position (in 1/256ths of a pixel) of each destination column
+	// is the same for every row, so step through them once up front.
+	unsigned int *t_columns;
+	t_columns = new unsigned int[p_dst_width];
+
+	unsigned int t_qx;
+	t_qx = 0;
+	
+	int t_rx;
+	t_rx = -t_bx;	
+
+	for(unsigned int x = 0; x < p_dst_width; x++)
+	{
+		t_columns[x] = t_qx;
+
+		t_qx += t_sx;
+		t_rx += t_tx;
+		if (t_rx >= 0)
+		{
+			t_qx++;
+			t_rx -= t_bx;
+		}
+	}
+
+	bool t_use_sse2;
+#ifdef ITRANSFORM_SSE2
+	t_use_sse2 = surface_has_sse2();
+#else
+	t_use_sse2 = false;
+#endif
+
 	unsigned int t_qy;
 	t_qy = 0;
 	
@@ -463,12 +657,6 @@ static void scaleimage_bilinear(void *p_src_ptr, uint4 p_src_stride, void *p_dst
 	t_y = p_dst_height;
 	while(t_y-- > 0)
 	{
-		unsigned int t_qx;
-		t_qx = 0;
-		
-		int t_rx;
-		t_rx = -t_bx;	
-		
 		unsigned int t_iy, t_fy;
 		t_iy = t_qy / 256;
 		t_fy = t_qy & 0xFF;
@@ -479,17 +667,16 @@ static void scaleimage_bilinear(void *p_src_ptr, uint4 p_src_stride, void *p_dst
 		if (t_iy < p_src_height - 1)
 			t_src_pixel_1 += t_src_stride;
 
-		unsigned int t_x;
-		t_x = p_dst_width;
-
-		unsigned int *t_dst_pixel_current;
-		t_dst_pixel_current = t_dst_pixel;
-
-		while(t_x-- > 0)
+#ifdef ITRANSFORM_SSE2
+		if (t_use_sse2)
+			scaleimage_bilinear_row_sse2(t_src_pixel_0, t_src_pixel_1, t_dst_pixel, t_columns, p_dst_width, p_src_width, t_fy);
+		else
+#endif
+		for(unsigned int x = 0; x < p_dst_width; x++)
 		{
 			unsigned int t_ix, t_fx;
-			t_ix = t_qx / 256;
-			t_fx = t_qx & 0xFF;
+			t_ix = t_columns[x] / 256;
+			t_fx = t_columns[x] & 0xFF;
 
 			unsigned int t_p00, t_p10, t_p01, t_p11;
 			t_p00 = t_src_pixel_0[t_ix];
@@ -505,16 +692,7 @@ static void scaleimage_bilinear(void *p_src_ptr, uint4 p_src_stride, void *p_dst
 				t_p11 = t_p01;
 			}
 
-			*t_dst_pixel_current = packed_bilinear_combine_4(t_fx, t_fy, t_p00, t_p10, t_p01, t_p11);
-			t_dst_pixel_current++;
-
-			t_qx += t_sx;
-			t_rx += t_tx;
-			if (t_rx >= 0)
-			{
-				t_qx++;
-				t_rx -= t_bx;
-			}
+			t_dst_pixel[x] = packed_bilinear_combine_4(t_fx, t_fy, t_p00, t_p10, t_p01, t_p11);
 		}
 
 		t_dst_pixel += t_dst_stride;
@@ -527,6 +705,8 @@ static void scaleimage_bilinear(void *p_src_ptr, uint4 p_src_stride, void *p_dst
 			t_ry -= t_by;
 		}
 	}
+
+	delete[] t_columns;
 }
 
 static void scaleimage_bicubic(void *p_src_ptr, uint4 p_src_stride, void *p_dst_ptr, uint4 p_dst_stride, uint4 p_src_width, uint4 p_src_height, uint4 p_dst_width, uint4 p_dst_height)
@@ -542,70 +722,31 @@ static void scaleimage_bicubic(void *p_src_ptr, uint4 p_src_stride, void *p_dst_
 	memset(tmp_data, 0, tmp_bytes_per_line * p_src_height);
 	memset(p_dst_ptr, 0, p_dst_stride * p_dst_height);
 
+	resize_seq_initialize();
+
 	// Temporary derivative arrays
 	real8* aa;
 	real8* bb;
 
+	aa = new real8[p_src_width];
 	if(p_src_width > p_src_height)
-		aa = new real8[p_src_width], bb = new real8[p_src_width];
+		bb = new real8[p_src_width * 4];
 	else
-		aa = new real8[p_src_height], bb = new real8[p_src_height];
+		bb = new real8[p_src_height * 4];
+
+	resize_seq_coefficients(p_src_width, aa);
 
 	// resizing rows
 	for(i=0 ; i< (signed)p_src_height ; i++)
 	{
-		// R
-		resize_seq_32_32(	(const uint1*)p_src_ptr + i * p_src_stride, p_src_width, 4,
-		                  (uint1*)tmp_data + i * tmp_bytes_per_line, p_dst_width, 4,
-		                  RED_OFFSET,
-		                  aa, bb);
-
-		// G
-		resize_seq_32_32(	(const uint1*)p_src_ptr + i * p_src_stride, p_src_width, 4,
-		                  (uint1*)tmp_data + i * tmp_bytes_per_line, p_dst_width, 4,
-		                  GREEN_OFFSET,
-		                  aa, bb);
-
-		// B
-		resize_seq_32_32(	(const uint1*)p_src_ptr + i * p_src_stride, p_src_width, 4,
-		                  (uint1*)tmp_data + i * tmp_bytes_per_line, p_dst_width, 4,
-		                  BLUE_OFFSET,
-		                  aa, bb);
-
-		// A
 		resize_seq_32_32(	(const uint1*)p_src_ptr + i * p_src_stride, p_src_width, 4,
 		                  (uint1*)tmp_data + i * tmp_bytes_per_line, p_dst_width, 4,
-		                  ALPHA_OFFSET,
+		                  s_resize_channels, 4,
 		                  aa, bb);
 	}
 
 	// resizing cols
-	for(i=0 ; i< (signed)p_dst_width ; i++)
-	{
-		// R
-		resize_seq_32_32(	(const uint1*)tmp_data + (i << 2), p_src_height, tmp_bytes_per_line,
-		                  (uint1*)p_dst_ptr + (i << 2), p_dst_height, p_dst_stride,
-		                  RED_OFFSET,
-		                  aa, bb);
-
-		// G
-		resize_seq_32_32(	(const uint1*)tmp_data + (i << 2), p_src_height, tmp_bytes_per_line,
-		                  (uint1*)p_dst_ptr + (i << 2), p_dst_height, p_dst_stride,
-		                  GREEN_OFFSET,
-		                  aa, bb);
-
-		// B
-		resize_seq_32_32(	(const uint1*)tmp_data + (i << 2), p_src_height, tmp_bytes_per_line,
-		                  (uint1*)p_dst_ptr + (i << 2), p_dst_height, p_dst_stride,
-		                  BLUE_OFFSET,
-		                  aa, bb);
-
-		// A
-		resize_seq_32_32(	(const uint1*)tmp_data + (i << 2), p_src_height, tmp_bytes_per_line,
-		                  (uint1*)p_dst_ptr + (i << 2), p_dst_height, p_dst_stride,
-		                  ALPHA_OFFSET,
-		                  aa, bb);
-	}	
+	resize_cols_32_32(tmp_data, tmp_bytes_per_line, p_src_height, (uint1*)p_dst_ptr, p_dst_stride, p_dst_width, p_dst_height, true, bb);
 
 	delete[] bb;
 	delete[] aa;
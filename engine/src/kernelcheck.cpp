@@ -0,0 +1,431 @@
+/* Copyright (C) 2003-2013 Runtime Revolution Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+// The kernel checks run each of the SSE2 pixel kernels against the scalar
+// code it replaces on random pixels, sizes and strides, and report any case
+// where the output differs. Every kernel is called through the same entry
+// point twice, once with SSE2 enabled and once with surface_set_sse2_enabled
+// turning it off.
+//
+// Usage: kernelcheck [ <iterations> [ <seed> ] ]
+//
+// The bilinear scaler and the tile classifier are static functions, so their
+// source files are included here rather than linked.
+
+#include "itransform.cpp"
+#include "tilecache.cpp"
+
+#include "bitmapeffectblur.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#define KERNELCHECK_SSE2
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+// These are referenced by the included sources, but never reached by the
+// checks.
+
+MCUIDC *MCscreen = NULL;
+uint4 g_current_background_colour = 0x000000;
+
+bool MCImageBitmapCreate(uindex_t p_width, uindex_t p_height, MCImageBitmap *&r_bitmap)
+{
+	return false;
+}
+
+bool MCTileCacheSoftwareCompositorConfigure(MCTileCacheRef p_tilecache, MCTileCacheCompositor& r_compositor)
+{
+	return false;
+}
+
+void MCU_set_rect(MCRectangle &rect, int2 x, int2 y, uint2 w, uint2 h)
+{
+	rect . x = x;
+	rect . y = y;
+	rect . width = w;
+	rect . height = h;
+}
+
+MCRectangle MCU_offset_rect(const MCRectangle& r, int2 ox, int2 oy)
+{
+	MCRectangle nr;
+	MCU_set_rect(nr, r . x + ox, r . y + oy, r . width, r . height);
+	return nr;
+}
+
+MCRectangle MCU_intersect_rect(const MCRectangle &one, const MCRectangle &two)
+{
+	int32_t t_left, t_top, t_right, t_bottom;
+	t_left = MCMax(one . x, two . x);
+	t_top = MCMax(one . y, two . y);
+	t_right = MCMin(one . x + one . width, two . x + two . width);
+	t_bottom = MCMin(one . y + one . height, two . y + two . height);
+
+	MCRectangle t_rect;
+	MCU_set_rect(t_rect, t_left, t_top, MCMax(t_right - t_left, 0), MCMax(t_bottom - t_top, 0));
+	return t_rect;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef KERNELCHECK_SSE2
+
+extern void surface_set_sse2_enabled(bool p_enabled);
+
+extern void surface_combine_blendSrcOver(void *p_dst, int32_t p_dst_stride, const void *p_src, uint32_t p_src_stride, uint32_t p_width, uint32_t p_height, uint8_t p_opacity);
+extern void surface_combine_blendSrcOver_masked(void *p_dst, int32_t p_dst_stride, const void *p_src, uint32_t p_src_stride, uint32_t p_width, uint32_t p_height, uint8_t p_opacity);
+extern void surface_combine_blendSrcOver_solid(void *p_dst, int32_t p_dst_stride, const void *p_src, uint32_t p_src_stride, uint32_t p_width, uint32_t p_height, uint8_t p_opacity);
+extern void surface_merge_with_alpha(void *p_pixels, uint4 p_pixel_stride, void *p_alpha, uint4 p_alpha_stride, uint4 p_width, uint4 p_height);
+
+static uint32_t s_random_state;
+
+static uint32_t MCKernelCheckRandom(void)
+{
+	// xorshift32, so runs are repeatable on every platform.
+	s_random_state ^= s_random_state << 13;
+	s_random_state ^= s_random_state >> 17;
+	s_random_state ^= s_random_state << 5;
+	return s_random_state;
+}
+
+// Returns a random value in [p_min, p_max].
+static uint32_t MCKernelCheckRandomIn(uint32_t p_min, uint32_t p_max)
+{
+	return p_min + MCKernelCheckRandom() % (p_max - p_min + 1);
+}
+
+enum MCKernelCheckPixelKind
+{
+	kMCKernelCheckPixelPremultiplied,
+	kMCKernelCheckPixelUnpremultiplied,
+	kMCKernelCheckPixelOpaque
+};
+
+// Return a random pixel of the given kind. A quarter of premultiplied pixels
+// are fully transparent or opaque, as those take special paths.
+static uint32_t MCKernelCheckRandomPixel(MCKernelCheckPixelKind p_kind)
+{
+	uint32_t t_alpha;
+	switch(p_kind)
+	{
+	case kMCKernelCheckPixelOpaque:
+		return 0xff000000 | (MCKernelCheckRandom() & 0xffffff);
+
+	case kMCKernelCheckPixelUnpremultiplied:
+		return MCKernelCheckRandom();
+
+	case kMCKernelCheckPixelPremultiplied:
+	default:
+		switch(MCKernelCheckRandom() % 8)
+		{
+		case 0:
+			return 0;
+		case 1:
+			t_alpha = 255;
+			break;
+		default:
+			t_alpha = MCKernelCheckRandom() % 256;
+			break;
+		}
+		break;
+	}
+
+	uint32_t t_pixel;
+	t_pixel = t_alpha << 24;
+	for(uint32_t i = 0; i < 24; i += 8)
+		t_pixel |= (MCKernelCheckRandom() % (t_alpha + 1)) << i;
+	return t_pixel;
+}
+
+static void MCKernelCheckFill(uint32_t *p_pixels, uint32_t p_count, MCKernelCheckPixelKind p_kind)
+{
+	for(uint32_t i = 0; i < p_count; i++)
+		p_pixels[i] = MCKernelCheckRandomPixel(p_kind);
+}
+
+static bool MCKernelCheckReport(const char *p_kernel, uint32_t p_iteration, bool p_same)
+{
+	if (!p_same)
+		fprintf(stderr, "%s: SSE2 and scalar results differ (iteration %u)\n", p_kernel, p_iteration);
+	return p_same;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef void (*MCKernelCheckCombiner)(void *p_dst, int32_t p_dst_stride, const void *p_src, uint32_t p_src_stride, uint32_t p_width, uint32_t p_height, uint8_t p_opacity);
+
+static bool MCKernelCheckCombine(const char *p_kernel, MCKernelCheckCombiner p_combiner, MCKernelCheckPixelKind p_src_kind, uint32_t p_iteration)
+{
+	uint32_t t_width, t_height, t_dst_stride, t_src_stride;
+	t_width = MCKernelCheckRandomIn(1, 67);
+	t_height = MCKernelCheckRandomIn(1, 9);
+	t_dst_stride = t_width + MCKernelCheckRandomIn(0, 5);
+	t_src_stride = t_width + MCKernelCheckRandomIn(0, 5);
+
+	uint8_t t_opacity;
+	t_opacity = MCKernelCheckRandom() % 2 == 0 ? 255 : MCKernelCheckRandom() % 256;
+
+	uint32_t *t_src, *t_dst_sse2, *t_dst_scalar;
+	t_src = new uint32_t[t_src_stride * t_height];
+	t_dst_sse2 = new uint32_t[t_dst_stride * t_height];
+	t_dst_scalar = new uint32_t[t_dst_stride * t_height];
+
+	MCKernelCheckFill(t_src, t_src_stride * t_height, p_src_kind);
+	MCKernelCheckFill(t_dst_sse2, t_dst_stride * t_height, kMCKernelCheckPixelPremultiplied);
+	memcpy(t_dst_scalar, t_dst_sse2, t_dst_stride * t_height * sizeof(uint32_t));
+
+	surface_set_sse2_enabled(true);
+	p_combiner(t_dst_sse2, t_dst_stride * 4, t_src, t_src_stride * 4, t_width, t_height, t_opacity);
+	surface_set_sse2_enabled(false);
+	p_combiner(t_dst_scalar, t_dst_stride * 4, t_src, t_src_stride * 4, t_width, t_height, t_opacity);
+
+	bool t_same;
+	t_same = memcmp(t_dst_sse2, t_dst_scalar, t_dst_stride * t_height * sizeof(uint32_t)) == 0;
+
+	delete[] t_src;
+	delete[] t_dst_sse2;
+	delete[] t_dst_scalar;
+
+	return MCKernelCheckReport(p_kernel, p_iteration, t_same);
+}
+
+static bool MCKernelCheckMergeWithAlpha(uint32_t p_iteration)
+{
+	uint32_t t_width, t_height, t_pixel_stride, t_alpha_stride;
+	t_width = MCKernelCheckRandomIn(1, 67);
+	t_height = MCKernelCheckRandomIn(1, 9);
+	t_pixel_stride = t_width + MCKernelCheckRandomIn(0, 5);
+	t_alpha_stride = t_width + MCKernelCheckRandomIn(0, 5);
+
+	uint32_t *t_pixels_sse2, *t_pixels_scalar;
+	t_pixels_sse2 = new uint32_t[t_pixel_stride * t_height];
+	t_pixels_scalar = new uint32_t[t_pixel_stride * t_height];
+	MCKernelCheckFill(t_pixels_sse2, t_pixel_stride * t_height, kMCKernelCheckPixelOpaque);
+	memcpy(t_pixels_scalar, t_pixels_sse2, t_pixel_stride * t_height * sizeof(uint32_t));
+
+	uint8_t *t_alpha;
+	t_alpha = new uint8_t[t_alpha_stride * t_height];
+	for(uint32_t i = 0; i < t_alpha_stride * t_height; i++)
+		t_alpha[i] = MCKernelCheckRandom() % 4 == 0 ? (MCKernelCheckRandom() % 2) * 255 : MCKernelCheckRandom() % 256;
+
+	surface_set_sse2_enabled(true);
+	surface_merge_with_alpha(t_pixels_sse2, t_pixel_stride * 4, t_alpha, t_alpha_stride, t_width, t_height);
+	surface_set_sse2_enabled(false);
+	surface_merge_with_alpha(t_pixels_scalar, t_pixel_stride * 4, t_alpha, t_alpha_stride, t_width, t_height);
+
+	bool t_same;
+	t_same = memcmp(t_pixels_sse2, t_pixels_scalar, t_pixel_stride * t_height * sizeof(uint32_t)) == 0;
+
+	delete[] t_pixels_sse2;
+	delete[] t_pixels_scalar;
+	delete[] t_alpha;
+
+	return MCKernelCheckReport("surface_merge_with_alpha", p_iteration, t_same);
+}
+
+// Blur the alpha of the given pixels into the mask, one scanline at a time.
+// As in MCBitmapEffectRender, the blur is passed its stride in pixels and a
+// pointer to the pixel at the top-left of the output rect.
+static bool MCKernelCheckDoBlur(const MCBitmapEffectBlurParameters& p_params, const MCRectangle& p_input_rect, const MCRectangle& p_output_rect, uint32_t *p_pixels, uint8_t *r_mask)
+{
+	uint32_t *t_src_pixels;
+	t_src_pixels = p_pixels + p_input_rect . width * (p_output_rect . y - p_input_rect . y) + (p_output_rect . x - p_input_rect . x);
+
+	MCBitmapEffectBlurRef t_blur;
+	if (!MCBitmapEffectBlurBegin(p_params, p_input_rect, p_output_rect, t_src_pixels, p_input_rect . width, t_blur))
+		return false;
+
+	for(uint32_t y = 0; y < p_output_rect . height; y++)
+		MCBitmapEffectBlurContinue(t_blur, r_mask + y * p_output_rect . width);
+
+	MCBitmapEffectBlurEnd(t_blur);
+
+	return true;
+}
+
+static bool MCKernelCheckBlur(uint32_t p_iteration)
+{
+	static const MCBitmapEffectFilter s_filters[] =
+	{
+		kMCBitmapEffectFilterFastGaussian,
+		kMCBitmapEffectFilterOnePassBox,
+		kMCBitmapEffectFilterTwoPassBox,
+		kMCBitmapEffectFilterThreePassBox
+	};
+
+	MCBitmapEffectBlurParameters t_params;
+	t_params . radius = MCKernelCheckRandomIn(0, 40);
+	t_params . spread = MCKernelCheckRandom() % 2 == 0 ? 0 : MCKernelCheckRandom() % 256;
+	t_params . filter = s_filters[MCKernelCheckRandom() % 4];
+
+	// The output is usually the input grown by the radius, as for drop shadows,
+	// but may be offset from it. The blurs step to their first source row with
+	// an unsigned stride, so the output must not start below the input.
+	MCRectangle t_input_rect, t_output_rect;
+	MCU_set_rect(t_input_rect, 0, 0, MCKernelCheckRandomIn(1, 90), MCKernelCheckRandomIn(1, 40));
+	MCU_set_rect(t_output_rect, (int32_t)MCKernelCheckRandomIn(0, 20) - 10 - t_params . radius, -(int32_t)MCKernelCheckRandomIn(0, 10 + t_params . radius), t_input_rect . width + 2 * t_params . radius, t_input_rect . height + 2 * t_params . radius);
+
+	uint32_t *t_pixels;
+	t_pixels = new uint32_t[t_input_rect . width * t_input_rect . height];
+	MCKernelCheckFill(t_pixels, t_input_rect . width * t_input_rect . height, kMCKernelCheckPixelPremultiplied);
+
+	uint32_t t_mask_size;
+	t_mask_size = t_output_rect . width * t_output_rect . height;
+
+	uint8_t *t_mask_sse2, *t_mask_scalar;
+	t_mask_sse2 = new uint8_t[t_mask_size];
+	t_mask_scalar = new uint8_t[t_mask_size];
+	memset(t_mask_sse2, 0, t_mask_size);
+	memset(t_mask_scalar, 0, t_mask_size);
+
+	bool t_same;
+	surface_set_sse2_enabled(true);
+	t_same = MCKernelCheckDoBlur(t_params, t_input_rect, t_output_rect, t_pixels, t_mask_sse2);
+	surface_set_sse2_enabled(false);
+	if (t_same)
+		t_same = MCKernelCheckDoBlur(t_params, t_input_rect, t_output_rect, t_pixels, t_mask_scalar);
+	if (t_same)
+		t_same = memcmp(t_mask_sse2, t_mask_scalar, t_mask_size) == 0;
+
+	delete[] t_pixels;
+	delete[] t_mask_sse2;
+	delete[] t_mask_scalar;
+
+	return MCKernelCheckReport("MCBitmapEffectBlur", p_iteration, t_same);
+}
+
+static bool MCKernelCheckTileMasks(uint32_t p_iteration)
+{
+	int32_t t_size;
+	t_size = MCKernelCheckRandomIn(1, 70);
+
+	uint32_t t_stride;
+	t_stride = t_size + MCKernelCheckRandomIn(0, 5);
+
+	// Most tiles in practice are constant, so make most of these constant
+	// but for a few pixels.
+	uint32_t *t_pixels;
+	t_pixels = new uint32_t[t_stride * t_size];
+	if (MCKernelCheckRandom() % 4 == 0)
+		MCKernelCheckFill(t_pixels, t_stride * t_size, kMCKernelCheckPixelPremultiplied);
+	else
+	{
+		uint32_t t_pixel;
+		t_pixel = MCKernelCheckRandomPixel(kMCKernelCheckPixelPremultiplied);
+		for(uint32_t i = 0; i < t_stride * t_size; i++)
+			t_pixels[i] = t_pixel;
+		for(uint32_t t_count = MCKernelCheckRandom() % 3; t_count > 0; t_count--)
+			t_pixels[MCKernelCheckRandom() % (t_stride * t_size)] = MCKernelCheckRandom();
+	}
+
+	uint32_t t_or_sse2, t_and_sse2, t_or_scalar, t_and_scalar;
+	surface_set_sse2_enabled(true);
+	MCTileCacheComputeTileMasks(t_size, t_pixels, t_stride, t_or_sse2, t_and_sse2);
+	surface_set_sse2_enabled(false);
+	MCTileCacheComputeTileMasks(t_size, t_pixels, t_stride, t_or_scalar, t_and_scalar);
+
+	delete[] t_pixels;
+
+	return MCKernelCheckReport("MCTileCacheComputeTileMasks", p_iteration, t_or_sse2 == t_or_scalar && t_and_sse2 == t_and_scalar);
+}
+
+static bool MCKernelCheckBilinear(uint32_t p_iteration)
+{
+	uint32_t t_src_width, t_src_height, t_dst_width, t_dst_height, t_src_stride, t_dst_stride;
+	t_src_width = MCKernelCheckRandomIn(1, 80);
+	t_src_height = MCKernelCheckRandomIn(1, 40);
+	t_dst_width = MCKernelCheckRandomIn(1, 160);
+	t_dst_height = MCKernelCheckRandomIn(1, 80);
+	t_src_stride = t_src_width + MCKernelCheckRandomIn(0, 5);
+	t_dst_stride = t_dst_width + MCKernelCheckRandomIn(0, 5);
+
+	uint32_t *t_src, *t_dst_sse2, *t_dst_scalar;
+	t_src = new uint32_t[t_src_stride * t_src_height];
+	t_dst_sse2 = new uint32_t[t_dst_stride * t_dst_height];
+	t_dst_scalar = new uint32_t[t_dst_stride * t_dst_height];
+	MCKernelCheckFill(t_src, t_src_stride * t_src_height, kMCKernelCheckPixelPremultiplied);
+	memset(t_dst_sse2, 0, t_dst_stride * t_dst_height * sizeof(uint32_t));
+	memset(t_dst_scalar, 0, t_dst_stride * t_dst_height * sizeof(uint32_t));
+
+	surface_set_sse2_enabled(true);
+	scaleimage_bilinear(t_src, t_src_stride * 4, t_dst_sse2, t_dst_stride * 4, t_src_width, t_src_height, t_dst_width, t_dst_height);
+	surface_set_sse2_enabled(false);
+	scaleimage_bilinear(t_src, t_src_stride * 4, t_dst_scalar, t_dst_stride * 4, t_src_width, t_src_height, t_dst_width, t_dst_height);
+
+	bool t_same;
+	t_same = memcmp(t_dst_sse2, t_dst_scalar, t_dst_stride * t_dst_height * sizeof(uint32_t)) == 0;
+
+	delete[] t_src;
+	delete[] t_dst_sse2;
+	delete[] t_dst_scalar;
+
+	return MCKernelCheckReport("scaleimage_bilinear", p_iteration, t_same);
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t t_iterations;
+	t_iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000;
+
+	s_random_state = argc > 2 ? strtoul(argv[2], NULL, 10) : 0x9e3779b9;
+	if (s_random_state == 0)
+		s_random_state = 1;
+
+	uint32_t t_failures;
+	t_failures = 0;
+	for(uint32_t i = 0; i < t_iterations; i++)
+	{
+		if (!MCKernelCheckCombine("surface_combine_blendSrcOver", surface_combine_blendSrcOver, kMCKernelCheckPixelPremultiplied, i))
+			t_failures++;
+		if (!MCKernelCheckCombine("surface_combine_blendSrcOver_masked", surface_combine_blendSrcOver_masked, kMCKernelCheckPixelUnpremultiplied, i))
+			t_failures++;
+		if (!MCKernelCheckCombine("surface_combine_blendSrcOver_solid", surface_combine_blendSrcOver_solid, kMCKernelCheckPixelOpaque, i))
+			t_failures++;
+		if (!MCKernelCheckMergeWithAlpha(i))
+			t_failures++;
+		if (!MCKernelCheckBlur(i))
+			t_failures++;
+		if (!MCKernelCheckTileMasks(i))
+			t_failures++;
+		if (!MCKernelCheckBilinear(i))
+			t_failures++;
+	}
+
+	surface_set_sse2_enabled(true);
+
+	if (t_failures != 0)
+	{
+		fprintf(stderr, "%u of %u checks failed\n", t_failures, t_iterations * 7);
+		return 1;
+	}
+
+	printf("All %u checks passed\n", t_iterations * 7);
+	return 0;
+}
+
+#else
+
+int main(int argc, char *argv[])
+{
+	printf("SSE2 is not used on this platform, so there is nothing to check\n");
+	return 0;
+}
+
+#endif
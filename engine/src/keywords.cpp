@@ -1330,6 +1330,7 @@ Parse_stat MCPass::parse(MCScriptPoint &sp)
 		MCperror -> add(PE_PRIVATE_BADPASS, sp);
 		return PS_ERROR;
 	}
+	sp.gethandler() -> setcanpass();
 	return PS_NORMAL;
 }
 
@@ -1364,6 +1365,83 @@ MCSwitch::~MCSwitch()
 	delete cases;
 	deletestatements(statements);
 	delete caseoffsets;
+	delete[] caseliterals;
+	delete[] casehashes;
+	delete[] casetable;
+}
+
+void MCSwitch::buildcasetable(void)
+{
+	for(uint2 i = 0; i < ncases; i++)
+		if (cases[i] -> getliteralvalue() != nil)
+			nliterals++;
+
+	if (nliterals == 0)
+		return;
+
+	caseliterals = new MCNameRef[ncases];
+	casehashes = new uint4[ncases];
+
+	// Keep the table at most half full, so probe sequences stay short.
+	ncaseslots = 8;
+	while(ncaseslots < nliterals * 2)
+		ncaseslots *= 2;
+	casetable = new uint2[ncaseslots];
+	memset(casetable, 0, sizeof(uint2) * ncaseslots);
+
+	for(uint2 i = 0; i < ncases; i++)
+	{
+		caseliterals[i] = cases[i] -> getliteralvalue();
+		if (caseliterals[i] == nil)
+		{
+			casehashes[i] = 0;
+			continue;
+		}
+
+		MCString t_value;
+		t_value = MCNameGetOldString(caseliterals[i]);
+		casehashes[i] = MCHashChars(t_value . getstring(), t_value . getlength(), kMCCompareCaseless, 0);
+
+		uint4 t_slot;
+		t_slot = casehashes[i] & (ncaseslots - 1);
+		while(casetable[t_slot] != 0)
+			t_slot = (t_slot + 1) & (ncaseslots - 1);
+		casetable[t_slot] = i + 1;
+	}
+}
+
+// Return the index of the first literal case equal to the given value, or -1
+// if there is none.
+int4 MCSwitch::findliteralcase(const MCString& p_value, Boolean p_case_sensitive)
+{
+	uint4 t_hash;
+	t_hash = MCHashChars(p_value . getstring(), p_value . getlength(), kMCCompareCaseless, 0);
+
+	// The hash is caseless, so all the literals equal to the value are in the
+	// probe sequence whichever way we are comparing - the first in the switch
+	// is the one we want.
+	int4 t_match;
+	t_match = -1;
+	for(uint4 t_slot = t_hash & (ncaseslots - 1); casetable[t_slot] != 0; t_slot = (t_slot + 1) & (ncaseslots - 1))
+	{
+		uint2 t_case;
+		t_case = casetable[t_slot] - 1;
+		if (casehashes[t_case] != t_hash || (t_match != -1 && t_case > t_match))
+			continue;
+
+		MCString t_literal;
+		t_literal = MCNameGetOldString(caseliterals[t_case]);
+		if (t_literal . getlength() != p_value . getlength())
+			continue;
+
+		const char *s1 = t_literal . getstring();
+		const char *s2 = p_value . getstring();
+		if ((p_case_sensitive && !strncmp(s1, s2, p_value . getlength()))
+		        || (!p_case_sensitive && !MCU_strncasecmp(s1, s2, p_value . getlength())))
+			t_match = t_case;
+	}
+
+	return t_match;
 }
 
 Parse_stat MCSwitch::parse(MCScriptPoint &sp)
@@ -1440,6 +1518,7 @@ Parse_stat MCSwitch::parse(MCScriptPoint &sp)
 						(PE_SWITCH_WANTEDENDSWITCH, sp);
 						return PS_ERROR;
 					}
+					buildcasetable();
 					return PS_NORMAL;
 				default: /* token type */
 					MCperror->add
@@ -1457,6 +1536,7 @@ Parse_stat MCSwitch::parse(MCScriptPoint &sp)
 			}
 			continue;
 		case PS_EOF:
+			buildcasetable();
 			return PS_NORMAL;
 		default:
 			MCperror->add
@@ -1500,9 +1580,31 @@ Exec_stat MCSwitch::exec(MCExecPoint &ep)
 	else
 		ep2.setboolean(true);
 	int2 match = defaultcase;
+
+	// Find the first literal case which matches, then only the non-literal
+	// cases before it need to be evaluated (in order) to see if any of them
+	// match first.
+	uint2 t_case_limit;
+	t_case_limit = ncases;
+	if (nliterals != 0)
+	{
+		int4 t_literal_match;
+		t_literal_match = findliteralcase(ep2.getsvalue(), ep.getcasesensitive());
+		if (t_literal_match != -1)
+		{
+			match = caseoffsets[t_literal_match];
+			t_case_limit = t_literal_match;
+		}
+		if (nliterals == ncases)
+			t_case_limit = 0;
+	}
+
 	uint2 i;
-	for (i = 0 ; i < ncases ; i++)
+	for (i = 0 ; i < t_case_limit ; i++)
 	{
+		if (nliterals != 0 && caseliterals[i] != nil)
+			continue;
+
 		while ((stat = cases[i]->eval(ep)) != ES_NORMAL
 		        && (MCtrace || MCnbreakpoints) && !MCtrylock && !MClockerrors)
 			MCB_error(ep2, getline(), getpos(), EE_SWITCH_BADCASE);
@@ -155,6 +155,20 @@ class MCSwitch : public MCStatement
 	uint2 *caseoffsets;
 	int2 defaultcase;
 	uint2 ncases;
+
+	// The cases which are literals are put into a hash table at parse time so
+	// that the matching one can be found without evaluating and comparing each
+	// in turn. 'caseliterals' holds the value of each case (nil if it is not
+	// a literal), 'casehashes' the caseless hash of each literal and
+	// 'casetable' the (open-addressed) table of case indices plus one.
+	MCNameRef *caseliterals;
+	uint4 *casehashes;
+	uint2 *casetable;
+	uint4 ncaseslots;
+	uint2 nliterals;
+
+	void buildcasetable(void);
+	int4 findliteralcase(const MCString& p_value, Boolean p_case_sensitive);
 public:
 	MCSwitch()
 	{
@@ -164,6 +178,11 @@ public:
 		defaultcase = -1;
 		caseoffsets = NULL;
 		ncases = 0;
+		caseliterals = NULL;
+		casehashes = NULL;
+		casetable = NULL;
+		ncaseslots = 0;
+		nliterals = 0;
 	}
 	~MCSwitch();
 	virtual Parse_stat parse(MCScriptPoint &sp);
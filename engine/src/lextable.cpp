@@ -711,6 +711,8 @@ LT factor_table[] =
         {"diskspace", TT_FUNCTION, F_DISK_SPACE},
         {"div", TT_BINOP, O_DIV},
         {"dnsservers", TT_FUNCTION, F_DNS_SERVERS},
+		{"docachesize", TT_PROPERTY, P_DO_CACHE_SIZE},
+		{"docachestats", TT_PROPERTY, P_DO_CACHE_STATS},
 		{"document", TT_CHUNK, CT_DOCUMENT},
 		// MW-2011-11-24: [[ Nice Folders ]] The adjective for 'the documents folder'.
 		{"documents", TT_PROPERTY, P_DOCUMENTS_FOLDER},
@@ -928,6 +930,7 @@ LT factor_table[] =
         {"idleticks", TT_PROPERTY, P_IDLE_TICKS},
         {"image", TT_CHUNK, CT_IMAGE},
 		{"imagecachelimit", TT_PROPERTY, P_IMAGE_CACHE_LIMIT},
+		{"imagecachestats", TT_PROPERTY, P_IMAGE_CACHE_STATS},
 		{"imagecacheusage", TT_PROPERTY, P_IMAGE_CACHE_USAGE},
         {"imagedata", TT_PROPERTY, P_IMAGE_DATA},
         {"imagepixmapid", TT_PROPERTY, P_IMAGE_PIXMAP_ID},
@@ -1271,6 +1274,8 @@ LT factor_table[] =
 #ifdef MODE_DEVELOPMENT
 		{"referringstack", TT_PROPERTY, P_REFERRING_STACK},
 #endif
+		{"regexcachesize", TT_PROPERTY, P_REGEX_CACHE_SIZE},
+		{"regexcachestats", TT_PROPERTY, P_REGEX_CACHE_STATS},
         {"rel", TT_TO, PT_RELATIVE},
         {"relative", TT_TO, PT_RELATIVE},
         {"relativepoints", TT_PROPERTY, P_RELATIVE_POINTS},
@@ -1341,6 +1346,7 @@ LT factor_table[] =
         {"screenvendor", TT_FUNCTION, F_SCREEN_VENDOR},
         {"script", TT_PROPERTY, P_SCRIPT},
 		{"scriptexecutionerrors", TT_PROPERTY, P_SCRIPT_EXECUTION_ERRORS},
+        {"scriptcachestats", TT_PROPERTY, P_SCRIPT_CACHE_STATS},
         {"scriptlimits", TT_FUNCTION, F_SCRIPT_LIMITS},
 		{"scriptparsingerrors", TT_PROPERTY, P_SCRIPT_PARSING_ERRORS},
         {"scripttextfont", TT_PROPERTY, P_SCRIPT_TEXT_FONT},
@@ -1903,9 +1909,12 @@ static LT sugar_table[] =
 		{"open", TT_UNDEFINED, SG_OPEN},
 		{"optimized", TT_UNDEFINED, SG_OPTIMIZED},
 		{"options", TT_UNDEFINED, SG_OPTIONS},
+		{"pattern", TT_UNDEFINED, SG_PATTERN},
+		{"regex", TT_UNDEFINED, SG_REGEX},
 		{"standard", TT_UNDEFINED, SG_STANDARD},
 		{"unicode", TT_UNDEFINED, SG_UNICODE},
 		{"url", TT_UNDEFINED, SG_URL},
+		{"wildcard", TT_UNDEFINED, SG_WILDCARD},
 		{"without", TT_PREP, PT_WITHOUT},
     };
 
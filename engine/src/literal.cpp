@@ -36,6 +36,11 @@ Exec_stat MCLiteral::eval(MCExecPoint &ep)
 	return ES_NORMAL;
 }
 
+MCNameRef MCLiteral::getliteralvalue(void)
+{
+	return value;
+}
+
 Parse_stat MCLiteralNumber::parse(MCScriptPoint &sp, Boolean the)
 {
 	initpoint(sp);
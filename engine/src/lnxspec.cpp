@@ -63,6 +63,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include <sys/mman.h>
 #include <sys/dir.h>
 #include <sys/wait.h>
+#include <sys/epoll.h>
 #include <dlfcn.h>
 #include <termios.h>
 #include <langinfo.h>
@@ -1674,11 +1675,204 @@ void MCS_unloadmodule(MCSysModuleHandle p_module)
 	dlclose ( p_module ) ;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Sockets are waited on with epoll rather than select, so there is no limit on
+// fd numbers and a poll only costs in proportion to the sockets which are ready.
+// A socket registers for the events its state calls for whenever that state may
+// have changed (setselect, a message being queued for it, or it being serviced)
+// - such sockets are put on a dirty list which is brought up to date at the
+// start of the next poll. The epoll fd itself is waited on by the select() for
+// the other fds the engine is interested in.
+
+static int s_poll_fd = -1;
+static MCSocket **s_poll_dirty = NULL;
+static uint4 s_poll_ndirty = 0;
+static uint4 s_poll_maxdirty = 0;
+
+// The events to wait for on a socket - this mirrors the fd_sets that used to be
+// built for select().
+static uint32_t MCS_poll_socket_events(MCSocket *s)
+{
+	// Shared sockets use the fd of the datagram socket which accepted them, it
+	// is that socket which is waited on.
+	if (s->fd == 0 || s->shared)
+		return 0;
+
+	if (s->resolve_state == kMCSocketStateResolving ||
+		s->resolve_state == kMCSocketStateError)
+		return 0;
+
+	uint32_t t_events;
+	t_events = 0;
+	if (s->connected && !s->closing || s->accepting)
+		t_events |= EPOLLIN;
+	if (!s->connected || s->wevents != NULL)
+		t_events |= EPOLLOUT;
+
+	// A socket with nothing to wait for is taken out of the epoll set entirely,
+	// otherwise it would still be reported for hangups.
+	if (t_events != 0)
+		t_events |= EPOLLPRI;
+
+	return t_events;
+}
+
+static void MCS_poll_update_socket(MCSocket *s)
+{
+	uint32_t t_events;
+	t_events = MCS_poll_socket_events(s);
+	if (t_events == s->pollevents)
+		return;
+
+	if (s_poll_fd == -1)
+	{
+		s_poll_fd = epoll_create1(EPOLL_CLOEXEC);
+		if (s_poll_fd == -1)
+			return;
+	}
+
+	struct epoll_event t_event;
+	memset(&t_event, 0, sizeof(struct epoll_event));
+	t_event . events = t_events;
+	t_event . data . ptr = s;
+
+	int t_op;
+	if (s->pollevents == 0)
+		t_op = EPOLL_CTL_ADD;
+	else if (t_events == 0)
+		t_op = EPOLL_CTL_DEL;
+	else
+		t_op = EPOLL_CTL_MOD;
+
+	int t_result;
+	t_result = epoll_ctl(s_poll_fd, t_op, s->fd, &t_event);
+
+	// If the fd was closed behind our back, it has already left the epoll set.
+	if (t_result == -1 && errno == ENOENT && t_op == EPOLL_CTL_MOD)
+		t_result = epoll_ctl(s_poll_fd, EPOLL_CTL_ADD, s->fd, &t_event);
+
+	if (t_result == 0 || t_op == EPOLL_CTL_DEL)
+		s->pollevents = t_events;
+}
+
+void MCS_poll_socket_changed(MCSocket *s)
+{
+	if (s->polldirty)
+		return;
+
+	if (s_poll_ndirty == s_poll_maxdirty)
+	{
+		uint4 t_new_max;
+		t_new_max = s_poll_maxdirty == 0 ? 32 : s_poll_maxdirty * 2;
+		MCU_realloc((char **)&s_poll_dirty, s_poll_ndirty, t_new_max, sizeof(MCSocket *));
+		s_poll_maxdirty = t_new_max;
+	}
+	s_poll_dirty[s_poll_ndirty++] = s;
+	s->polldirty = True;
+}
+
+// Called before the socket's fd is closed.
+void MCS_poll_socket_closed(MCSocket *s)
+{
+	if (s->pollevents != 0 && s->fd != 0)
+	{
+		struct epoll_event t_event;
+		memset(&t_event, 0, sizeof(struct epoll_event));
+		epoll_ctl(s_poll_fd, EPOLL_CTL_DEL, s->fd, &t_event);
+	}
+	s->pollevents = 0;
+}
+
+void MCS_poll_socket_deleted(MCSocket *s)
+{
+	MCS_poll_socket_closed(s);
+
+	if (!s->polldirty)
+		return;
+
+	for(uint4 i = 0; i < s_poll_ndirty; i++)
+		if (s_poll_dirty[i] == s)
+		{
+			s_poll_dirty[i] = s_poll_dirty[--s_poll_ndirty];
+			break;
+		}
+	s->polldirty = False;
+}
+
+// Bring the epoll set up to date, returning true if any of the sockets which
+// changed has had a message queued.
+static bool MCS_poll_sync_sockets(void)
+{
+	bool t_added;
+	t_added = false;
+	for(uint4 i = 0; i < s_poll_ndirty; i++)
+	{
+		MCSocket *s;
+		s = s_poll_dirty[i];
+		s->polldirty = False;
+		if (s->added)
+		{
+			s->added = False;
+			t_added = true;
+		}
+		MCS_poll_update_socket(s);
+	}
+	s_poll_ndirty = 0;
+	return t_added;
+}
+
+// Service the sockets which are ready.
+static void MCS_poll_dispatch_sockets(void)
+{
+	struct epoll_event t_events[256];
+	int t_count;
+	do
+		t_count = epoll_wait(s_poll_fd, t_events, 256, 0);
+	while(t_count == -1 && errno == EINTR);
+
+	for(int i = 0; i < t_count; i++)
+	{
+		MCSocket *s;
+		s = (MCSocket *)t_events[i] . data . ptr;
+
+		// The socket might have been closed servicing an earlier one, and what
+		// it is interested in might have changed since it was registered.
+		if (s->fd == 0)
+			continue;
+
+		uint32_t t_wanted;
+		t_wanted = MCS_poll_socket_events(s);
+		uint32_t t_ready;
+		t_ready = t_events[i] . events;
+		if (t_ready & EPOLLPRI)
+		{
+			if (!s->waiting)
+			{
+				s->error = strclone("select error");
+				s->doclose();
+			}
+		}
+		else
+		{
+			/* read first here, otherwise a situation can arise when select indicates
+			 * read & write on the socket as part of the sslconnect handshaking
+			 * and so consumed during writesome() leaving no data to read
+			 */
+			if ((t_ready & (EPOLLIN | EPOLLERR | EPOLLHUP)) && (t_wanted & EPOLLIN))
+				s->readsome();
+			if (s->fd != 0 && (t_ready & (EPOLLOUT | EPOLLERR | EPOLLHUP)) && (t_wanted & EPOLLOUT))
+				s->writesome();
+		}
+
+		MCS_poll_socket_changed(s);
+	}
+}
+
 Boolean MCS_poll(real8 delay, int fd)
 {
 	Boolean readinput = False;
 	int4 n;
-	uint2 i;
 	Boolean wasalarm = alarmpending;
 	Boolean handled = False;
 	if (alarmpending)
@@ -1708,26 +1902,16 @@ Boolean MCS_poll(real8 delay, int fd)
 		if (MCinputfd > maxfd)
 			maxfd = MCinputfd;
 	}
-	for (i = 0 ; i < MCnsockets ; i++)
+	if (MCS_poll_sync_sockets())
 	{
-		if (MCsockets[i]->resolve_state != kMCSocketStateResolving &&
-		   MCsockets[i]->resolve_state != kMCSocketStateError)
-		{
-			if (MCsockets[i]->connected && !MCsockets[i]->closing
-				&& !MCsockets[i]->shared || MCsockets[i]->accepting)
-				FD_SET(MCsockets[i]->fd, &rmaskfd);
-			if (!MCsockets[i]->connected || MCsockets[i]->wevents != NULL)
-				FD_SET(MCsockets[i]->fd, &wmaskfd);
-			FD_SET(MCsockets[i]->fd, &emaskfd);
-			if (MCsockets[i]->fd > maxfd)
-				maxfd = MCsockets[i]->fd;
-			if (MCsockets[i]->added)
-			{
-				delay = 0.0;
-				MCsockets[i]->added = False;
-				handled = True;
-			}
-		}
+		delay = 0.0;
+		handled = True;
+	}
+	if (s_poll_fd != -1)
+	{
+		FD_SET(s_poll_fd, &rmaskfd);
+		if (s_poll_fd > maxfd)
+			maxfd = s_poll_fd;
 	}
 
 	if (g_notify_pipe[0] != -1)
@@ -1750,28 +1934,8 @@ Boolean MCS_poll(real8 delay, int fd)
 		return True;
 	if (MCinputfd != -1 && FD_ISSET(MCinputfd, &rmaskfd))
 		readinput = True;
-	for (i = 0 ; i < MCnsockets ; i++)
-	{
-		if (FD_ISSET(MCsockets[i]->fd, &emaskfd))
-		{
-			if (!MCsockets[i]->waiting)
-			{
-				MCsockets[i]->error = strclone("select error");
-				MCsockets[i]->doclose();
-			}
-		}
-		else
-		{
-			/* read first here, otherwise a situation can arise when select indicates
-			 * read & write on the socket as part of the sslconnect handshaking
-			 * and so consumed during writesome() leaving no data to read
-			 */
-			if (FD_ISSET(MCsockets[i]->fd, &rmaskfd) && !MCsockets[i]->shared)
-				MCsockets[i]->readsome();
-			if (FD_ISSET(MCsockets[i]->fd, &wmaskfd))
-				MCsockets[i]->writesome();
-		}
-	}
+	if (s_poll_fd != -1 && FD_ISSET(s_poll_fd, &rmaskfd))
+		MCS_poll_dispatch_sockets();
 	
 	if (g_notify_pipe[0] != -1 && FD_ISSET(g_notify_pipe[0], &rmaskfd))
 	{
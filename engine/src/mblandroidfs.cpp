@@ -348,6 +348,22 @@ bool MCAndroidSystem::FileNotAccessible(const char *p_path)
 	return false;
 }
 
+bool MCAndroidSystem::GetFileInfo(const char *p_path, int64_t& r_size, uint32_t& r_modification_time)
+{
+	// Files in the apk have no stat info of their own.
+	if (is_apk_path(p_path))
+		return false;
+
+	struct stat t_info;
+	if (stat(p_path, &t_info) != 0 || (t_info . st_mode & S_IFDIR) != 0)
+		return false;
+
+	r_size = t_info . st_size;
+	r_modification_time = t_info . st_mtime;
+
+	return true;
+}
+
 bool MCAndroidSystem::ChangePermissions(const char *p_path, uint2 p_mask)
 {
 	if (is_apk_path(p_path))
@@ -65,6 +65,7 @@ public:
 	bool FileExists(const char *p_path);
 	bool FolderExists(const char *p_path);
 	bool FileNotAccessible(const char *p_path);
+	bool GetFileInfo(const char *p_path, int64_t& r_size, uint32_t& r_modification_time);
 	
 	bool ChangePermissions(const char *p_path, uint2 p_mask);
 	uint2 UMask(uint2 p_mask);
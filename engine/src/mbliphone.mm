@@ -514,6 +514,18 @@ bool MCIPhoneSystem::FileNotAccessible(const char *p_path)
 	return false;
 }
 
+bool MCIPhoneSystem::GetFileInfo(const char *p_path, int64_t& r_size, uint32_t& r_modification_time)
+{
+	struct stat t_info;
+	if (stat(p_path, &t_info) != 0 || (t_info . st_mode & S_IFDIR) != 0)
+		return false;
+	
+	r_size = t_info . st_size;
+	r_modification_time = t_info . st_mtime;
+	
+	return true;
+}
+
 bool MCIPhoneSystem::ChangePermissions(const char *p_path, uint2 p_mask)
 {
 	return chmod(p_path, p_mask) == 0;
@@ -844,6 +844,13 @@ const char *MCS_get_session_id(void)
 	return NULL;
 }
 
+void MCS_get_script_cache_stats(uint32_t& r_hits, uint32_t& r_misses, uint32_t& r_invalidations)
+{
+	r_hits = 0;
+	r_misses = 0;
+	r_invalidations = 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 int MCA_file(MCExecPoint& ep, const char *p_title, const char *p_prompt, const char *p_filter, const char *p_initial, unsigned int p_options)
@@ -135,57 +135,162 @@ void IO_cleanprocesses()
 			i++;
 }
 
+// The open sockets are kept in MCsockets in the order they were opened, with a
+// hash index from name to socket alongside so that finding one by name doesn't
+// require a search. Each socket records its position in MCsockets, and the
+// sockets with the same name hash are chained in the same order as MCsockets.
+
+static MCSocket **s_socket_buckets = NULL;
+static uint4 s_socket_bucket_count = 0;
+static uint4 s_socket_capacity = 0;
+
+static uint4 IO_hashsocketname(const char *p_name)
+{
+	return MCHashChars(p_name, p_name != NULL ? strlen(p_name) : 0, kMCCompareExact, 0);
+}
+
+// Rebuild the name index with (at least) the given number of buckets.
+static void IO_rehashsockets(uint4 p_bucket_count)
+{
+	delete[] s_socket_buckets;
+	s_socket_buckets = new MCSocket *[p_bucket_count];
+	memset(s_socket_buckets, 0, sizeof(MCSocket *) * p_bucket_count);
+	s_socket_bucket_count = p_bucket_count;
+
+	// Insert in reverse so that each chain ends up in MCsockets order.
+	for(uint4 i = MCnsockets; i > 0; i--)
+	{
+		MCSocket *s;
+		s = MCsockets[i - 1];
+		uint4 t_bucket;
+		t_bucket = s -> namehash & (s_socket_bucket_count - 1);
+		s -> namenext = s_socket_buckets[t_bucket];
+		s_socket_buckets[t_bucket] = s;
+	}
+}
+
+static void IO_unindexsocket(MCSocket *s)
+{
+	MCSocket **t_link;
+	for(t_link = &s_socket_buckets[s -> namehash & (s_socket_bucket_count - 1)]; *t_link != s; t_link = &(*t_link) -> namenext)
+		;
+	*t_link = s -> namenext;
+}
+
+// Whether the socket has finished with and can be deleted.
+static bool IO_socketisdone(MCSocket *s)
+{
+	return !s->waiting && s->fd == 0 && s->nread == 0 && s->resolve_state != kMCSocketStateResolving;
+}
+
+void IO_addsocket(MCSocket *s)
+{
+	if (MCnsockets == s_socket_capacity)
+	{
+		uint4 t_new_capacity;
+		t_new_capacity = s_socket_capacity == 0 ? 16 : s_socket_capacity * 2;
+		MCU_realloc((char **)&MCsockets, MCnsockets, t_new_capacity, sizeof(MCSocket *));
+		s_socket_capacity = t_new_capacity;
+	}
+
+	s -> index = MCnsockets;
+	s -> namehash = IO_hashsocketname(s -> name);
+	s -> namenext = NULL;
+	MCsockets[MCnsockets++] = s;
+
+	if (MCnsockets > s_socket_bucket_count)
+		IO_rehashsockets(s_socket_capacity);
+	else
+	{
+		MCSocket **t_link;
+		for(t_link = &s_socket_buckets[s -> namehash & (s_socket_bucket_count - 1)]; *t_link != NULL; t_link = &(*t_link) -> namenext)
+			;
+		*t_link = s;
+	}
+}
+
+void IO_freesockets(void)
+{
+	while (MCnsockets)
+		delete MCsockets[--MCnsockets];
+	delete MCsockets;
+	MCsockets = NULL;
+	s_socket_capacity = 0;
+	delete[] s_socket_buckets;
+	s_socket_buckets = NULL;
+	s_socket_bucket_count = 0;
+}
+
 real8 IO_cleansockets(real8 ctime)
 {
 	real8 etime = ctime + MCmaxwait;
-	uint2 i = 0;
-	while (i < MCnsockets)
-		if (!MCsockets[i]->waiting && MCsockets[i]->fd == 0
-			&& MCsockets[i]->nread == 0 && MCsockets[i]->resolve_state != kMCSocketStateResolving)
+
+	// Sockets which are done are deleted and the rest moved down over them in a
+	// single pass, so MCsockets stays in the order the sockets were opened.
+	uint4 j = 0;
+	for (uint4 i = 0 ; i < MCnsockets ; i++)
+	{
+		MCSocket *s = MCsockets[i];
+		if (IO_socketisdone(s))
 		{
-			delete MCsockets[i];
-			uint2 j = i;
-			while (++j < MCnsockets)
-				MCsockets[j - 1] = MCsockets[j];
-			MCnsockets--;
+			IO_unindexsocket(s);
+			delete s;
+			continue;
 		}
-		else
+
+		s->index = j;
+		MCsockets[j++] = s;
+
+		if (!s->waiting && !s->accepting
+		        && (!s->connected && ctime > s->timeout
+		            || s->wevents != NULL && ctime > s->wevents->timeout
+		            || s->revents != NULL && ctime > s->revents->timeout))
 		{
-			MCSocket *s = MCsockets[i++];
-			if (!s->waiting && !s->accepting
-			        && (!s->connected && ctime > s->timeout
-			            || s->wevents != NULL && ctime > s->wevents->timeout
-			            || s->revents != NULL && ctime > s->revents->timeout))
-			{
-				if (!s->connected)
-					s->timeout = ctime  + MCsockettimeout;
-				if (s->revents != NULL)
-					s->revents->timeout = ctime + MCsockettimeout;
-				if (s->wevents != NULL)
-					s->wevents->timeout = ctime + MCsockettimeout;
-				MCscreen->delaymessage(s->object, MCM_socket_timeout, strclone(s->name));
-			}
-			if (s->wevents != NULL && s->wevents->timeout < etime)
-				etime = s->wevents->timeout;
-			if (s->revents != NULL && s->revents->timeout < etime)
-				etime = s->revents->timeout;
+			if (!s->connected)
+				s->timeout = ctime  + MCsockettimeout;
+			if (s->revents != NULL)
+				s->revents->timeout = ctime + MCsockettimeout;
+			if (s->wevents != NULL)
+				s->wevents->timeout = ctime + MCsockettimeout;
+			MCscreen->delaymessage(s->object, MCM_socket_timeout, strclone(s->name));
 		}
+		if (s->wevents != NULL && s->wevents->timeout < etime)
+			etime = s->wevents->timeout;
+		if (s->revents != NULL && s->revents->timeout < etime)
+			etime = s->revents->timeout;
+	}
+	MCnsockets = j;
 	return etime;
 }
 
-Boolean IO_findsocket(const char *name, uint2 &i)
+Boolean IO_findsocket(const char *name, uint4 &i)
 {
-	IO_cleansockets(MCS_time());
-	for (i = 0 ; i < MCnsockets ; i++)
-		if (strequal(MCsockets[i]->name, name))
+	if (name == NULL || s_socket_bucket_count == 0)
+		return False;
+
+	uint4 t_hash;
+	t_hash = IO_hashsocketname(name);
+	for(MCSocket *s = s_socket_buckets[t_hash & (s_socket_bucket_count - 1)]; s != NULL; s = s -> namenext)
+		if (s -> namehash == t_hash && strequal(s->name, name))
+		{
+			// A socket which is done is no longer open, so clear it out and look
+			// again in case another has the same name.
+			if (IO_socketisdone(s))
+			{
+				IO_cleansockets(MCS_time());
+				return IO_findsocket(name, i);
+			}
+			i = s -> index;
 			return True;
+		}
+
 	return False;
 }
 
 void IO_freeobject(MCObject *o)
 {
 	IO_cleansockets(MCS_time());
-	uint2 i = 0;
+	uint4 i = 0;
 	while (i < MCnsockets)
 #if 1
 	{
@@ -197,7 +302,7 @@ void IO_freeobject(MCObject *o)
 		if (MCsockets[i]->object == o)
 		{
 			delete MCsockets[i];
-			uint2 j = i;
+			uint4 j = i;
 			while (++j < MCnsockets)
 				MCsockets[j - 1] = MCsockets[j];
 			MCnsockets--;
@@ -55,7 +55,9 @@ extern Boolean IO_findfile(const char *name, uint2 &i);
 extern Boolean IO_closefile(const char *name);
 extern Boolean IO_findprocess(const char *name, uint2 &i);
 extern void IO_cleanprocesses();
-extern Boolean IO_findsocket(const char *name, uint2 &i);
+extern Boolean IO_findsocket(const char *name, uint4 &i);
+extern void IO_addsocket(MCSocket *s);
+extern void IO_freesockets(void);
 extern real8 IO_cleansockets(real8 ctime);
 extern void IO_freeobject(MCObject *o);
 extern IO_stat IO_read(void *ptr, uint4 size, uint4 &n, IO_handle stream);
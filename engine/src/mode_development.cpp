@@ -341,6 +341,7 @@ bool MCDispatch::isolatedsend(const char *p_stack_data, uint32_t p_stack_data_le
 	MCusing = nil;
 	MCbackscripts = nil;
 	MCfrontscripts = nil;
+	MCscriptepoch++;
 	
 	// Load the stack
 	MCExecPoint ep;
@@ -378,6 +379,7 @@ bool MCDispatch::isolatedsend(const char *p_stack_data, uint32_t p_stack_data_le
 	MCusing = t_old_using;
 	MCbackscripts = t_old_backscripts;
 	MCfrontscripts = t_old_frontscripts;
+	MCscriptepoch++;
 	stacks = t_old_stacks;
 	MCallowinterrupts = t_old_allow_interrupts;
 
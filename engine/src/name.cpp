@@ -495,6 +495,27 @@ static bool chars_equal(const char *a, uindex_t ac, const char *b, uindex_t bc)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+uint32_t MCHashChars(const char *p_chars, uindex_t p_char_count, MCCompareOptions p_options, uint32_t p_seed)
+{
+	uint32_t t_hash;
+	t_hash = p_seed;
+	for(uindex_t i = 0; i < p_char_count; i++)
+	{
+		if (p_options == kMCCompareCaseless)
+			t_hash += MCS_tolower((uint1)p_chars[i]);
+		else
+			t_hash += (uint1)p_chars[i];
+		t_hash += (t_hash << 10);
+		t_hash ^= (t_hash >> 6);
+	}
+	t_hash += (t_hash << 3);
+	t_hash ^= (t_hash >> 11);
+	t_hash += (t_hash << 15);
+	return t_hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 void MCNameDumpTable(void)
 {
 	FILE *t_output;
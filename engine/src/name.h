@@ -58,6 +58,13 @@ MCNameRef MCNameLookupWithOldString(const MCString& string, MCCompareOptions opt
 bool MCNameInitialize(void);
 void MCNameFinalize(void);
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Compute the one-at-a-time hash of the chars, starting from the given seed.
+// This is the hash used by the engine's hashed caches and indices. If 'options'
+// is kMCCompareCaseless the chars are hashed as if they were lowercase.
+uint32_t MCHashChars(const char *chars, uindex_t char_count, MCCompareOptions options, uint32_t seed);
+
 extern MCNameRef kMCEmptyName;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -270,6 +270,8 @@ MCObject::~MCObject()
 	removefrom(MCbackscripts);
 	MCundos->freeobject(this);
 	delete hlist;
+	MCscriptepoch++;
+	MCcontrolepoch++;
 	MCNameDelete(_name);
 	delete colors;
 	if (colornames != NULL)
@@ -312,18 +314,21 @@ void MCObject::setname(MCNameRef p_new_name)
 {
 	MCNameDelete(_name);
 	/* UNCHECKED */ MCNameClone(p_new_name, _name);
+	MCcontrolepoch++;
 }
 
 void MCObject::setname_cstring(const char *p_new_name)
 {
 	MCNameDelete(_name);
 	/* UNCHECKED */ MCNameCreateWithCString(p_new_name, _name);
+	MCcontrolepoch++;
 }
 
 void MCObject::setname_oldstring(const MCString& p_new_name)
 {
 	MCNameDelete(_name);
 	/* UNCHECKED */ MCNameCreateWithOldString(p_new_name, _name);
+	MCcontrolepoch++;
 }
 
 void MCObject::open()
@@ -331,6 +336,8 @@ void MCObject::open()
 	if (opened++ != 0)
 		return;
 
+	MCscriptepoch++;
+
 	if (obj_id == 0 && parent != nil)
 		obj_id = getstack()->newid();
 
@@ -349,6 +356,8 @@ void MCObject::close()
 	if (opened == 0 || --opened != 0)
 		return;
 
+	MCscriptepoch++;
+
 	if (state & CS_MENU_ATTACHED)
 		closemenu(False, True);
 
@@ -373,6 +382,7 @@ void MCObject::close()
 	{
 		delete hlist;
 		hlist = NULL;
+		MCscriptepoch++;
 	}
 }
 
@@ -1087,6 +1097,76 @@ Exec_stat MCObject::handle(Handler_type htype, MCNameRef mess, MCParameter *para
 	return stat;
 }
 
+bool MCObject::resolveself(Handler_type p_handler_type, MCNameRef p_message, MCHandler*& r_handler)
+{
+	// Objects with parentScripts also have before and after handlers to run,
+	// so are never resolved in advance.
+	if (parent_script != nil)
+		return false;
+
+	parsescript(True);
+
+	r_handler = nil;
+	if (hlist != NULL)
+	{
+		MCHandler *t_handler;
+		if (hlist -> findhandler(p_handler_type, p_message, t_handler) == ES_NORMAL && !t_handler -> isprivate())
+			r_handler = t_handler;
+	}
+
+	return true;
+}
+
+bool MCObject::resolvehandler(Handler_type p_handler_type, MCNameRef p_message, MCObject *p_pass_from, MCObject*& r_owner, MCHandler*& r_handler)
+{
+	if (!resolveself(p_handler_type, p_message, r_handler))
+		return false;
+
+	if (r_handler != nil)
+	{
+		r_owner = this;
+		return true;
+	}
+
+	if (p_pass_from != nil && parent != NULL)
+		return parent -> resolvehandler(p_handler_type, p_message, this, r_owner, r_handler);
+
+	return true;
+}
+
+Exec_stat MCObject::handlecached(MCHandlerPathCache& x_cache, Handler_type p_handler_type, MCNameRef p_message, MCParameter *p_parameters)
+{
+	// The dynamic path depends on the current card, so is never cached.
+	if (MCdynamiccard == NULL)
+	{
+		if (x_cache . object != this || x_cache . epoch != MCscriptepoch)
+		{
+			MCObject *t_owner;
+			MCHandler *t_handler;
+			if (!resolvehandler(p_handler_type, p_message, this, t_owner, t_handler) ||
+				(t_handler != nil && t_handler -> canpass()))
+				t_handler = nil;
+
+			// Resolving may have compiled some scripts, so take the epoch after.
+			x_cache . object = this;
+			x_cache . owner = t_handler != nil ? t_owner : nil;
+			x_cache . handler = t_handler;
+			x_cache . epoch = MCscriptepoch;
+		}
+
+		if (x_cache . handler != nil)
+		{
+			Exec_stat t_stat;
+			t_stat = x_cache . owner -> exechandler(x_cache . handler, p_parameters);
+			if (t_stat == ES_ERROR && MCerrorptr == NULL)
+				MCerrorptr = x_cache . owner;
+			return t_stat;
+		}
+	}
+
+	return handle(p_handler_type, p_message, p_parameters, this);
+}
+
 void MCObject::closemenu(Boolean kfocus, Boolean disarm)
 {
 	if (state & CS_MENU_ATTACHED)
@@ -2166,6 +2246,9 @@ Boolean MCObject::parsescript(Boolean report, Boolean force)
 			
 			getstack() -> unsecurescript(this);
 			
+			// Reparsing replaces all the handlers.
+			MCscriptepoch++;
+
 			Parse_stat t_stat;
 			t_stat = hlist -> parse(this, script);
 			
@@ -2184,6 +2267,7 @@ Boolean MCObject::parsescript(Boolean report, Boolean force)
 				}
 				delete hlist;
 				hlist = NULL;
+				MCscriptepoch++;
 				return False;
 			}
 			else
@@ -2534,6 +2618,7 @@ void MCObject::removefrom(MCObjectList *l)
 			if (optr->getobject() == this)
 			{
 				optr->setremoved(True);
+				MCscriptepoch++;
 				return;
 			}
 			optr = optr->next();
@@ -3439,6 +3524,7 @@ IO_stat MCObject::extendedload(MCObjectInputStream& p_stream, const char *p_vers
 		if (t_stat == IO_NORMAL)
 		{
 			parent_script = MCParentScript::Acquire(this, t_id, t_stack);
+			MCscriptepoch++;
 			if (parent_script == NULL)
 				t_stat = IO_ERROR;
 
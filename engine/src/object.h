@@ -303,6 +303,15 @@ public:
     //   object and should continue to be passed if not handled. If it is nil, then the message should
     //   not be passed on.
 	virtual Exec_stat handle(Handler_type, MCNameRef, MCParameter *, MCObject *pass_from);
+
+	// Work out which handler (and the object containing it) a message handled
+	// by this object would first reach, without executing anything. The
+	// pass_from parameter has the same meaning as for 'handle'. If nothing
+	// would handle the message, r_handler is set to nil. If the path can't be
+	// determined in advance (parentScripts, externals and the like), false is
+	// returned.
+	virtual bool resolvehandler(Handler_type, MCNameRef, MCObject *pass_from, MCObject*& r_owner, MCHandler*& r_handler);
+
 	virtual void closemenu(Boolean kfocus, Boolean disarm);
 	virtual void recompute();
 	
@@ -446,6 +455,7 @@ public:
 	void setparent(MCObject *newparent)
 	{
 		parent = newparent;
+		MCscriptepoch++;
 	}
 	MCCard *getcard(uint4 cid = 0);
 	Window getw();
@@ -573,6 +583,15 @@ public:
 	//   type.
 	Exec_stat handleparent(Handler_type type, MCNameRef message, MCParameter* parameters);
 
+	// Send the given message along the message path from this object, as
+	// 'handle' does, going straight to the handler recorded in the call-site
+	// cache when it is still valid.
+	Exec_stat handlecached(MCHandlerPathCache& x_cache, Handler_type type, MCNameRef message, MCParameter *parameters);
+
+	// Look for a (non-private) handler for the given message in this object's
+	// own script. Returns false if the object has a parentScript.
+	bool resolveself(Handler_type type, MCNameRef message, MCHandler*& r_handler);
+
 	MCBitmap *snapshot(const MCRectangle *rect, const MCPoint *size, bool with_effects);
 
 	// MW-2011-01-14: [[ Bug 9288 ]] Added 'parid' to make sure 'the properties of card id ...' returns
@@ -842,6 +842,7 @@ Exec_stat MCObject::setscriptprop(MCExecPoint& ep)
 	{
 		delete hlist;
 		hlist = NULL;
+		MCscriptepoch++;
 		delete script;
 		script = NULL;
 		flags &= ~F_SCRIPT;
@@ -871,6 +872,7 @@ Exec_stat MCObject::setscriptprop(MCExecPoint& ep)
 			{
 				delete hlist;
 				hlist = NULL;
+				MCscriptepoch++;
 				delete script;
 				script = oldscript;
 				oldscript = NULL;
@@ -912,6 +914,7 @@ Exec_stat MCObject::setparentscriptprop(MCExecPoint& ep)
 		if (parent_script != NULL)
 			parent_script -> Release();
 		parent_script = NULL;
+		MCscriptepoch++;
 		return ES_NORMAL;
 	}
 
@@ -996,6 +999,7 @@ Exec_stat MCObject::setparentscriptprop(MCExecPoint& ep)
 				parent_script -> Release();
 
 			parent_script = t_use;
+			MCscriptepoch++;
 
 			// Finally resolve the parent script as pointing to the object.
 			parent_script -> GetParent() -> Resolve(t_object);
@@ -29,15 +29,19 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "util.h"
 
+// Cards pass messages through the background groups they hold objptrs to,
+// so any change to them changes the message path.
 MCObjptr::MCObjptr()
 {
 	id = 0;
 	parent = NULL;
 	objptr = NULL;
+	MCscriptepoch++;
 }
 
 MCObjptr::~MCObjptr()
 {
+	MCscriptepoch++;
 }
 
 bool MCObjptr::visit(MCVisitStyle p_style, uint32_t p_part, MCObjectVisitor *p_visitor)
@@ -61,6 +65,7 @@ IO_stat MCObjptr::save(IO_handle stream, uint4 p_part)
 void MCObjptr::setparent(MCObject *newparent)
 {
 	parent = newparent;
+	MCscriptepoch++;
 }
 
 MCControl *MCObjptr::getref()
@@ -117,7 +117,7 @@ Boolean MCSocket::sslinited = False;
 #ifdef _MACOSX
 static void socketCallback (CFSocketRef cfsockref, CFSocketCallBackType type, CFDataRef address, const void *pData, void *pInfo)
 {
-	uint2 i;
+	uint4 i;
 	int fd = CFSocketGetNative(cfsockref);
 	for (i = 0 ; i < MCnsockets ; i++)
 	{
@@ -728,7 +728,7 @@ void MCS_write_socket(const MCString &d, MCSocket *s, MCObject *optr, MCNameRef
 		if (mptr != NULL)
 		{
 			MCscreen->delaymessage(optr, mptr, strclone(s->name));
-			s->added = True;
+			s->setadded();
 		}
 	}
 	else
@@ -1042,11 +1042,18 @@ MCSocket::MCSocket(char *n, MCObject *o, MCNameRef m, Boolean d, MCSocketHandle
 	sslstate = SSTATE_NONE; // Not on Mac?
 	secure = issecure;
 	resolve_state = kMCSocketStateNew;
+#ifdef _LINUX
+	pollevents = 0;
+	polldirty = False;
+#endif
 	init(fd);
 }
 
 MCSocket::~MCSocket()
 {
+#ifdef _LINUX
+	MCS_poll_socket_deleted(this);
+#endif
 	delete name;
 	MCNameDelete(message);
 	deletereads();
@@ -1152,14 +1159,13 @@ void MCSocket::acceptone()
 		char *t = inet_ntoa(addr.sin_addr);
 		char *n = new char[strlen(t) + I4L];
 		sprintf(n, "%s:%d", t, newfd);
-		MCU_realloc((char **)&MCsockets, MCnsockets,
-		            MCnsockets + 1, sizeof(MCSocket *));
-		MCsockets[MCnsockets] = new MCSocket(n, object, NULL,
-		                                     False, newfd, False, False,False);
-		MCsockets[MCnsockets]->connected = True;
-		MCsockets[MCnsockets++]->setselect();
+		MCSocket *s = new MCSocket(n, object, NULL,
+		                           False, newfd, False, False,False);
+		s->connected = True;
+		IO_addsocket(s);
+		s->setselect();
 		MCscreen->delaymessage(object, message, strclone(n), strclone(name));
-		added = True;
+		setadded();
 	}
 }
 #endif
@@ -1209,14 +1215,10 @@ void MCSocket::readsome()
 				char *t = inet_ntoa(addr.sin_addr);
 				char *n = new char[strlen(t) + U2L];
 				sprintf(n, "%s:%d", t, MCSwapInt16NetworkToHost(addr.sin_port));
-				uint2 index;
+				uint4 index;
 				if (accepting && !IO_findsocket(n, index))
-				{
-					MCU_realloc((char **)&MCsockets, MCnsockets,
-					            MCnsockets + 1, sizeof(MCSocket *));
-					MCsockets[MCnsockets++] = new MCSocket(strclone(n), object, NULL,
-					                                       True, fd, False, True,False);
-				}
+					IO_addsocket(new MCSocket(strclone(n), object, NULL,
+					                          True, fd, False, True,False));
 				MCParameter *params = new MCParameter;
 				params->setbuffer(n, strlen(n));
 				params->setnext(new MCParameter);
@@ -1226,7 +1228,7 @@ void MCSocket::readsome()
 				MCscreen->addmessage(object, message, curtime, params);
 			}
 		}
-		added = True;
+		setadded();
 		doread = False;
 	}
 	else
@@ -1235,7 +1237,7 @@ void MCSocket::readsome()
 		{
 #ifdef _WINDOWS
 			acceptone();
-			added = True;
+			setadded();
 #else
 
 			int newfd = accept(fd, (struct sockaddr *)&addr, &addrsize);
@@ -1246,16 +1248,15 @@ void MCSocket::readsome()
 				char *t = inet_ntoa(addr.sin_addr);
 				char *n = new char[strlen(t) + U2L];
 				sprintf(n, "%s:%d", t, MCSwapInt16NetworkToHost(addr.sin_port));
-				MCU_realloc((char **)&MCsockets, MCnsockets,
-							MCnsockets + 1, sizeof(MCSocket *));
-				MCsockets[MCnsockets] = new MCSocket(n, object, NULL,
-													 False, newfd, False, False,secure);
-				MCsockets[MCnsockets]->connected = True;
+				MCSocket *s = new MCSocket(n, object, NULL,
+				                           False, newfd, False, False,secure);
+				s->connected = True;
 				if (secure)
-					MCsockets[MCnsockets]->sslaccept();
-				MCsockets[MCnsockets++]->setselect();
+					s->sslaccept();
+				IO_addsocket(s);
+				s->setselect();
 				MCscreen->delaymessage(object, message, strclone(n), strclone(name));
-				added = True;
+				setadded();
 			}
 #endif
 
@@ -1364,7 +1365,7 @@ void MCSocket::processreadqueue()
 				delete e;
 				if (nread == 0 && fd == 0)
 					MCscreen->delaymessage(object, MCM_socket_closed, strclone(name));
-				added = True;
+				setadded();
 			}
 			else
 				break;
@@ -1381,7 +1382,7 @@ void MCSocket::writesome()
 	{
 #endif
 		MCscreen->delaymessage(object, message, strclone(name));
-		added = True;
+		setadded();
 		MCNameDelete(message);
 		message = NULL;
 	}
@@ -1423,7 +1424,7 @@ void MCSocket::writesome()
 				MCSocketwrite *e = wevents->remove
 				                   (wevents);
 				MCscreen->delaymessage(e->optr, e->message, strclone(name));
-				added = True;
+				setadded();
 				delete e;
 			}
 			else
@@ -1451,18 +1452,28 @@ void MCSocket::doclose()
 		if (error != NULL)
 		{
 			MCscreen->delaymessage(object, MCM_socket_error, strclone(name), error);
-			added = True;
+			setadded();
 		}
 		else
 			if (nread == 0)
 			{
 				MCscreen->delaymessage(object, MCM_socket_closed, strclone(name));
-				added = True;
+				setadded();
 			}
 	}
 }
 
 
+// Note that a message has been queued for the socket, so the next poll
+// shouldn't wait.
+void MCSocket::setadded()
+{
+	added = True;
+#ifdef _LINUX
+	MCS_poll_socket_changed(this);
+#endif
+}
+
 void MCSocket::setselect()
 {
 	uint2 bioselectstate = 0;
@@ -1484,6 +1495,11 @@ void MCSocket::setselect()
 
 void MCSocket::setselect(uint2 sflags)
 {
+#ifdef _LINUX
+	// The poll backend works out which events to wait for from the socket's
+	// state, so just note that it may have changed.
+	MCS_poll_socket_changed(this);
+#endif
 #ifdef _WINDOWS
 	if (!MCnoui)
 	{
@@ -1541,6 +1557,9 @@ void MCSocket::close()
 			rlref = NULL;
 		}
 #endif
+#ifdef _LINUX
+		MCS_poll_socket_closed(this);
+#endif
 #ifdef _WINDOWS
 		closesocket(fd);
 #else
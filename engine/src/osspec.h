@@ -246,6 +246,9 @@ const char *MCS_get_session_name(void);
 bool MCS_set_session_id(const char *p_id);
 const char *MCS_get_session_id(void);
 
+// Fetch the server's parsed script cache counters (see MCServerScript).
+void MCS_get_script_cache_stats(uint32_t& r_hits, uint32_t& r_misses, uint32_t& r_invalidations);
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #endif
@@ -1840,7 +1840,7 @@ Boolean MCS_poll(real8 delay, int fd)
 			maxfd = MCshellfd;
 	}
 
-	uint2 i;
+	uint4 i;
 	for (i = 0 ; i < MCnsockets ; i++)
 	{
 		int fd = MCsockets[i]->fd;
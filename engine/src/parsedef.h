@@ -22,11 +22,9 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 // for regex
 #define PATTERN_CACHE_SIZE 20
-extern char *MCregexpatterns[];
 
 #define NSUBEXP  50
 typedef struct _regexp regexp;
-extern regexp *MCregexcache[];
 
 typedef struct _constant
 {
@@ -344,6 +342,11 @@ enum File_unit {
 	FU_KEY
 };
 
+enum Filter_pattern {
+	FP_WILDCARD,
+	FP_REGEX
+};
+
 enum Find_mode {
     FM_UNDEFINED,
     FM_NORMAL,
@@ -1090,6 +1093,12 @@ enum Properties {
 	/* 2013-01-07-IM global property to control image cache limit */
 	P_IMAGE_CACHE_LIMIT,
 	P_IMAGE_CACHE_USAGE,
+	P_IMAGE_CACHE_STATS,
+	P_REGEX_CACHE_SIZE,
+	P_REGEX_CACHE_STATS,
+	P_DO_CACHE_SIZE,
+	P_DO_CACHE_STATS,
+	P_SCRIPT_CACHE_STATS,
 	
     // read only globals
     P_ADDRESS,
@@ -1739,6 +1748,9 @@ enum Sugar_constants {
 	SG_OPEN,
 	SG_CLOSED,
 	SG_CALLER,
+	SG_PATTERN,
+	SG_REGEX,
+	SG_WILDCARD,
 };
 
 enum Statements {
@@ -2064,6 +2076,19 @@ enum Server_keywords
 	SK_HTTPONLY,
 };
 
+// The handler a message sent to 'object' was last found to reach, together
+// with the object whose script contains it. Command and function call sites
+// keep one of these so that repeated calls can skip the message path. It is
+// only valid while 'epoch' matches MCscriptepoch, and a nil handler means the
+// path could not be resolved in advance.
+struct MCHandlerPathCache
+{
+	MCObject *object;
+	MCObject *owner;
+	MCHandler *handler;
+	uint4 epoch;
+};
+
 #include "parseerrors.h"
 #include "executionerrors.h"
 
@@ -521,6 +521,12 @@ Parse_stat MCProperty::parse(MCScriptPoint &sp, Boolean the)
 			
 	case P_IMAGE_CACHE_LIMIT:
 	case P_IMAGE_CACHE_USAGE:
+	case P_IMAGE_CACHE_STATS:
+	case P_REGEX_CACHE_SIZE:
+	case P_REGEX_CACHE_STATS:
+	case P_DO_CACHE_SIZE:
+	case P_DO_CACHE_STATS:
+	case P_SCRIPT_CACHE_STATS:
 	case P_REV_PROPERTY_LISTENER_THROTTLE_TIME: // DEVELOPMENT only
 		break;
 
@@ -2334,6 +2340,24 @@ Exec_stat MCProperty::set(MCExecPoint &ep)
 		MCCachedImageRep::SetCacheLimit(t_cache_limit);
 	}
 	break;
+
+	case P_REGEX_CACHE_SIZE:
+	{
+		uint32_t t_cache_size;
+		if (ep.getuint4(t_cache_size, line, pos, EE_PROPERTY_NAN) != ES_NORMAL)
+			return ES_ERROR;
+		MCR_setcachesize(t_cache_size);
+	}
+	break;
+
+	case P_DO_CACHE_SIZE:
+	{
+		uint32_t t_cache_size;
+		if (ep.getuint4(t_cache_size, line, pos, EE_PROPERTY_NAN) != ES_NORMAL)
+			return ES_ERROR;
+		MCHandlerSetFragmentCacheSize(t_cache_size);
+	}
+	break;
 	
 	
 	case P_ALLOW_DATAGRAM_BROADCASTS:
@@ -3811,6 +3835,52 @@ Exec_stat MCProperty::eval(MCExecPoint &ep)
 	case P_IMAGE_CACHE_USAGE:
 		ep.setuint(MCCachedImageRep::GetCacheUsage());
 		break;
+
+	case P_IMAGE_CACHE_STATS:
+	{
+		uint32_t t_hits, t_misses, t_evictions;
+		MCCachedImageRep::GetCacheStats(t_hits, t_misses, t_evictions);
+		ep.setuint(t_hits);
+		ep.concatuint(t_misses, EC_COMMA, false);
+		ep.concatuint(t_evictions, EC_COMMA, false);
+	}
+		break;
+
+	case P_REGEX_CACHE_SIZE:
+		ep.setuint(MCR_getcachesize());
+		break;
+
+	case P_REGEX_CACHE_STATS:
+	{
+		uint4 t_hits, t_misses;
+		MCR_getcachestats(t_hits, t_misses);
+		ep.setuint(t_hits);
+		ep.concatuint(t_misses, EC_COMMA, false);
+	}
+		break;
+
+	case P_DO_CACHE_SIZE:
+		ep.setuint(MCHandlerGetFragmentCacheSize());
+		break;
+
+	case P_DO_CACHE_STATS:
+	{
+		uint4 t_hits, t_misses;
+		MCHandlerGetFragmentCacheStats(t_hits, t_misses);
+		ep.setuint(t_hits);
+		ep.concatuint(t_misses, EC_COMMA, false);
+	}
+		break;
+
+	case P_SCRIPT_CACHE_STATS:
+	{
+		uint32_t t_hits, t_misses, t_invalidations;
+		MCS_get_script_cache_stats(t_hits, t_misses, t_invalidations);
+		ep.setuint(t_hits);
+		ep.concatuint(t_misses, EC_COMMA, false);
+		ep.concatuint(t_invalidations, EC_COMMA, false);
+	}
+		break;
 			
 	case P_BRUSH_BACK_COLOR:
 	case P_PEN_BACK_COLOR:
@@ -19,6 +19,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "globdefs.h"
 #include "parsedef.h"
 #include "regex.h"
+#include "util.h"
 
 #include <pcre.h>
 
@@ -184,6 +185,12 @@ regerror(int errcode, const regex_t *preg, char *errbuf, size_t errbuf_size)
 
 void regfree(regex_t *preg)
 {
+	if (preg->re_extra != NULL)
+#ifdef PCRE_STUDY_JIT_COMPILE
+		pcre_free_study((pcre_extra *)preg->re_extra);
+#else
+		(pcre_free)(preg->re_extra);
+#endif
 	(pcre_free)(preg->re_pcre);
 }
 
@@ -212,11 +219,22 @@ int regcomp(regex_t *preg, const char *pattern, int cflags)
 	if ((cflags & REG_NEWLINE) != 0)
 		options |= PCRE_MULTILINE;
 	preg->re_pcre = pcre_compile(pattern, options, &errorptr, &erroffset, NULL);
+	preg->re_extra = NULL;
 	preg->re_erroffset = erroffset;
 
 	if (preg->re_pcre == NULL)
 		return eint[erroffset];
 
+	// Study the pattern so that matching is quicker and, where the PCRE library
+	// supports it, compile it to native code. If studying fails (or finds
+	// nothing useful) we just match without it.
+	const char *t_study_error;
+#ifdef PCRE_STUDY_JIT_COMPILE
+	preg->re_extra = pcre_study((const pcre *)preg->re_pcre, PCRE_STUDY_JIT_COMPILE, &t_study_error);
+#else
+	preg->re_extra = pcre_study((const pcre *)preg->re_pcre, 0, &t_study_error);
+#endif
+
 	preg->re_nsub = pcre_info((const pcre *)preg->re_pcre, NULL, NULL);
 	return 0;
 }
@@ -237,20 +255,26 @@ int regexec(regex_t *preg, const char *string, int len, size_t nmatch,
 	int options = 0;
 	int *ovector = NULL;
 
+	// Matches are almost always done with NSUBEXP slots, so use space on the
+	// stack for them when we can.
+	int t_ovector[NSUBEXP * 3];
+
 	if ((eflags & REG_NOTBOL) != 0)
 		options |= PCRE_NOTBOL;
 	if ((eflags & REG_NOTEOL) != 0)
 		options |= PCRE_NOTEOL;
 
 	preg->re_erroffset = (size_t)(-1);   /* Only has meaning after compile */
-	if (nmatch > 0)
+	if (nmatch > NSUBEXP)
 	{
 		ovector = (int *)malloc(sizeof(int) * nmatch * 3);
 		if (ovector == NULL)
 			return REG_ESPACE;
 	}
+	else if (nmatch > 0)
+		ovector = t_ovector;
 
-	rc = pcre_exec((const pcre *)preg->re_pcre, NULL, string, len, 0, options,
+	rc = pcre_exec((const pcre *)preg->re_pcre, (const pcre_extra *)preg->re_extra, string, len, 0, options,
 	               ovector, nmatch * 3);
 
 	if (rc == 0)
@@ -264,7 +288,7 @@ int regexec(regex_t *preg, const char *string, int len, size_t nmatch,
 			pmatch[i].rm_so = ovector[i*2];
 			pmatch[i].rm_eo = ovector[i*2+1];
 		}
-		if (ovector != NULL)
+		if (ovector != NULL && ovector != t_ovector)
 			free(ovector);
 		for (; i < (int)nmatch; i++)
 			pmatch[i].rm_so = pmatch[i].rm_eo = -1;
@@ -272,7 +296,7 @@ int regexec(regex_t *preg, const char *string, int len, size_t nmatch,
 	}
 	else
 	{
-		if (ovector != NULL)
+		if (ovector != NULL && ovector != t_ovector)
 			free(ovector);
 		switch(rc)
 		{
@@ -301,11 +325,13 @@ const char *MCR_geterror()
 	return regexperror;
 }
 
-regexp *MCR_compile(char *exp)
+regexp *MCR_compile(const char *exp, uint4 p_flags)
 {
 	regexp *re = new regexp;
 	int status;
 	int flags = REG_EXTENDED;
+	if ((p_flags & MCR_CASELESS) != 0)
+		flags |= REG_ICASE;
 	status = regcomp(&re->rexp, exp, flags);
 	if (status != REG_OKAY)
 	{
@@ -341,3 +367,118 @@ void MCR_free(regexp *prog)
 		delete prog;
 	}
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The compiled pattern cache is an MCLRUCache keyed on the pattern text and
+// compile flags. When the cache is full the least recently used entry is
+// discarded.
+
+struct MCRegexCacheEntry: public MCLRUCacheEntry
+{
+	char *pattern;
+	uint4 length;
+	uint4 flags;
+	regexp *compiled;
+};
+
+static MCLRUCache s_regex_cache;
+static uint4 s_regex_capacity = PATTERN_CACHE_SIZE;
+static uint4 s_regex_hits = 0;
+static uint4 s_regex_misses = 0;
+
+static void MCR_discard(MCRegexCacheEntry *p_entry)
+{
+	MCLRUCacheRemove(s_regex_cache, p_entry);
+
+	delete[] p_entry -> pattern;
+	MCR_free(p_entry -> compiled);
+	delete p_entry;
+}
+
+static void MCR_trimcache(uint4 p_count)
+{
+	while(s_regex_cache . count > p_count)
+		MCR_discard(static_cast<MCRegexCacheEntry *>(s_regex_cache . last_used));
+}
+
+regexp *MCR_compilecached(const char *p_pattern, uint4 p_length, uint4 p_flags)
+{
+	uint4 t_hash;
+	t_hash = MCHashChars(p_pattern, p_length, kMCCompareExact, p_flags);
+
+	for(MCLRUCacheEntry *t_link = MCLRUCacheGetBucket(s_regex_cache, t_hash); t_link != NULL; t_link = t_link -> next_in_bucket)
+	{
+		MCRegexCacheEntry *t_entry;
+		t_entry = static_cast<MCRegexCacheEntry *>(t_link);
+		if (t_entry -> hash == t_hash && t_entry -> flags == p_flags &&
+			t_entry -> length == p_length && memcmp(t_entry -> pattern, p_pattern, p_length) == 0)
+		{
+			s_regex_hits++;
+			MCLRUCacheTouch(s_regex_cache, t_entry);
+			return t_entry -> compiled;
+		}
+	}
+
+	s_regex_misses++;
+
+	char *t_pattern;
+	t_pattern = new char[p_length + 1];
+	memcpy(t_pattern, p_pattern, p_length);
+	t_pattern[p_length] = '\0';
+
+	regexp *t_compiled;
+	t_compiled = MCR_compile(t_pattern, p_flags);
+	if (t_compiled == NULL)
+	{
+		delete[] t_pattern;
+		return NULL;
+	}
+
+	// Make room for the new entry.
+	MCR_trimcache(s_regex_capacity - 1);
+
+	MCRegexCacheEntry *t_entry;
+	t_entry = new MCRegexCacheEntry;
+	t_entry -> pattern = t_pattern;
+	t_entry -> length = p_length;
+	t_entry -> flags = p_flags;
+	t_entry -> hash = t_hash;
+	t_entry -> compiled = t_compiled;
+	MCLRUCacheInsert(s_regex_cache, t_entry);
+
+	return t_compiled;
+}
+
+void MCR_initcache(void)
+{
+	MCLRUCacheInitialize(s_regex_cache);
+	s_regex_capacity = PATTERN_CACHE_SIZE;
+	s_regex_hits = 0;
+	s_regex_misses = 0;
+}
+
+void MCR_freecache(void)
+{
+	MCR_trimcache(0);
+	MCLRUCacheFinalize(s_regex_cache);
+}
+
+uint4 MCR_getcachesize(void)
+{
+	return s_regex_capacity;
+}
+
+void MCR_setcachesize(uint4 p_size)
+{
+	// The cache must always be able to hold the pattern most recently asked
+	// for, as it owns it.
+	s_regex_capacity = p_size > 1 ? p_size : 1;
+	MCR_trimcache(s_regex_capacity);
+}
+
+void MCR_getcachestats(uint4& r_hits, uint4& r_misses)
+{
+	r_hits = s_regex_hits;
+	r_misses = s_regex_misses;
+}
@@ -24,12 +24,15 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #define REG_OKAY 0
 
 #define PATTERN_CACHE_SIZE 20
-extern char *MCregexpatterns[];
+
+// Flags which affect how a pattern is compiled.
+#define MCR_CASELESS 0x01
 
 //regex structure
 typedef struct
 {
 	void *re_pcre;
+	void *re_extra;
 	size_t re_nsub;
 	size_t re_erroffset;
 }
@@ -57,9 +60,23 @@ typedef struct _regexp
 regexp;
 
 const char *MCR_geterror();
-regexp *MCR_compile(char *exp);
+regexp *MCR_compile(const char *exp, uint4 flags = 0);
 int MCR_exec(regexp *prog, const char *string, uint4 len);
 void MCR_free(regexp *prog);
 
-extern regexp *MCregexcache[];
+// Return the compiled form of the given pattern, compiling it if it is not
+// already in the cache. The compiled pattern remains owned by the cache, and
+// is only valid until the next call to MCR_compilecached (as it may then be
+// discarded). Returns nil if the pattern fails to compile.
+regexp *MCR_compilecached(const char *exp, uint4 length, uint4 flags = 0);
+
+void MCR_initcache(void);
+void MCR_freecache(void);
+
+// The number of compiled patterns kept by the cache - the least recently used
+// patterns are discarded to stay within it.
+uint4 MCR_getcachesize(void);
+void MCR_setcachesize(uint4 size);
+void MCR_getcachestats(uint4& r_hits, uint4& r_misses);
+
 #endif
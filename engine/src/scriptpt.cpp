@@ -51,6 +51,222 @@ extern const uint4 command_table_size;
 extern LT factor_table[];
 extern const uint4 factor_table_size;
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Keyword tables are searched through perfect hash indexes, built from the
+// (sorted) tables the first time each is used. The hash of the lowered token
+// is computed as the token is scanned. It picks a bucket, whose displacement
+// then selects the single slot the token can be in - so a lookup is one string
+// comparison. The displacements are found by placing the largest buckets
+// first, trying successive values until all the bucket's keys land in free
+// slots. Should that fail, the table is binary searched as before.
+
+#define KEYWORD_HASH_INIT 2166136261U
+#define KEYWORD_HASH_STEP(h, c) (((h) ^ (c)) * 16777619U)
+#define KEYWORD_MAX_DISPLACEMENT 65535
+
+struct MCKeywordIndex
+{
+	bool initialized;
+	uint2 *displacements;
+	uint2 *slots;
+	uint4 bucket_mask;
+	uint4 slot_mask;
+};
+
+static MCKeywordIndex s_keyword_indexes[SP_SERVER + 1];
+static MCKeywordIndex s_constant_index;
+
+static inline uint4 MCKeywordIndexSlot(uint4 p_hash, uint4 p_displacement, uint4 p_slot_mask)
+{
+	uint4 t_mixed;
+	t_mixed = p_hash ^ (p_hash >> 16);
+	t_mixed *= 0x85EBCA6BU;
+	t_mixed ^= t_mixed >> 13;
+
+	uint4 t_step;
+	t_step = ((t_mixed * 0xC2B2AE35U) ^ (t_mixed >> 16)) | 1;
+
+	return (t_mixed + p_displacement * t_step) & p_slot_mask;
+}
+
+// The tables are arrays of structures starting with the token, so they are
+// accessed generically through the size of their elements.
+static inline const char *MCKeywordTableToken(const void *p_table, uint4 p_stride, uint4 p_index)
+{
+	return *(const char * const *)((const char *)p_table + p_index * p_stride);
+}
+
+static int4 MCKeywordTableSearch(const void *p_table, uint4 p_stride, uint4 p_count, const char *p_token)
+{
+	uint4 t_low, t_high;
+	t_low = 0;
+	t_high = p_count;
+	while (t_low < t_high)
+	{
+		uint4 t_mid;
+		t_mid = t_low + ((t_high - t_low) >> 1);
+
+		int4 t_cond;
+		t_cond = strcmp(p_token, MCKeywordTableToken(p_table, p_stride, t_mid));
+		if (t_cond < 0)
+			t_high = t_mid;
+		else if (t_cond > 0)
+			t_low = t_mid + 1;
+		else
+			return t_mid;
+	}
+	return -1;
+}
+
+static uint4 MCKeywordHash(const char *p_token)
+{
+	uint4 t_hash;
+	t_hash = KEYWORD_HASH_INIT;
+	while (*p_token != '\0')
+		t_hash = KEYWORD_HASH_STEP(t_hash, (uint1)*p_token++);
+	return t_hash;
+}
+
+static bool MCKeywordIndexBuild(MCKeywordIndex& x_index, const void *p_table, uint4 p_stride, uint4 p_count)
+{
+	// Only index the entries a binary search finds, so that tables with
+	// duplicate (or misplaced) tokens match exactly as they did before.
+	uint4 *t_keys;
+	t_keys = new uint4[p_count + 1];
+	uint4 t_key_count;
+	t_key_count = 0;
+	for (uint4 i = 0; i < p_count; i++)
+		if (MCKeywordTableSearch(p_table, p_stride, p_count, MCKeywordTableToken(p_table, p_stride, i)) == (int4)i)
+			t_keys[t_key_count++] = i;
+
+	uint4 t_slot_count;
+	t_slot_count = 2;
+	while (t_slot_count < t_key_count * 2)
+		t_slot_count *= 2;
+
+	uint4 t_bucket_count;
+	t_bucket_count = t_slot_count / 4 > 0 ? t_slot_count / 4 : 1;
+
+	uint4 *t_hashes;
+	t_hashes = new uint4[t_key_count + 1];
+	uint4 *t_bucket_sizes;
+	t_bucket_sizes = new uint4[t_bucket_count];
+	memset(t_bucket_sizes, 0, sizeof(uint4) * t_bucket_count);
+	uint4 t_largest_bucket;
+	t_largest_bucket = 0;
+	for (uint4 i = 0; i < t_key_count; i++)
+	{
+		t_hashes[i] = MCKeywordHash(MCKeywordTableToken(p_table, p_stride, t_keys[i]));
+		uint4 t_bucket;
+		t_bucket = t_hashes[i] & (t_bucket_count - 1);
+		t_bucket_sizes[t_bucket]++;
+		if (t_bucket_sizes[t_bucket] > t_largest_bucket)
+			t_largest_bucket = t_bucket_sizes[t_bucket];
+	}
+
+	uint2 *t_displacements;
+	t_displacements = new uint2[t_bucket_count];
+	memset(t_displacements, 0, sizeof(uint2) * t_bucket_count);
+	uint2 *t_slots;
+	t_slots = new uint2[t_slot_count];
+	memset(t_slots, 0, sizeof(uint2) * t_slot_count);
+
+	uint4 *t_bucket_keys;
+	t_bucket_keys = new uint4[t_largest_bucket + 1];
+	uint4 *t_bucket_slots;
+	t_bucket_slots = new uint4[t_largest_bucket + 1];
+
+	bool t_success;
+	t_success = true;
+	for (uint4 t_size = t_largest_bucket; t_success && t_size > 0; t_size--)
+		for (uint4 b = 0; t_success && b < t_bucket_count; b++)
+		{
+			if (t_bucket_sizes[b] != t_size)
+				continue;
+
+			uint4 t_bucket_key_count;
+			t_bucket_key_count = 0;
+			for (uint4 i = 0; i < t_key_count; i++)
+				if ((t_hashes[i] & (t_bucket_count - 1)) == b)
+					t_bucket_keys[t_bucket_key_count++] = i;
+
+			uint4 d;
+			for (d = 0; d <= KEYWORD_MAX_DISPLACEMENT; d++)
+			{
+				uint4 k;
+				for (k = 0; k < t_bucket_key_count; k++)
+				{
+					t_bucket_slots[k] = MCKeywordIndexSlot(t_hashes[t_bucket_keys[k]], d, t_slot_count - 1);
+					if (t_slots[t_bucket_slots[k]] != 0)
+						break;
+
+					uint4 j;
+					for (j = 0; j < k; j++)
+						if (t_bucket_slots[j] == t_bucket_slots[k])
+							break;
+					if (j < k)
+						break;
+				}
+
+				if (k == t_bucket_key_count)
+					break;
+			}
+
+			if (d > KEYWORD_MAX_DISPLACEMENT)
+			{
+				t_success = false;
+				break;
+			}
+
+			t_displacements[b] = d;
+			for (uint4 k = 0; k < t_bucket_key_count; k++)
+				t_slots[t_bucket_slots[k]] = t_keys[t_bucket_keys[k]] + 1;
+		}
+
+	delete[] t_bucket_slots;
+	delete[] t_bucket_keys;
+	delete[] t_bucket_sizes;
+	delete[] t_hashes;
+	delete[] t_keys;
+
+	x_index . initialized = true;
+
+	if (!t_success)
+	{
+		delete[] t_slots;
+		delete[] t_displacements;
+		return false;
+	}
+
+	x_index . displacements = t_displacements;
+	x_index . slots = t_slots;
+	x_index . bucket_mask = t_bucket_count - 1;
+	x_index . slot_mask = t_slot_count - 1;
+
+	return true;
+}
+
+// Returns the index of the entry in the table whose token is the given lowered
+// token, or -1 if there is none.
+static int4 MCKeywordIndexLookup(MCKeywordIndex& x_index, const void *p_table, uint4 p_stride, uint4 p_count, const char *p_token, uint4 p_hash)
+{
+	if (!x_index . initialized)
+		MCKeywordIndexBuild(x_index, p_table, p_stride, p_count);
+
+	if (x_index . slots == NULL)
+		return MCKeywordTableSearch(p_table, p_stride, p_count, p_token);
+
+	uint4 t_entry;
+	t_entry = x_index . slots[MCKeywordIndexSlot(p_hash, x_index . displacements[p_hash & x_index . bucket_mask], x_index . slot_mask)];
+	if (t_entry == 0 || strcmp(p_token, MCKeywordTableToken(p_table, p_stride, t_entry - 1)) != 0)
+		return -1;
+
+	return t_entry - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 MCScriptPoint::MCScriptPoint(MCObject *o, MCHandlerlist *hl, const char *s)
 {
 	script = NULL;
@@ -60,6 +276,7 @@ MCScriptPoint::MCScriptPoint(MCObject *o, MCHandlerlist *hl, const char *s)
 	curptr = tokenptr = backupptr = (const uint1 *)s;
 	lowered = NULL;
 	loweredsize = 0;
+	loweredhash = KEYWORD_HASH_INIT;
 	line = pos = 1;
 	escapes = False;
 	tagged = False;
@@ -80,6 +297,7 @@ MCScriptPoint::MCScriptPoint(MCScriptPoint &sp)
 	token = sp.token;
 	lowered = NULL;
 	loweredsize = 0;
+	loweredhash = KEYWORD_HASH_INIT;
 	line = sp.line;
 	pos = sp.pos;
 	escapes = sp.escapes;
@@ -98,6 +316,7 @@ MCScriptPoint::MCScriptPoint(MCExecPoint &ep)
 	curptr = tokenptr = backupptr = (uint1 *)script;
 	lowered = NULL;
 	loweredsize = 0;
+	loweredhash = KEYWORD_HASH_INIT;
 	line = pos = 0;
 	escapes = False;
 	tagged = False;
@@ -115,6 +334,7 @@ MCScriptPoint::MCScriptPoint(const MCString &s)
 	curptr = tokenptr = backupptr = (uint1 *)script;
 	lowered = NULL;
 	loweredsize = 0;
+	loweredhash = KEYWORD_HASH_INIT;
 	line = pos = 0;
 	escapes = False;
 	tagged = False;
@@ -488,6 +708,7 @@ Parse_stat MCScriptPoint::next(Symbol_type &type)
 		loweredsize = LOWERED_PAD;
 	}
 	char *lptr = lowered;
+	uint4 t_hash = KEYWORD_HASH_INIT;
 	switch (type)
 	{
 	case ST_ID:
@@ -497,30 +718,46 @@ Parse_stat MCScriptPoint::next(Symbol_type &type)
 			*lptr++ = '$';
 			*lptr++ = '#';
 			*lptr = '\0';
+			t_hash = KEYWORD_HASH_STEP(t_hash, '$');
+			t_hash = KEYWORD_HASH_STEP(t_hash, '#');
+			loweredhash = t_hash;
 		}
 		else
 		{
+			// Find the end of the identifier first, so that there need only
+			// be one check for space in the lowered buffer.
+			const uint1 *t_end = curptr;
 			while (True)
 			{
-				Symbol_type newtype = type_table[*curptr];
-				// MW-2010-09-08: [[Bug 8946]] Crash caused by appending a NUL byte when there is no space for it.
-				if (lptr - lowered == loweredsize)
-				{
-					MCU_realloc((char **)&lowered, loweredsize, loweredsize + LOWERED_PAD, sizeof(uint1));
-					lptr = lowered + loweredsize;
-					loweredsize += LOWERED_PAD;
-				}
+				Symbol_type newtype = type_table[*t_end];
 				if (newtype != ST_ID && newtype != ST_NUM)
 				{
 					// Anything other than TAG or TAG> causes the token to finish.
-					if (newtype != ST_TAG || (tagged && curptr[1] == '>'))
-					{
-						*lptr = '\0';
+					if (newtype != ST_TAG || (tagged && t_end[1] == '>'))
 						break;
-					}
 				}
-				*lptr++ = MCS_tolower(*curptr++);
+				t_end++;
 			}
+
+			// MW-2010-09-08: [[Bug 8946]] Crash caused by appending a NUL byte when there is no space for it.
+			if (t_end - curptr >= loweredsize)
+			{
+				uint2 t_new_size = loweredsize;
+				while (t_end - curptr >= t_new_size)
+					t_new_size += LOWERED_PAD;
+				MCU_realloc((char **)&lowered, loweredsize, t_new_size, sizeof(uint1));
+				lptr = lowered;
+				loweredsize = t_new_size;
+			}
+
+			while (curptr < t_end)
+			{
+				uint1 t_char = MCS_tolower(*curptr++);
+				*lptr++ = t_char;
+				t_hash = KEYWORD_HASH_STEP(t_hash, t_char);
+			}
+			*lptr = '\0';
+			loweredhash = t_hash;
 		}
 		break;
 	case ST_LIT:
@@ -550,6 +787,7 @@ Parse_stat MCScriptPoint::next(Symbol_type &type)
 			if (newtype != type)
 			{
 				*lptr = '\0';
+				loweredhash = t_hash;
 				break;
 			}
 			if (lptr - lowered == loweredsize)
@@ -559,6 +797,7 @@ Parse_stat MCScriptPoint::next(Symbol_type &type)
 				lptr = lowered + loweredsize;
 				loweredsize += LOWERED_PAD;
 			}
+			t_hash = KEYWORD_HASH_STEP(t_hash, *curptr);
 			*lptr++ = *curptr++;
 		}
 		break;
@@ -582,6 +821,7 @@ Parse_stat MCScriptPoint::next(Symbol_type &type)
 		}
 		break;
 	default:
+		loweredhash = KEYWORD_HASH_STEP(t_hash, *curptr);
 		*lptr++ = *curptr++;
 		*lptr = '\0';
 		break;
@@ -614,23 +854,12 @@ Parse_stat MCScriptPoint::lookup(Script_point t, const LT *&dlt)
 	if (token.getlength())
 	{
 		const LT *table = table_pointers[t];
-		uint2 high = table_sizes[t];
-		uint2 low = 0;
-		int4 cond;
-
-		while (low < high)
+		int4 t_entry;
+		t_entry = MCKeywordIndexLookup(s_keyword_indexes[t], table, sizeof(LT), table_sizes[t], lowered, loweredhash);
+		if (t_entry >= 0)
 		{
-			uint2 mid = low + ((high - low) >> 1);
-			if ((cond = strcmp(lowered, table[mid].token)) < 0)
-				high = mid;
-			else
-				if (cond > 0)
-					low = mid + 1;
-				else
-				{
-					dlt = &table[mid];
-					return PS_NORMAL;
-				}
+			dlt = &table[t_entry];
+			return PS_NORMAL;
 		}
 	}
 	return PS_NO_MATCH;
@@ -641,29 +870,19 @@ Parse_stat MCScriptPoint::lookupconstant(MCExpression **dest)
 	if (gethandler() != NULL
 	        && gethandler()->findconstant(gettoken_nameref(), dest) == PS_NORMAL)
 		return PS_NORMAL;
-	uint2 high = constant_table_size;
-	uint2 low = 0;
-	int4 cond;
-	while (low < high)
+	int4 t_entry;
+	t_entry = MCKeywordIndexLookup(s_constant_index, constant_table, sizeof(Cvalue), constant_table_size, lowered, loweredhash);
+	if (t_entry >= 0)
 	{
-		uint2 mid = low + ((high - low) >> 1);
-		if ((cond = strcmp(lowered, constant_table[mid].token)) < 0)
-			high = mid;
+		if (strequal(lowered, "null"))
+		{
+			MCString s("", 1);
+			*dest = new MCConstant(s, BAD_NUMERIC);
+		}
 		else
-			if (cond > 0)
-				low = mid + 1;
-			else
-			{
-				if (strequal(lowered, "null"))
-				{
-					MCString s("", 1);
-					*dest = new MCConstant(s, BAD_NUMERIC);
-				}
-				else
-					*dest = new MCConstant(constant_table[mid].svalue,
-					                       constant_table[mid].nvalue);
-				return PS_NORMAL;
-			}
+			*dest = new MCConstant(constant_table[t_entry].svalue,
+			                       constant_table[t_entry].nvalue);
+		return PS_NORMAL;
 	}
 	return PS_NO_MATCH;
 }
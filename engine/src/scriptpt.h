@@ -48,6 +48,8 @@ class MCScriptPoint
 	MCString token;
 	MCNameRef token_nameref;
 	uint2 loweredsize;
+	// The hash of 'lowered', used to look it up in the keyword tables.
+	uint4 loweredhash;
 	uint2 line;
 	uint2 pos;
 	Boolean escapes;
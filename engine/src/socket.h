@@ -132,9 +132,14 @@ public:
 	char *error;
 	real8 timeout;
 	MCSocketHandle fd;
+	// The socket's position in MCsockets, and its link in the name index.
+	uint4 index;
+	uint4 namehash;
+	MCSocket *namenext;
 	MCSocket(char *n, MCObject *o, MCNameRef m, Boolean d, MCSocketHandle sock, Boolean a, Boolean s, Boolean issecure);
 	void setselect();
 	void setselect(uint2 sflags);
+	void setadded();
 
 	void close();
 	Boolean init(MCSocketHandle newfd);
@@ -168,6 +173,12 @@ public:
 	Boolean sslconnect();
 	Boolean sslaccept();
 	void sslclose();
+#ifdef _LINUX
+	// The events the socket is registered for with the poll backend, and
+	// whether it is waiting for that registration to be brought up to date.
+	uint4 pollevents;
+	Boolean polldirty;
+#endif
 protected:
 #ifdef _MACOSX
 	CFSocketRef cfsockref;
@@ -198,6 +209,12 @@ extern void MCS_aton(MCExecPoint &ep);
 extern void MCS_ntoa(MCExecPoint &ep, MCExecPoint &ep2);
 extern void MCS_pa(MCExecPoint &ep, MCSocket *s);
 
+#ifdef _LINUX
+extern void MCS_poll_socket_changed(MCSocket *s);
+extern void MCS_poll_socket_closed(MCSocket *s);
+extern void MCS_poll_socket_deleted(MCSocket *s);
+#endif
+
 
 
 
@@ -64,9 +64,16 @@ static MCVariable *s_cgi_get;
 static MCVariable *s_cgi_get_raw;
 static MCVariable *s_cgi_get_binary;
 static MCVariable *s_cgi_cookie;
+static MCVariable *s_cgi_session;
 
 static bool s_cgi_processed_post = false;
 
+// The standard streams cgi_initialize() wraps, and the output wrapper it
+// installs, so that cgi_reset() can put them back.
+static IO_handle s_cgi_stdin;
+static IO_handle s_cgi_stdout;
+static IO_handle s_cgi_stdout_wrapper;
+
 // rather than making stdin / $_POST_RAW / $_POST, $_POST_BINARY, $_FILES
 // exclusive, we store the stream contents in this cache object and create a
 // cache reader handle around it when reading from stdin
@@ -1201,6 +1208,35 @@ _CRTIMP extern char **_environ;
 extern char **environ;
 #endif
 
+// Create the given global, or if a previous request created it, clear it.
+static void cgi_create_variable(const char *p_name, MCVariable*& x_var)
+{
+	if (x_var != NULL)
+	{
+		x_var -> clear();
+		return;
+	}
+	
+	/* UNCHECKED */ MCVariable::createwithname_cstring(p_name, x_var);
+	x_var -> setnext(MCglobals);
+	MCglobals = x_var;
+}
+
+// Create the given deferred global, or if a previous request created it, make
+// sure it is computed again for this one.
+static void cgi_create_deferred_variable(const char *p_name, MCDeferredVariableComputeCallback p_callback, MCVariable*& x_var)
+{
+	if (x_var != NULL)
+	{
+		static_cast<MCDeferredVariable *>(x_var) -> invalidate();
+		return;
+	}
+	
+	/* UNCHECKED */ MCDeferredVariable::createwithname_cstring(p_name, p_callback, nil, x_var);
+	x_var -> setnext(MCglobals);
+	MCglobals = x_var;
+}
+
 bool cgi_initialize()
 {
 	// need to ensure PATH_TRANSLATED points to the script and PATH_INFO contains everything that follows
@@ -1231,20 +1267,21 @@ bool cgi_initialize()
 	// which is filled as the stream is read from.  this allows stdin to be used
 	// to populate the post data arrays, and also to be read from by the script
 	// without conflicting
+	s_cgi_stdin = IO_stdin;
 	s_cgi_stdin_cache = new MCStreamCache(IO_stdin->handle);
 	IO_stdin = new IO_header(new MCCacheHandle(s_cgi_stdin_cache), 0);
 		
 	// Initialize the output wrapper, this simply ensures we output headers
 	// before any content.
+	s_cgi_stdout = IO_stdout;
 	IO_stdout = new IO_header(new cgi_stdout, 0);
+	s_cgi_stdout_wrapper = IO_stdout;
 	
 	// Need an exec-point for variable creation.
 	MCExecPoint ep;
 	
 	// Construct the _SERVER variable
-	/* UNCHECKED */ MCVariable::createwithname_cstring("$_SERVER", s_cgi_server);
-	s_cgi_server -> setnext(MCglobals);
-	MCglobals = s_cgi_server;
+	cgi_create_variable("$_SERVER", s_cgi_server);
 	for(uint32_t i = 0; environ[i] != NULL; i++)
 	{
 		
@@ -1320,45 +1357,26 @@ bool cgi_initialize()
 	
 	// Construct the GET variables by parsing the QUERY_STRING
 	
-	/* UNCHECKED */ MCDeferredVariable::createwithname_cstring("$_GET_RAW", cgi_compute_get_raw_var, nil, s_cgi_get_raw);
-	s_cgi_get_raw -> setnext(MCglobals);
-	MCglobals = s_cgi_get_raw;	
-	/* UNCHECKED */ MCDeferredVariable::createwithname_cstring("$_GET", cgi_compute_get_var, nil, s_cgi_get);
-	s_cgi_get -> setnext(MCglobals);
-	MCglobals = s_cgi_get;
-	/* UNCHECKED */ MCDeferredVariable::createwithname_cstring("$_GET_BINARY", cgi_compute_get_binary_var, nil, s_cgi_get_binary);
-	s_cgi_get_binary -> setnext(MCglobals);
-	MCglobals = s_cgi_get_binary;	
+	cgi_create_deferred_variable("$_GET_RAW", cgi_compute_get_raw_var, s_cgi_get_raw);
+	cgi_create_deferred_variable("$_GET", cgi_compute_get_var, s_cgi_get);
+	cgi_create_deferred_variable("$_GET_BINARY", cgi_compute_get_binary_var, s_cgi_get_binary);
 	
 	// Construct the _POST variables by reading stdin.
 	
-	/* UNCHECKED */ MCDeferredVariable::createwithname_cstring("$_POST_RAW", cgi_compute_post_raw_var, nil, s_cgi_post_raw);
-	s_cgi_post_raw -> setnext(MCglobals);
-	MCglobals = s_cgi_post_raw;
-	/* UNCHECKED */ MCDeferredVariable::createwithname_cstring("$_POST", cgi_compute_post_var, nil, s_cgi_post);
-	s_cgi_post -> setnext(MCglobals);
-	MCglobals = s_cgi_post;
-	/* UNCHECKED */ MCDeferredVariable::createwithname_cstring("$_POST_BINARY", cgi_compute_post_binary_var, nil, s_cgi_post_binary);
-	s_cgi_post_binary -> setnext(MCglobals);
-	MCglobals = s_cgi_post_binary;	
+	cgi_create_deferred_variable("$_POST_RAW", cgi_compute_post_raw_var, s_cgi_post_raw);
+	cgi_create_deferred_variable("$_POST", cgi_compute_post_var, s_cgi_post);
+	cgi_create_deferred_variable("$_POST_BINARY", cgi_compute_post_binary_var, s_cgi_post_binary);
 	
 	// Construct the FILES variable by reading stdin
 
-	/* UNCHECKED */ MCDeferredVariable::createwithname_cstring("$_FILES", cgi_compute_files_var, nil, s_cgi_files);
-	s_cgi_files -> setnext(MCglobals);
-	MCglobals = s_cgi_files;
+	cgi_create_deferred_variable("$_FILES", cgi_compute_files_var, s_cgi_files);
 	
 	// Construct the COOKIES variable by parsing HTTP_COOKIE
-	/* UNCHECKED */ MCDeferredVariable::createwithname_cstring("$_COOKIE", cgi_compute_cookie_var, nil, s_cgi_cookie);
-	s_cgi_cookie -> setnext(MCglobals);
-	MCglobals = s_cgi_cookie;
+	cgi_create_deferred_variable("$_COOKIE", cgi_compute_cookie_var, s_cgi_cookie);
 	
 	// Create the $_SESSION variable explicitly, to be populated upon calls to "start session"
 	// required as implicit references to "$_SESSION" will result in its creation as an env var
-	MCVariable *t_session_var = NULL;
-	/* UNCHECKED */ MCVariable::createwithname_cstring("$_SESSION", t_session_var);
-	t_session_var->setnext(MCglobals);
-	MCglobals = t_session_var;
+	cgi_create_variable("$_SESSION", s_cgi_session);
 
 	return true;
 }
@@ -1374,6 +1392,67 @@ void cgi_finalize()
 	cgi_finalize_session();
 }
 
+// Undo the per-request setup of cgi_initialize() and anything the script has
+// changed about the response, so that a FastCGI worker can serve another
+// request. The CGI variables themselves are reset by the next cgi_initialize().
+void cgi_reset()
+{
+	// If nothing was output the output wrapper is still in place, otherwise it
+	// has already removed itself.
+	if (IO_stdout == s_cgi_stdout_wrapper)
+	{
+		IO_handle t_wrapper;
+		t_wrapper = IO_stdout;
+		MCS_close(t_wrapper);
+	}
+	else
+		delete s_cgi_stdout_wrapper;
+	IO_stdout = s_cgi_stdout;
+	s_cgi_stdout_wrapper = NULL;
+	
+	// Remove the input wrapper and discard anything buffered from this
+	// request's input.
+	IO_handle t_stdin;
+	t_stdin = IO_stdin;
+	IO_stdin = s_cgi_stdin;
+	MCS_close(t_stdin);
+	delete s_cgi_stdin_cache;
+	s_cgi_stdin_cache = NULL;
+	IO_stdin -> handle -> Seek(0, 1);
+	
+	s_cgi_processed_post = false;
+	
+	for(uint32_t i = 0; i < MCservercgiheadercount; i++)
+		free(MCservercgiheaders[i]);
+	free(MCservercgiheaders);
+	MCservercgiheaders = NULL;
+	MCservercgiheadercount = 0;
+	
+	for(uint32_t i = 0; i < MCservercgicookiecount; i++)
+	{
+		MCCStringFree(MCservercgicookies[i] . name);
+		MCCStringFree(MCservercgicookies[i] . value);
+		MCCStringFree(MCservercgicookies[i] . path);
+		MCCStringFree(MCservercgicookies[i] . domain);
+	}
+	MCMemoryDeleteArray(MCservercgicookies);
+	MCservercgicookies = NULL;
+	MCservercgicookiecount = 0;
+	
+	// Put the server properties a script can set back to their defaults.
+	MCS_set_errormode(kMCSErrorModeInline);
+	MCserveroutputtextencoding = kMCSOutputTextEncodingNative;
+	MCserveroutputlineendings = kMCSOutputLineEndingsNative;
+	
+	MCCStringFree(MCsessionsavepath);
+	MCsessionsavepath = NULL;
+	MCCStringFree(MCsessionname);
+	MCsessionname = NULL;
+	MCCStringFree(MCsessionid);
+	MCsessionid = NULL;
+	MCsessionlifetime = 60 * 24;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 static bool cgi_send_cookies(void)
@@ -1684,6 +1763,17 @@ const char *MCS_get_session_id(void)
 	return MCsessionid;
 }
 
+void MCS_get_script_cache_stats(uint32_t& r_hits, uint32_t& r_misses, uint32_t& r_invalidations)
+{
+	if (MCserverscript == NULL)
+	{
+		r_hits = r_misses = r_invalidations = 0;
+		return;
+	}
+	
+	MCserverscript -> GetParseCacheStats(r_hits, r_misses, r_invalidations);
+}
+
 bool MCServerGetSessionIdFromCookie(char *&r_id)
 {
 	MCVariable *t_cookie_array;
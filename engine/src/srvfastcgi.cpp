@@ -0,0 +1,756 @@
+/* Copyright (C) 2003-2013 Runtime Revolution Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "prefix.h"
+
+#include "core.h"
+#include "globdefs.h"
+#include "filedefs.h"
+#include "objdefs.h"
+#include "parsedef.h"
+
+#include "srvmain.h"
+
+#ifdef FEATURE_FASTCGI
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  When a FastCGI process manager (mod_fcgid, spawn-fcgi and friends) launches
+//  the server engine, it does so with a listening socket on fd 0 instead of a
+//  request in the environment. In that case the engine is initialized once and
+//  then forks a pool of workers from the fully initialized image.
+//
+//  Each worker accepts a connection, unpacks the request into the environment
+//  and onto fds 0 and 1 so that the existing CGI path runs unchanged, and sends
+//  the output back as FastCGI records. It then resets the engine's per-request
+//  state - globals, script locals, included files, open files and sockets,
+//  pending messages, headers, cookies and session settings - and accepts the
+//  next connection. Engine-wide properties a script sets are not reset, so
+//  after a configurable number of requests the worker exits and the master
+//  forks a fresh one.
+//
+//  Anything the master does before forking is inherited by every worker - in
+//  particular scripts it has preloaded are already parsed. Before forking the
+//  master checks that state is still current, and if not re-executes itself to
+//  start again with a fresh engine. A worker which finds one of its scripts has
+//  changed on disk exits rather than serve another request, as files defining
+//  handlers can't be parsed again.
+//
+
+// The environment variable holding the number of workers to keep running.
+#define WORKERS_ENV_VAR "LIVECODE_SERVER_FASTCGI_WORKERS"
+#define DEFAULT_WORKER_COUNT 4
+#define MAX_WORKER_COUNT 256
+
+// The environment variable holding the number of requests a worker serves
+// before it exits and is replaced.
+#define MAX_REQUESTS_ENV_VAR "LIVECODE_SERVER_FASTCGI_MAX_REQUESTS"
+#define DEFAULT_MAX_REQUESTS 500
+
+enum
+{
+	kMCFastCGIVersion = 1,
+
+	kMCFastCGIBeginRequest = 1,
+	kMCFastCGIAbortRequest = 2,
+	kMCFastCGIEndRequest = 3,
+	kMCFastCGIParams = 4,
+	kMCFastCGIStdin = 5,
+	kMCFastCGIStdout = 6,
+	kMCFastCGIGetValues = 9,
+	kMCFastCGIGetValuesResult = 10,
+	kMCFastCGIUnknownType = 11,
+
+	kMCFastCGIResponder = 1,
+
+	kMCFastCGIRequestComplete = 0,
+	kMCFastCGICantMpxConn = 1,
+	kMCFastCGIUnknownRole = 3,
+};
+
+struct MCFastCGIHeader
+{
+	uint8_t version;
+	uint8_t type;
+	uint8_t request_id_b1;
+	uint8_t request_id_b0;
+	uint8_t content_length_b1;
+	uint8_t content_length_b0;
+	uint8_t padding_length;
+	uint8_t reserved;
+};
+
+// Records carry at most 64k of content and 255 bytes of padding.
+static uint8_t s_fastcgi_record[65535 + 255];
+
+// The pids of the running workers (master only), zero for an empty slot.
+static pid_t *s_fastcgi_workers = NULL;
+static uint32_t s_fastcgi_worker_count = 0;
+
+// Set by the signal handler when the master has been asked to stop.
+static volatile sig_atomic_t s_fastcgi_shutdown = 0;
+
+// The connection, request and output file of the request a worker is serving.
+static int s_fastcgi_connection = -1;
+static uint16_t s_fastcgi_request_id = 0;
+static int s_fastcgi_output = -1;
+
+// The environment the worker started with (worker only), which each request's
+// parameters are added to.
+static char **s_fastcgi_environment = NULL;
+
+// The number of requests the worker has served, and may serve (worker only).
+static uint32_t s_fastcgi_requests = 0;
+static uint32_t s_fastcgi_max_requests = DEFAULT_MAX_REQUESTS;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool fastcgi_read(int p_fd, void *p_buffer, uint32_t p_length)
+{
+	uint8_t *t_buffer;
+	t_buffer = (uint8_t *)p_buffer;
+	while(p_length > 0)
+	{
+		ssize_t t_read;
+		t_read = read(p_fd, t_buffer, p_length);
+		if (t_read < 0 && errno == EINTR)
+			continue;
+		if (t_read <= 0)
+			return false;
+		t_buffer += t_read;
+		p_length -= t_read;
+	}
+	return true;
+}
+
+static bool fastcgi_write(int p_fd, const void *p_buffer, uint32_t p_length)
+{
+	const uint8_t *t_buffer;
+	t_buffer = (const uint8_t *)p_buffer;
+	while(p_length > 0)
+	{
+		ssize_t t_written;
+		t_written = write(p_fd, t_buffer, p_length);
+		if (t_written < 0 && errno == EINTR)
+			continue;
+		if (t_written <= 0)
+			return false;
+		t_buffer += t_written;
+		p_length -= t_written;
+	}
+	return true;
+}
+
+// Read the next record from the connection, the content is placed in the
+// shared record buffer.
+static bool fastcgi_read_record(int p_connection, uint8_t& r_type, uint16_t& r_request_id, uint32_t& r_length)
+{
+	MCFastCGIHeader t_header;
+	if (!fastcgi_read(p_connection, &t_header, sizeof(MCFastCGIHeader)))
+		return false;
+
+	if (t_header . version != kMCFastCGIVersion)
+		return false;
+
+	uint32_t t_length;
+	t_length = (t_header . content_length_b1 << 8) | t_header . content_length_b0;
+	if (!fastcgi_read(p_connection, s_fastcgi_record, t_length + t_header . padding_length))
+		return false;
+
+	r_type = t_header . type;
+	r_request_id = (t_header . request_id_b1 << 8) | t_header . request_id_b0;
+	r_length = t_length;
+
+	return true;
+}
+
+static bool fastcgi_write_record(int p_connection, uint8_t p_type, uint16_t p_request_id, const void *p_content, uint32_t p_length)
+{
+	static const uint8_t s_padding[8] = { 0 };
+
+	MCFastCGIHeader t_header;
+	t_header . version = kMCFastCGIVersion;
+	t_header . type = p_type;
+	t_header . request_id_b1 = p_request_id >> 8;
+	t_header . request_id_b0 = p_request_id & 0xff;
+	t_header . content_length_b1 = p_length >> 8;
+	t_header . content_length_b0 = p_length & 0xff;
+	t_header . padding_length = (8 - (p_length & 7)) & 7;
+	t_header . reserved = 0;
+
+	return fastcgi_write(p_connection, &t_header, sizeof(MCFastCGIHeader)) &&
+		fastcgi_write(p_connection, p_content, p_length) &&
+		fastcgi_write(p_connection, s_padding, t_header . padding_length);
+}
+
+static bool fastcgi_end_request(int p_connection, uint16_t p_request_id, uint32_t p_app_status, uint8_t p_protocol_status)
+{
+	uint8_t t_body[8];
+	t_body[0] = (p_app_status >> 24) & 0xff;
+	t_body[1] = (p_app_status >> 16) & 0xff;
+	t_body[2] = (p_app_status >> 8) & 0xff;
+	t_body[3] = p_app_status & 0xff;
+	t_body[4] = p_protocol_status;
+	t_body[5] = t_body[6] = t_body[7] = 0;
+	return fastcgi_write_record(p_connection, kMCFastCGIEndRequest, p_request_id, t_body, 8);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Name-value pair lengths are encoded in one byte if less than 128, otherwise
+// in four bytes with the top bit set.
+static bool fastcgi_decode_length(const uint8_t*& x_ptr, const uint8_t *p_limit, uint32_t& r_length)
+{
+	if (x_ptr >= p_limit)
+		return false;
+
+	if ((x_ptr[0] & 0x80) == 0)
+	{
+		r_length = *x_ptr++;
+		return true;
+	}
+
+	if (p_limit - x_ptr < 4)
+		return false;
+
+	r_length = ((x_ptr[0] & 0x7f) << 24) | (x_ptr[1] << 16) | (x_ptr[2] << 8) | x_ptr[3];
+	x_ptr += 4;
+
+	return true;
+}
+
+static bool fastcgi_decode_pair(const uint8_t*& x_ptr, const uint8_t *p_limit, const uint8_t*& r_name, uint32_t& r_name_length, const uint8_t*& r_value, uint32_t& r_value_length)
+{
+	if (!fastcgi_decode_length(x_ptr, p_limit, r_name_length) ||
+		!fastcgi_decode_length(x_ptr, p_limit, r_value_length))
+		return false;
+
+	if ((uint32_t)(p_limit - x_ptr) < r_name_length ||
+		(uint32_t)(p_limit - x_ptr) - r_name_length < r_value_length)
+		return false;
+
+	r_name = x_ptr;
+	r_value = x_ptr + r_name_length;
+	x_ptr += r_name_length + r_value_length;
+
+	return true;
+}
+
+// Take a copy of the environment, so the parameters of one request (and any
+// changes its script makes) can be removed before the next.
+static void fastcgi_save_environment(void)
+{
+	uint32_t t_count;
+	for(t_count = 0; environ[t_count] != NULL; t_count++)
+		;
+	
+	s_fastcgi_environment = new char *[t_count + 1];
+	for(uint32_t i = 0; i < t_count; i++)
+		s_fastcgi_environment[i] = strdup(environ[i]);
+	s_fastcgi_environment[t_count] = NULL;
+}
+
+static void fastcgi_restore_environment(void)
+{
+	clearenv();
+	
+	// The saved strings are never freed, so putenv() can use them directly.
+	for(uint32_t i = 0; s_fastcgi_environment[i] != NULL; i++)
+		putenv(s_fastcgi_environment[i]);
+}
+
+// Put each of the request's parameters into the environment, where the CGI
+// layer expects to find them.
+static bool fastcgi_apply_params(const uint8_t *p_params, uint32_t p_length)
+{
+	fastcgi_restore_environment();
+	
+	const uint8_t *t_ptr, *t_limit;
+	t_ptr = p_params;
+	t_limit = p_params + p_length;
+	while(t_ptr < t_limit)
+	{
+		const uint8_t *t_name, *t_value;
+		uint32_t t_name_length, t_value_length;
+		if (!fastcgi_decode_pair(t_ptr, t_limit, t_name, t_name_length, t_value, t_value_length))
+			return false;
+
+		char *t_name_string, *t_value_string;
+		t_name_string = (char *)malloc(t_name_length + 1);
+		t_value_string = (char *)malloc(t_value_length + 1);
+		if (t_name_string == NULL || t_value_string == NULL)
+		{
+			free(t_name_string);
+			free(t_value_string);
+			return false;
+		}
+
+		memcpy(t_name_string, t_name, t_name_length);
+		t_name_string[t_name_length] = '\0';
+		memcpy(t_value_string, t_value, t_value_length);
+		t_value_string[t_value_length] = '\0';
+
+		if (t_name_length != 0)
+			setenv(t_name_string, t_value_string, 1);
+
+		free(t_name_string);
+		free(t_value_string);
+	}
+
+	return true;
+}
+
+// Answer a management query for the connection limits of this application.
+static bool fastcgi_send_values(int p_connection, uint32_t p_length)
+{
+	uint8_t t_result[256];
+	uint32_t t_result_length;
+	t_result_length = 0;
+
+	const uint8_t *t_ptr, *t_limit;
+	t_ptr = s_fastcgi_record;
+	t_limit = s_fastcgi_record + p_length;
+	while(t_ptr < t_limit)
+	{
+		const uint8_t *t_name, *t_value;
+		uint32_t t_name_length, t_value_length;
+		if (!fastcgi_decode_pair(t_ptr, t_limit, t_name, t_name_length, t_value, t_value_length))
+			break;
+
+		char t_answer[16];
+		if ((t_name_length == 14 && memcmp(t_name, "FCGI_MAX_CONNS", 14) == 0) ||
+			(t_name_length == 13 && memcmp(t_name, "FCGI_MAX_REQS", 13) == 0))
+			sprintf(t_answer, "%u", s_fastcgi_worker_count);
+		else if (t_name_length == 15 && memcmp(t_name, "FCGI_MPXS_CONNS", 15) == 0)
+			strcpy(t_answer, "0");
+		else
+			continue;
+
+		uint32_t t_answer_length;
+		t_answer_length = strlen(t_answer);
+		if (t_result_length + 2 + t_name_length + t_answer_length > sizeof(t_result))
+			break;
+
+		t_result[t_result_length++] = t_name_length;
+		t_result[t_result_length++] = t_answer_length;
+		memcpy(t_result + t_result_length, t_name, t_name_length);
+		t_result_length += t_name_length;
+		memcpy(t_result + t_result_length, t_answer, t_answer_length);
+		t_result_length += t_answer_length;
+	}
+
+	return fastcgi_write_record(p_connection, kMCFastCGIGetValuesResult, 0, t_result, t_result_length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Create an anonymous file to hold request input or output.
+static int fastcgi_create_temporary(void)
+{
+	const char *t_folder;
+	t_folder = getenv("TMPDIR");
+	if (t_folder == NULL)
+		t_folder = "/tmp";
+
+	char *t_path;
+	if (!MCCStringFormat(t_path, "%s/lcfcgiXXXXXX", t_folder))
+		return -1;
+
+	int t_fd;
+	t_fd = mkstemp(t_path);
+	if (t_fd >= 0)
+		unlink(t_path);
+
+	MCCStringFree(t_path);
+
+	return t_fd;
+}
+
+// Read a single responder request from the connection. On success the request
+// parameters are in the environment, its body is on fd 0 and fd 1 is redirected
+// to the output file.
+static bool fastcgi_read_request(int p_connection)
+{
+	bool t_success;
+	t_success = true;
+
+	uint16_t t_request_id;
+	t_request_id = 0;
+
+	uint8_t *t_params;
+	uint32_t t_params_length;
+	t_params = NULL;
+	t_params_length = 0;
+
+	int t_input;
+	t_input = -1;
+
+	bool t_have_params, t_have_input;
+	t_have_params = false;
+	t_have_input = false;
+
+	while(t_success && !t_have_input)
+	{
+		uint8_t t_type;
+		uint16_t t_id;
+		uint32_t t_length;
+		t_success = fastcgi_read_record(p_connection, t_type, t_id, t_length);
+		if (!t_success)
+			break;
+
+		// Management records have a request id of zero.
+		if (t_id == 0)
+		{
+			if (t_type == kMCFastCGIGetValues)
+				t_success = fastcgi_send_values(p_connection, t_length);
+			else
+			{
+				uint8_t t_body[8];
+				memset(t_body, 0, 8);
+				t_body[0] = t_type;
+				t_success = fastcgi_write_record(p_connection, kMCFastCGIUnknownType, 0, t_body, 8);
+			}
+			continue;
+		}
+
+		if (t_type == kMCFastCGIBeginRequest)
+		{
+			if (t_length < 8)
+				t_success = false;
+			else if (t_request_id != 0)
+			{
+				// We only ever serve one request per connection.
+				t_success = fastcgi_end_request(p_connection, t_id, 0, kMCFastCGICantMpxConn);
+			}
+			else if (((s_fastcgi_record[0] << 8) | s_fastcgi_record[1]) != kMCFastCGIResponder)
+			{
+				fastcgi_end_request(p_connection, t_id, 0, kMCFastCGIUnknownRole);
+				t_success = false;
+			}
+			else
+				t_request_id = t_id;
+			continue;
+		}
+
+		// Ignore anything which doesn't belong to the active request.
+		if (t_request_id == 0 || t_id != t_request_id)
+			continue;
+
+		switch(t_type)
+		{
+		case kMCFastCGIAbortRequest:
+			t_success = false;
+			break;
+
+		case kMCFastCGIParams:
+			if (t_length == 0)
+				t_have_params = true;
+			else
+			{
+				uint8_t *t_new_params;
+				t_new_params = (uint8_t *)realloc(t_params, t_params_length + t_length);
+				if (t_new_params == NULL)
+					t_success = false;
+				else
+				{
+					memcpy(t_new_params + t_params_length, s_fastcgi_record, t_length);
+					t_params = t_new_params;
+					t_params_length += t_length;
+				}
+			}
+			break;
+
+		case kMCFastCGIStdin:
+			if (t_input == -1)
+			{
+				t_input = fastcgi_create_temporary();
+				t_success = t_input >= 0;
+			}
+			if (t_success)
+			{
+				if (t_length == 0)
+					t_have_input = true;
+				else
+					t_success = fastcgi_write(t_input, s_fastcgi_record, t_length);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (t_success)
+		t_success = t_have_params && fastcgi_apply_params(t_params, t_params_length);
+
+	if (t_success)
+		t_success = lseek(t_input, 0, SEEK_SET) == 0 && dup2(t_input, 0) == 0;
+
+	int t_output;
+	t_output = -1;
+	if (t_success)
+	{
+		t_output = fastcgi_create_temporary();
+		t_success = t_output >= 0 && dup2(t_output, 1) == 1;
+	}
+
+	if (t_success)
+	{
+		s_fastcgi_connection = p_connection;
+		s_fastcgi_request_id = t_request_id;
+		s_fastcgi_output = t_output;
+	}
+	else if (t_output != -1)
+		close(t_output);
+
+	if (t_input != -1)
+		close(t_input);
+
+	free(t_params);
+
+	return t_success;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void fastcgi_signal_handler(int p_signal)
+{
+	s_fastcgi_shutdown = 1;
+}
+
+static void fastcgi_set_signal_handler(int p_signal, void (*p_handler)(int))
+{
+	struct sigaction t_action;
+	memset(&t_action, 0, sizeof(struct sigaction));
+	t_action . sa_handler = p_handler;
+	sigemptyset(&t_action . sa_mask);
+
+	// No SA_RESTART, the master must wake up from waitpid() to notice shutdown.
+	t_action . sa_flags = 0;
+	sigaction(p_signal, &t_action, NULL);
+}
+
+// Wait for a connection and read its request, exiting if the worker is asked
+// to stop first.
+static void fastcgi_accept(void)
+{
+	for(;;)
+	{
+		int t_connection;
+		t_connection = accept(0, NULL, NULL);
+		if (t_connection < 0)
+		{
+			if (s_fastcgi_shutdown)
+				_exit(0);
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			_exit(-1);
+		}
+
+		if (fastcgi_read_request(t_connection))
+		{
+			s_fastcgi_requests += 1;
+			return;
+		}
+
+		close(t_connection);
+	}
+}
+
+// Called in a freshly forked worker, only returns once a request has been read.
+static void fastcgi_worker(void)
+{
+	fastcgi_set_signal_handler(SIGTERM, SIG_DFL);
+	fastcgi_set_signal_handler(SIGINT, SIG_DFL);
+	fastcgi_set_signal_handler(SIGHUP, SIG_DFL);
+
+	// SIGUSR1 asks a worker to exit once it has finished any request it is
+	// serving.
+	fastcgi_set_signal_handler(SIGUSR1, fastcgi_signal_handler);
+
+	// A web server dropping the connection must not kill us mid-request.
+	signal(SIGPIPE, SIG_IGN);
+
+	const char *t_max_requests;
+	t_max_requests = getenv(MAX_REQUESTS_ENV_VAR);
+	if (t_max_requests != NULL && atoi(t_max_requests) > 0)
+		s_fastcgi_max_requests = atoi(t_max_requests);
+
+	fastcgi_save_environment();
+
+	fastcgi_accept();
+}
+
+bool MCServerFastCGIIsListening(void)
+{
+	// This is the same test libfcgi uses - a listening socket has no peer.
+	struct sockaddr_storage t_address;
+	socklen_t t_length;
+	t_length = sizeof(t_address);
+	return getpeername(0, (struct sockaddr *)&t_address, &t_length) < 0 && errno == ENOTCONN;
+}
+
+// Replace the master with a fresh instance of the engine. Workers which are
+// idle are stopped, those serving a request are left to finish it.
+static void fastcgi_reload(char *argv[])
+{
+	for(uint32_t i = 0; i < s_fastcgi_worker_count; i++)
+		if (s_fastcgi_workers[i] != 0)
+			kill(s_fastcgi_workers[i], SIGUSR1);
+
+	fflush(NULL);
+	execv("/proc/self/exe", argv);
+}
+
+bool MCServerFastCGIAcceptRequest(char *argv[], bool (*p_is_current)(void))
+{
+	s_fastcgi_worker_count = DEFAULT_WORKER_COUNT;
+
+	const char *t_workers;
+	t_workers = getenv(WORKERS_ENV_VAR);
+	if (t_workers != NULL && atoi(t_workers) > 0)
+		s_fastcgi_worker_count = atoi(t_workers);
+	if (s_fastcgi_worker_count > MAX_WORKER_COUNT)
+		s_fastcgi_worker_count = MAX_WORKER_COUNT;
+
+	s_fastcgi_workers = new pid_t[s_fastcgi_worker_count];
+	memset(s_fastcgi_workers, 0, sizeof(pid_t) * s_fastcgi_worker_count);
+
+	fastcgi_set_signal_handler(SIGTERM, fastcgi_signal_handler);
+	fastcgi_set_signal_handler(SIGINT, fastcgi_signal_handler);
+	fastcgi_set_signal_handler(SIGHUP, fastcgi_signal_handler);
+
+	while(!s_fastcgi_shutdown)
+	{
+		// If the state the workers would inherit is out of date, start again. If
+		// that fails we carry on as we are.
+		if (p_is_current != NULL && !p_is_current())
+			fastcgi_reload(argv);
+
+		// Top the pool back up - any empty slot is a worker which has finished
+		// its request (or died).
+		bool t_fork_failed;
+		t_fork_failed = false;
+		for(uint32_t i = 0; i < s_fastcgi_worker_count && !s_fastcgi_shutdown; i++)
+		{
+			if (s_fastcgi_workers[i] != 0)
+				continue;
+
+			// Make sure nothing buffered in the master is output twice.
+			fflush(NULL);
+
+			pid_t t_pid;
+			t_pid = fork();
+			if (t_pid == 0)
+			{
+				delete[] s_fastcgi_workers;
+				s_fastcgi_workers = NULL;
+				fastcgi_worker();
+				return true;
+			}
+
+			if (t_pid < 0)
+			{
+				t_fork_failed = true;
+				break;
+			}
+
+			s_fastcgi_workers[i] = t_pid;
+		}
+
+		int t_status;
+		pid_t t_pid;
+		t_pid = waitpid(-1, &t_status, 0);
+		if (t_pid > 0)
+		{
+			for(uint32_t i = 0; i < s_fastcgi_worker_count; i++)
+				if (s_fastcgi_workers[i] == t_pid)
+				{
+					s_fastcgi_workers[i] = 0;
+					break;
+				}
+		}
+		else if (t_fork_failed || errno == ECHILD)
+			sleep(1);
+	}
+
+	for(uint32_t i = 0; i < s_fastcgi_worker_count; i++)
+		if (s_fastcgi_workers[i] != 0)
+			kill(s_fastcgi_workers[i], SIGTERM);
+
+	while(waitpid(-1, NULL, 0) > 0 || errno == EINTR)
+		;
+
+	delete[] s_fastcgi_workers;
+	s_fastcgi_workers = NULL;
+
+	return false;
+}
+
+void MCServerFastCGIEndRequest(int p_exit_code)
+{
+	bool t_success;
+	t_success = lseek(s_fastcgi_output, 0, SEEK_SET) == 0;
+
+	// Record content is kept to a multiple of 8 bytes so it needs no padding.
+	while(t_success)
+	{
+		ssize_t t_read;
+		t_read = read(s_fastcgi_output, s_fastcgi_record, 65528);
+		if (t_read < 0 && errno == EINTR)
+			continue;
+		if (t_read <= 0)
+			break;
+		t_success = fastcgi_write_record(s_fastcgi_connection, kMCFastCGIStdout, s_fastcgi_request_id, s_fastcgi_record, t_read);
+	}
+
+	if (t_success)
+		t_success = fastcgi_write_record(s_fastcgi_connection, kMCFastCGIStdout, s_fastcgi_request_id, NULL, 0);
+
+	if (t_success)
+		fastcgi_end_request(s_fastcgi_connection, s_fastcgi_request_id, p_exit_code, kMCFastCGIRequestComplete);
+
+	close(s_fastcgi_output);
+	close(s_fastcgi_connection);
+	s_fastcgi_output = -1;
+	s_fastcgi_connection = -1;
+}
+
+bool MCServerFastCGINextRequest(void)
+{
+	if (s_fastcgi_shutdown || s_fastcgi_requests >= s_fastcgi_max_requests)
+		return false;
+
+	fastcgi_accept();
+
+	return true;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
@@ -25,6 +25,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "globals.h"
 #include "srvscript.h"
+#include "srvmain.h"
 #include "variable.h"
 #include "osspec.h"
 #include "system.h"
@@ -39,6 +40,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "util.h"
 #include "uidc.h"
 #include "font.h"
+#include "debug.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -63,6 +65,9 @@ static char *s_server_home = NULL;
 // If true, the server engine is running in CGI mode
 static bool s_server_cgi = false;
 
+// If true, the server engine is serving requests as a FastCGI application
+static bool s_server_fastcgi = false;
+
 // The main script the server engine will run.
 char *MCserverinitialscript = NULL;
 
@@ -327,6 +332,7 @@ int X_close();
 
 extern bool cgi_initialize();
 extern void cgi_finalize(void);
+extern void cgi_reset(void);
 extern void MCU_initialize_names();
 
 bool X_init(int argc, char *argv[], char *envp[])
@@ -385,8 +391,20 @@ bool X_init(int argc, char *argv[], char *envp[])
 	// Check for CGI mode.
 
 	s_server_cgi = MCS_getenv("GATEWAY_INTERFACE") != NULL;
+
+#ifdef FEATURE_FASTCGI
+	// If we have been launched with a listening socket rather than a request
+	// then the CGI part of initialization is deferred until a worker has a
+	// request to serve (see X_fastcgi_request()).
+	s_server_fastcgi = !s_server_cgi && MCServerFastCGIIsListening();
+#endif
 	
-	if (s_server_cgi)
+	if (s_server_fastcgi)
+	{
+		MCS_set_errormode(kMCSErrorModeInline);
+		envp = nil;
+	}
+	else if (s_server_cgi)
 	{
 		MCS_set_errormode(kMCSErrorModeInline);
 		
@@ -448,6 +466,13 @@ static bool load_extension_callback(void *p_context, const MCSystemFolderEntry *
 
 static void X_load_extensions(MCServerScript *p_script)
 {
+	// A FastCGI worker runs the main loop once per request, but the externals
+	// only need loading once.
+	static bool s_extensions_loaded = false;
+	if (s_extensions_loaded)
+		return;
+	s_extensions_loaded = true;
+	
 	char *t_dir;
 	t_dir = MCS_getcurdir();
 	
@@ -565,10 +590,124 @@ void X_main_loop(void)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#ifdef FEATURE_FASTCGI
+// The environment variable listing (colon-separated) the scripts to parse in
+// the FastCGI master, so that workers start with them already parsed.
+#define PRELOAD_ENV_VAR "LIVECODE_SERVER_FASTCGI_PRELOAD"
+
+static void X_fastcgi_preload(void)
+{
+	const char *t_list;
+	t_list = getenv(PRELOAD_ENV_VAR);
+	if (t_list == NULL)
+		return;
+	
+	char *t_files;
+	t_files = strdup(t_list);
+	for(char *t_file = strtok(t_files, ":"); t_file != NULL; t_file = strtok(NULL, ":"))
+		if (!MCserverscript -> Preload(t_file))
+			IO_printf(IO_stderr, "Unable to preload script: %s\n", t_file);
+	free(t_files);
+}
+
+static bool X_fastcgi_is_current(void)
+{
+	return MCserverscript -> IsParseCacheCurrent();
+}
+
+// Wait for a FastCGI request and set up the CGI environment to serve it. This
+// only returns in a worker process forked from the fully initialized engine.
+static void X_fastcgi_request(char *argv[])
+{
+	MCserverscript = static_cast<MCServerScript *>(MCdispatcher -> gethome());
+	X_fastcgi_preload();
+	
+	if (!MCServerFastCGIAcceptRequest(argv, X_fastcgi_is_current))
+		exit(0);
+
+	// Make sure the workers don't all share the master's random sequence.
+	MCrandomseed += MCS_getpid();
+	MCU_srand();
+
+	s_server_cgi = true;
+	if (!cgi_initialize())
+	{
+		MCServerFastCGIEndRequest(-1);
+		exit(-1);
+	}
+}
+
+// Put back the state a script can change for the rest of its request, so that
+// the next request starts out as it would in a freshly forked worker.
+static void X_fastcgi_reset(void)
+{
+	cgi_reset();
+	MCserverscript -> Reset();
+	
+	// A freshly forked worker has no globals with a value. The CGI variables
+	// are recomputed by cgi_initialize().
+	for(MCVariable *t_var = MCglobals; t_var != NULL; t_var = t_var -> getnext())
+		t_var -> clear();
+	
+	while (MCnfiles)
+		IO_closefile(MCfiles[0] . name);
+	IO_freesockets();
+	MCscreen -> cancelmessages();
+	
+	MCresult -> clear();
+	
+	// A script which quits only ends its request.
+	MCquit = False;
+	MCquitisexplicit = False;
+	MCexitall = False;
+	MCtraceabort = False;
+	MCtracereturn = False;
+	MCretcode = 0;
+}
+
+// Wait for the worker's next request and set up the CGI environment to serve
+// it. Returns false if the worker should exit instead.
+static bool X_fastcgi_next_request(void)
+{
+	// Files which define handlers can't be parsed again, so a worker whose
+	// scripts have changed must be replaced.
+	if (!MCserverscript -> IsParseCacheCurrent())
+		return false;
+	
+	X_fastcgi_reset();
+	
+	if (!MCServerFastCGINextRequest())
+		return false;
+	
+	if (!cgi_initialize())
+	{
+		MCServerFastCGIEndRequest(-1);
+		return false;
+	}
+	
+	return true;
+}
+#endif
+
 int main(int argc, char *argv[], char *envp[])
 {
 	if (!X_init(argc, argv, envp))
 		exit(-1);
+
+#ifdef FEATURE_FASTCGI
+	if (s_server_fastcgi)
+	{
+		X_fastcgi_request(argv);
+		do
+		{
+			X_main_loop();
+			MCServerFastCGIEndRequest(MCretcode);
+		}
+		while(X_fastcgi_next_request());
+		
+		exit(X_close());
+	}
+#endif
 	
 	X_main_loop();
 	
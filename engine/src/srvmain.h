@@ -53,4 +53,19 @@ extern uint32_t MCservercgicookiecount;
 
 extern char *MCservercgidocumentroot;
 
+#ifdef FEATURE_FASTCGI
+// Returns true if the engine has been launched by a FastCGI process manager.
+bool MCServerFastCGIIsListening(void);
+// Runs the pool of pre-forked workers. Returns true in a worker once it has a
+// request to serve, and false in the master when it is shut down. If
+// <p_is_current> returns false before a worker is forked, the master re-executes
+// itself with <argv>.
+bool MCServerFastCGIAcceptRequest(char *argv[], bool (*p_is_current)(void));
+// Sends the worker's output back to the web server and ends the request.
+void MCServerFastCGIEndRequest(int p_exit_code);
+// Waits for the worker's next request. Returns false without waiting if the
+// worker has served as many requests as it may, or has been asked to stop.
+bool MCServerFastCGINextRequest(void);
+#endif
+
 #endif
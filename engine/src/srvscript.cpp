@@ -46,6 +46,9 @@ MCServerScript::MCServerScript(void)
 	m_ep = NULL;
 	m_include_depth = 0;
 	m_current_file = nil;
+	m_cache_hits = 0;
+	m_cache_misses = 0;
+	m_cache_invalidations = 0;
 }
 
 MCServerScript::~MCServerScript(void)
@@ -56,10 +59,8 @@ MCServerScript::~MCServerScript(void)
 		t_file = m_files;
 		m_files = m_files -> next;
 		
-		if (t_file -> handle != NULL)
-			t_file -> handle -> Close();
+		UnloadFile(t_file);
 		delete t_file -> filename;
-		delete t_file -> script;
 		delete t_file;
 	}
 }
@@ -137,10 +138,74 @@ MCServerScript::File *MCServerScript::FindFile(const char *p_filename, bool p_ad
 	t_file -> index = m_files == NULL ? 1 : m_files -> index + 1;
 	t_file -> script = NULL;
 	t_file -> handle = NULL;
+	t_file -> size = 0;
+	t_file -> modification_time = 0;
+	t_file -> parsed = false;
+	t_file -> statements = nil;
+	t_file -> errors = nil;
+	t_file -> has_handlers = false;
+	t_file -> included = false;
+	t_file -> executing = 0;
 	
 	return t_file;
 }
 
+bool MCServerScript::LoadFile(File *p_file)
+{
+	// Attempt to open the file
+	MCSystemFileHandle *t_handle;
+	t_handle = MCsystem -> OpenFile(p_file -> filename, kMCSystemFileModeRead | kMCSystemFileModeNulTerminate, true);
+	if (t_handle == NULL)
+		return false;
+	
+	if (!MCsystem -> GetFileInfo(p_file -> filename, p_file -> size, p_file -> modification_time))
+	{
+		p_file -> size = -1;
+		p_file -> modification_time = 0;
+	}
+	
+	// If the file was successfully memory-mapped, then use the direct pointer,
+	// otherwise just load it all into memory.
+	p_file -> script = (char *)t_handle -> GetFilePointer();
+	if (p_file -> script != NULL)
+		p_file -> handle = t_handle;
+	else
+	{
+		int32_t t_length;
+		t_length = (int32_t)t_handle -> GetFileSize();
+		p_file -> script = new char[t_length + 1];
+		
+		uint32_t t_read;
+		t_handle -> Read(p_file -> script, t_length, t_read);
+		
+		p_file -> script[t_length] = '\0';
+		
+		t_handle -> Close();
+		
+		p_file -> handle = NULL;
+	}
+	
+	return true;
+}
+
+void MCServerScript::UnloadFile(File *p_file)
+{
+	if (p_file -> statements != nil)
+		p_file -> statements -> deletestatements(p_file -> statements);
+	delete p_file -> errors;
+	
+	if (p_file -> handle != NULL)
+		p_file -> handle -> Close();
+	else
+		delete[] p_file -> script;
+	
+	p_file -> script = NULL;
+	p_file -> handle = NULL;
+	p_file -> parsed = false;
+	p_file -> statements = nil;
+	p_file -> errors = nil;
+}
+
 Parse_stat MCServerScript::ParseNextStatement(MCScriptPoint& sp, MCStatement*& r_statement)
 {
 	Parse_stat t_stat;
@@ -197,6 +262,10 @@ Parse_stat MCServerScript::ParseNextStatement(MCScriptPoint& sp, MCStatement*& r
 						{
 							sp . sethandler(NULL);
 							hlist -> addhandler((Handler_type)t_symbol -> which, t_new_handler);
+							m_current_file -> has_handlers = true;
+
+							// The new handler may shadow one a cached path resolved to.
+							MCscriptepoch++;
 						}
 						else
 						{
@@ -301,6 +370,133 @@ Parse_stat MCServerScript::ParseNextStatement(MCScriptPoint& sp, MCStatement*& r
 	return t_stat;
 }
 
+Parse_stat MCServerScript::ParseFile(File *p_file, MCStatement*& r_statements)
+{
+	// Save the old file index
+	File *t_old_file;
+	t_old_file = m_current_file;
+	
+	// Set the current one (handlers defined by the file take their index from it)
+	m_current_file = p_file;
+	
+	// Note that script point does not copy 'script' and requires it to be NUL-
+	// terminated. Indeed, this string *has* to persist until termination as
+	// constants, handler names and variable names use substrings of it directly.
+	MCScriptPoint sp(this, hlist, p_file -> script);
+	sp . allowtags(True);
+	
+	// The statement chain that will executed.
+	MCStatement *t_statements, *t_last_statement;
+	t_statements = t_last_statement = nil;
+
+	// Clear any parse errors
+	MCperror -> clear();
+
+	// Parse the statements
+	Parse_stat t_stat;
+	t_stat = PS_NORMAL;
+	for(;;)
+	{	
+		// If we end up parsing a statement, it will be stored here.
+		MCStatement *t_statement;
+		t_statement = NULL;
+
+		// Fetch the next statement (if any).
+		t_stat = ParseNextStatement(sp, t_statement);
+	
+		// If we got a statement, append it to the chain.
+		if (t_statement != nil)
+		{
+			if (t_last_statement != nil)
+				t_last_statement -> setnext(t_statement);
+			else
+				t_statements = t_statement;
+
+			t_last_statement = t_statement;
+		}
+		else if (t_stat == PS_EOF)
+		{
+			t_stat = PS_NORMAL;
+			break;
+		}
+		else
+			break;
+	}
+	
+	// Set back the old file index.
+	m_current_file = t_old_file;
+	
+	r_statements = t_statements;
+	
+	return t_stat;
+}
+
+bool MCServerScript::Preload(const char *p_filename)
+{
+	if (hlist == NULL)
+		hlist = new MCHandlerlist;
+	
+	File *t_file;
+	t_file = FindFile(p_filename, true);
+	if (t_file -> parsed)
+		return true;
+	
+	if (t_file -> script == NULL)
+	{
+		if (!LoadFile(t_file))
+			return false;
+		
+		if (m_files == NULL || t_file -> index > m_files -> index)
+			m_files = t_file;
+	}
+	
+	t_file -> parsed = true;
+	if (ParseFile(t_file, t_file -> statements) != PS_NORMAL)
+	{
+		t_file -> errors = new MCError;
+		t_file -> errors -> append(*MCperror);
+		MCperror -> clear();
+	}
+	
+	return true;
+}
+
+bool MCServerScript::IsParseCacheCurrent(void)
+{
+	for(File *t_file = m_files; t_file != NULL; t_file = t_file -> next)
+	{
+		if (!t_file -> parsed)
+			continue;
+		
+		int64_t t_size;
+		uint32_t t_modification_time;
+		if (!MCsystem -> GetFileInfo(t_file -> filename, t_size, t_modification_time) ||
+			t_size != t_file -> size || t_modification_time != t_file -> modification_time)
+			return false;
+	}
+	
+	return true;
+}
+
+void MCServerScript::Reset(void)
+{
+	for(File *t_file = m_files; t_file != NULL; t_file = t_file -> next)
+		t_file -> included = false;
+	
+	if (hlist != NULL)
+		hlist -> resetvars();
+	
+	delete m_ep;
+	m_ep = NULL;
+}
+
+void MCServerScript::GetParseCacheStats(uint32_t& r_hits, uint32_t& r_misses, uint32_t& r_invalidations)
+{
+	r_hits = m_cache_hits;
+	r_misses = m_cache_misses;
+	r_invalidations = m_cache_invalidations;
+}
+
 // MW-2009-06-02: Add support for 'require' style includes.
 bool MCServerScript::Include(MCExecPoint& outer_ep, const char *p_filename, bool p_require)
 {
@@ -342,102 +538,94 @@ bool MCServerScript::Include(MCExecPoint& outer_ep, const char *p_filename, bool
 	MCsystem->SetCurrentFolder(t_old_folder);
 	MCCStringFree(t_old_folder);
 
-	// If we are 'requiring' and the script is already loaded, we are done.
-	if (t_file -> script != NULL && p_require)
+	// If we are 'requiring' and the script has already been run, we are done.
+	if (t_file -> included && p_require)
 		return true;
 	
+	// If the file has changed since it was parsed, drop its cached parse so it
+	// is reloaded below. Files which define handlers keep their original
+	// contents, as they can only be parsed once, as do files which are still
+	// executing.
+	if (t_file -> parsed && !t_file -> has_handlers && t_file -> executing == 0)
+	{
+		int64_t t_size;
+		uint32_t t_modification_time;
+		if (!MCsystem -> GetFileInfo(t_file -> filename, t_size, t_modification_time) ||
+			t_size != t_file -> size || t_modification_time != t_file -> modification_time)
+		{
+			UnloadFile(t_file);
+			m_cache_invalidations += 1;
+		}
+	}
+	
 	// If the file isn't open yet, open it
 	if (t_file -> script == NULL)
 	{
-		// Attempt to open the file
-		MCSystemFileHandle *t_handle;
-		t_handle = MCsystem -> OpenFile(t_file -> filename, kMCSystemFileModeRead | kMCSystemFileModeNulTerminate, true);
-		if (t_handle == NULL)
+		if (!LoadFile(t_file))
 		{
 			MCeerror -> add(EE_INCLUDE_FILENOTFOUND, 0, 0, t_file -> filename);
 			return false;
 		}
 		
-		// If the file was successfully memory-mapped, then use the direct pointer,
-		// otherwise just load it all into memory.
-		t_file -> script = (char *)t_handle -> GetFilePointer();
-		if (t_file -> script != NULL)
-			t_file -> handle = t_handle;
+		// New entries are given the index after that of the head of the list,
+		// so this is only true if the file isn't in the list yet.
+		if (m_files == NULL || t_file -> index > m_files -> index)
+			m_files = t_file;
+	}
+	
+	// Use the cached parse if there is one. The exception is a file which has
+	// defined handlers and been run already - it is parsed again so that the
+	// duplicate handlers are reported, as they always have been.
+	MCStatement *t_statements;
+	Parse_stat t_stat;
+	if (t_file -> parsed && !(t_file -> has_handlers && t_file -> included))
+	{
+		m_cache_hits += 1;
+		
+		t_statements = t_file -> statements;
+		
+		MCperror -> clear();
+		if (t_file -> errors == nil)
+			t_stat = PS_NORMAL;
 		else
 		{
-			int32_t t_length;
-			t_length = (int32_t)t_handle -> GetFileSize();
-			t_file -> script = new char[t_length + 1];
-			
-			uint32_t t_read;
-			t_handle -> Read(t_file -> script, t_length, t_read);
-			
-			t_file -> script[t_length] = '\0';
-			
-			t_handle -> Close();
-			
-			t_file -> handle = NULL;
+			MCperror -> append(*t_file -> errors);
+			t_stat = PS_ERROR;
 		}
+	}
+	else
+	{
+		m_cache_misses += 1;
 		
-		m_files = t_file;
+		t_stat = ParseFile(t_file, t_statements);
+		
+		if (!t_file -> parsed)
+		{
+			t_file -> parsed = true;
+			t_file -> statements = t_statements;
+			if (t_stat != PS_NORMAL)
+			{
+				t_file -> errors = new MCError;
+				t_file -> errors -> append(*MCperror);
+			}
+		}
 	}
 	
+	t_file -> included = true;
+	
 	// Save the old file index
 	File *t_old_file;
 	t_old_file = m_current_file;
 	
 	// Set the current one.
 	m_current_file = t_file;
-	
-	// Note that script point does not copy 'script' and requires it to be NUL-
-	// terminated. Indeed, this string *has* to persist until termination as
-	// constants, handler names and variable names use substrings of it directly.
-	MCScriptPoint sp(this, hlist, t_file -> script);
-	sp . allowtags(True);
-	
-	// The statement chain that will executed.
-	MCStatement *t_statements, *t_last_statement;
-	t_statements = t_last_statement = nil;
-
-	// Clear any parse errors
-	MCperror -> clear();
-
-	// Parse the statements
-	Parse_stat t_stat;
-	t_stat = PS_NORMAL;
-	for(;;)
-	{	
-		// If we end up parsing a statement, it will be stored here.
-		MCStatement *t_statement;
-		t_statement = NULL;
-
-		// Fetch the next statement (if any).
-		t_stat = ParseNextStatement(sp, t_statement);
-	
-		// If we got a statement, append it to the chain.
-		if (t_statement != nil)
-		{
-			if (t_last_statement != nil)
-				t_last_statement -> setnext(t_statement);
-			else
-				t_statements = t_statement;
-
-			t_last_statement = t_statement;
-		}
-		else if (t_stat == PS_EOF)
-		{
-			t_stat = PS_NORMAL;
-			break;
-		}
-		else
-			break;
-	}
 
 	////
 	
 	// We are about to start execution from a new file so increase the include
 	// depth.
-	m_include_depth += 1;	
+	m_include_depth += 1;
+	t_file -> executing += 1;
 	
 	// Execute any statements
 	if (t_stat == PS_NORMAL && t_statements != nil)
@@ -472,11 +660,15 @@ bool MCServerScript::Include(MCExecPoint& outer_ep, const char *p_filename, bool
 
 			t_statement = t_statement -> getnext();
 		}
-
-		t_statements -> deletestatements(t_statements);
 	}
 	
+	// The statements are kept for the next include unless this was a reparse
+	// which couldn't replace the cached ones.
+	if (t_statements != nil && t_statements != t_file -> statements)
+		t_statements -> deletestatements(t_statements);
+	
 	// Reduce the include depth.
+	t_file -> executing -= 1;
 	m_include_depth -= 1;
 	
 	////
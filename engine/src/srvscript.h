@@ -26,6 +26,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #endif
 
 class MCStatement;
+class MCError;
 
 class MCServerScript: public MCStack
 {
@@ -38,6 +39,24 @@ public:
 	uint32_t GetIncludeDepth(void);
 	bool Include(MCExecPoint& context, const char *p_filename, bool p_require);
 
+	// Load and parse the given file without running it, so that a later
+	// include of it can use the cached statements.
+	bool Preload(const char *p_filename);
+
+	// Returns false if any file with a cached parse has changed on disk since
+	// it was parsed.
+	bool IsParseCacheCurrent(void);
+
+	// Forget which files have been included and reset the script's locals and
+	// execution context, ready to serve another request. The cached parses, and
+	// any handlers they defined, are kept.
+	void Reset(void);
+
+	// Fetch the number of includes served from the parse cache, the number
+	// which had to parse the file and the number of cached parses dropped
+	// because the file changed.
+	void GetParseCacheStats(uint32_t& r_hits, uint32_t& r_misses, uint32_t& r_invalidations);
+
 	uint4 GetFileIndexForContext(MCExecPoint& ep);
 	
 	const char *GetFileForContext(MCExecPoint& ep);
@@ -69,12 +88,44 @@ private:
 		// The underlying system file-handle for the file - this will be nil
 		// if we had to load the entire file, non-nil if mmapped.
 		MCSystemFileHandle *handle;
+
+		// The size and modification time of the file when it was loaded. The
+		// cached parse is only used while these still match the file on disk.
+		int64_t size;
+		uint32_t modification_time;
+
+		// True once the file has been parsed - 'statements' and 'errors' then
+		// hold the result, and are reused when the file is included again.
+		bool parsed;
+		MCStatement *statements;
+		MCError *errors;
+
+		// True if parsing the file added handlers to the script. Such a file
+		// cannot be reparsed as the handlers would be defined twice.
+		bool has_handlers;
+
+		// True once the file has been executed by an include.
+		bool included;
+
+		// The number of includes of the file currently executing.
+		uint32_t executing;
 	};
 	
 	// Locate the given file in the list of files, adding it if not present and
 	// 'add' is true.
 	File *FindFile(const char *p_filename, bool p_add);
 
+	// Map (or read) the file's contents into memory, recording its size and
+	// modification time.
+	bool LoadFile(File *p_file);
+
+	// Parse the whole of the file's script into a chain of statements,
+	// defining any handlers it contains.
+	Parse_stat ParseFile(File *p_file, MCStatement*& r_statements);
+
+	// Discard the file's contents and cached parse.
+	void UnloadFile(File *p_file);
+
 	// Return the next statement in the script point, processing any definitions
 	// that occur before it.
 	Parse_stat ParseNextStatement(MCScriptPoint& sp, MCStatement*& r_statement);
@@ -90,6 +141,11 @@ private:
 
 	// The execpoint in which global code is executed.
 	MCExecPoint *m_ep;
+
+	// Parse cache statistics.
+	uint32_t m_cache_hits;
+	uint32_t m_cache_misses;
+	uint32_t m_cache_invalidations;
 };
 
 #endif
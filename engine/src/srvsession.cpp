@@ -507,7 +507,7 @@ bool MCSessionCloseSession(MCSession *p_session, bool p_update)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-bool MCSessionStart(const char *p_session_id, MCSessionRef &r_session)
+static bool MCSessionIndexStart(const char *p_session_id, MCSessionRef &r_session)
 {
 	bool t_success = true;
 	
@@ -551,16 +551,17 @@ bool MCSessionStart(const char *p_session_id, MCSessionRef &r_session)
 	return t_success;
 }
 
-bool MCSessionCommit(MCSessionRef p_session)
+static bool MCSessionIndexCommit(MCSessionRef p_session)
 {
 	return MCSessionCloseSession(p_session, true);
 }
 
-void MCSessionDiscard(MCSessionRef p_session)
+static void MCSessionIndexDiscard(MCSessionRef p_session)
 {
 	MCSessionCloseSession(p_session, false);
 }
-bool MCSessionExpireSession(const char *p_id)
+
+static bool MCSessionIndexExpire(const char *p_id)
 {
 	bool t_success = true;
 	
@@ -588,12 +589,7 @@ bool MCSessionExpireCookie()
 	return MCServerSetCookie(t_name, t_value, MCS_time() - 60 * 60 * 24, t_path, t_domain, false, true);
 }
 
-bool MCSessionExpire(const char *p_id)
-{
-	return MCSessionExpireSession(p_id) && MCSessionExpireCookie();
-}
-
-bool MCSessionCleanup(void)
+static bool MCSessionIndexCleanup(void)
 {
 	bool t_success = true;
 	
@@ -690,4 +686,566 @@ bool MCSessionGenerateID(char *&r_id)
 void MCSessionRefreshExpireTime(MCSession *p_session)
 {
 	p_session->expires = MCS_time() + MCS_get_session_lifetime();
-}
\ No newline at end of file
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  The sharded session store keeps each session in its own file, so requests
+//  only ever contend for the lock on their own session. The file's location is
+//  derived from a hash of the session id and remote address:
+//
+//    <save path>/lcsessions/<h0>/<h1>/<hash>
+//
+//  where <h0> and <h1> are the first two hex digits of the hash, so lookup is a
+//  single open and the directories stay small. As the id comes from a cookie,
+//  hashing it also keeps it from ever being interpreted as a path.
+//
+//  Expiry is tracked by an index of buckets covering SESSION_EXPIRY_BUCKET
+//  seconds each: when a session is committed its file is appended to the
+//  bucket its expiry time falls in. Cleanup then only has to visit buckets
+//  which are entirely in the past, deleting any session in them which has not
+//  since been refreshed.
+//
+
+// session file format:
+// session id (string) + originating ip (string) + expires (real64) + session data (binary)
+
+#define SESSION_STORE_FOLDER "lcsessions"
+#define SESSION_EXPIRY_FOLDER "expiry"
+#define SESSION_EXPIRY_BUCKET 300
+
+// The sessions currently open in this process.
+static MCSession *s_sharded_open_sessions = NULL;
+
+static bool MCSessionShardedComputeFilename(const char *p_id, const char *p_ip, char *&r_filename)
+{
+	md5_state_t t_state;
+	md5_byte_t t_digest[16];
+	md5_init(&t_state);
+	md5_append(&t_state, (md5_byte_t *)p_ip, MCCStringLength(p_ip));
+	md5_append(&t_state, (md5_byte_t *)"\n", 1);
+	md5_append(&t_state, (md5_byte_t *)p_id, MCCStringLength(p_id));
+	md5_finish(&t_state, t_digest);
+	
+	bool t_success = true;
+	
+	char *t_hash = NULL;
+	t_success = byte_to_hex((uint8_t *)t_digest, 16, t_hash);
+	
+	if (t_success)
+		t_success = MCCStringFormat(r_filename, "%c/%c/%s", t_hash[0], t_hash[1], t_hash);
+	
+	MCMemoryDeleteArray(t_hash);
+	
+	return t_success;
+}
+
+// Create the given folder within the session store, and any of its parents.
+static void MCSessionShardedEnsureFolder(const char *p_folder)
+{
+	char *t_path = NULL;
+	if (!MCCStringFormat(t_path, "%s/%s/%s", MCS_get_session_save_path(), SESSION_STORE_FOLDER, p_folder))
+		return;
+	
+	uindex_t t_offset;
+	t_offset = MCCStringLength(MCS_get_session_save_path());
+	for (char *t_ptr = t_path + t_offset + 1; *t_ptr != '\0'; t_ptr++)
+		if (*t_ptr == '/')
+		{
+			*t_ptr = '\0';
+			MCsystem->CreateFolder(t_path);
+			*t_ptr = '/';
+		}
+	MCsystem->CreateFolder(t_path);
+	
+	MCCStringFree(t_path);
+}
+
+static MCSystemFileHandle *MCSessionShardedOpenFile(const char *p_filename, uint32_t p_mode)
+{
+	char *t_path = NULL;
+	if (!MCCStringFormat(t_path, "%s/%s/%s", MCS_get_session_save_path(), SESSION_STORE_FOLDER, p_filename))
+		return NULL;
+	
+	MCSystemFileHandle *t_file;
+	t_file = MCsystem->OpenFile(t_path, p_mode, false);
+	
+	// If we are creating the file, its folder may not exist yet.
+	if (t_file == NULL && p_mode != kMCSystemFileModeRead)
+	{
+		char *t_folder = NULL;
+		uindex_t t_separator;
+		if (MCCStringClone(p_filename, t_folder) && MCCStringLastIndexOf(t_folder, '/', t_separator))
+		{
+			t_folder[t_separator] = '\0';
+			MCSessionShardedEnsureFolder(t_folder);
+			t_file = MCsystem->OpenFile(t_path, p_mode, false);
+		}
+		MCCStringFree(t_folder);
+	}
+	
+	MCCStringFree(t_path);
+	
+	return t_file;
+}
+
+static bool MCSessionShardedDeleteFile(const char *p_filename)
+{
+	char *t_path = NULL;
+	if (!MCCStringFormat(t_path, "%s/%s/%s", MCS_get_session_save_path(), SESSION_STORE_FOLDER, p_filename))
+		return false;
+	
+	bool t_success;
+	t_success = MCsystem->DeleteFile(t_path);
+	
+	MCCStringFree(t_path);
+	
+	return t_success;
+}
+
+static bool MCSessionShardedFileExists(const char *p_filename)
+{
+	char *t_path = NULL;
+	if (!MCCStringFormat(t_path, "%s/%s/%s", MCS_get_session_save_path(), SESSION_STORE_FOLDER, p_filename))
+		return false;
+	
+	bool t_exists;
+	t_exists = MCsystem->FileExists(t_path);
+	
+	MCCStringFree(t_path);
+	
+	return t_exists;
+}
+
+// Read the header of a session file, returning false if it is not the header
+// of the given session.
+static bool MCSessionShardedReadHeader(MCSystemFileHandle *p_file, const char *p_id, const char *p_ip, real64_t &r_expires)
+{
+	char *t_id = NULL;
+	char *t_ip = NULL;
+	
+	bool t_success;
+	t_success = read_cstring(p_file, t_id) &&
+				read_cstring(p_file, t_ip) &&
+				read_real64(p_file, r_expires);
+	
+	if (t_success && p_id != NULL)
+		t_success = MCCStringEqual(t_id, p_id) && MCCStringEqual(t_ip, p_ip);
+	
+	MCMemoryDeallocate(t_id);
+	MCMemoryDeallocate(t_ip);
+	
+	return t_success;
+}
+
+static bool MCSessionShardedOpenSession(MCSession *p_session)
+{
+	// A cleanup could delete the file between us opening it and acquiring the
+	// lock, in which case we try again so as not to write to an unlinked file.
+	for (uint32_t t_attempt = 0; t_attempt < 3; t_attempt++)
+	{
+		p_session->filehandle = MCSessionShardedOpenFile(p_session->filename, kMCSystemFileModeUpdate);
+		if (p_session->filehandle == NULL)
+			return false;
+		
+		if (!MCSystemLockFile(p_session->filehandle, false, true))
+			return false;
+		
+		if (MCSessionShardedFileExists(p_session->filename))
+			break;
+		
+		p_session->filehandle->Close();
+		p_session->filehandle = NULL;
+	}
+	
+	if (p_session->filehandle == NULL)
+		return false;
+	
+	p_session->is_new = p_session->filehandle->GetFileSize() == 0;
+	
+	real64_t t_expires;
+	if (!p_session->is_new &&
+		MCSessionShardedReadHeader(p_session->filehandle, p_session->id, p_session->ip, t_expires) &&
+		t_expires > MCS_time())
+		return MCSessionReadSession(p_session);
+	
+	return true;
+}
+
+static bool MCSessionShardedIndexExpiry(MCSession *p_session)
+{
+	char *t_bucket = NULL;
+	if (!MCCStringFormat(t_bucket, "%s/%u", SESSION_EXPIRY_FOLDER, (uint32_t)(p_session->expires / SESSION_EXPIRY_BUCKET)))
+		return false;
+	
+	bool t_success = true;
+	
+	MCSystemFileHandle *t_file;
+	t_file = MCSessionShardedOpenFile(t_bucket, kMCSystemFileModeAppend);
+	t_success = t_file != NULL;
+	
+	// Each entry is written in a single append so concurrent writers don't
+	// interleave.
+	char *t_entry = NULL;
+	if (t_success)
+		t_success = MCCStringFormat(t_entry, "%s\n", p_session->filename);
+	
+	uint32_t t_written;
+	if (t_success)
+		t_success = t_file->Write(t_entry, MCCStringLength(t_entry), t_written) && t_file->Flush();
+	
+	if (t_file != NULL)
+		t_file->Close();
+	
+	MCCStringFree(t_entry);
+	MCCStringFree(t_bucket);
+	
+	return t_success;
+}
+
+static bool MCSessionShardedCloseSession(MCSession *p_session, bool p_update)
+{
+	bool t_success = true;
+	
+	// Remove from the list of open sessions.
+	for (MCSession **t_link = &s_sharded_open_sessions; *t_link != NULL; t_link = &(*t_link)->next_open)
+		if (*t_link == p_session)
+		{
+			*t_link = p_session->next_open;
+			break;
+		}
+	
+	if (p_session->expired)
+		p_update = false;
+	
+	if (p_session->filehandle != NULL)
+	{
+		if (p_update)
+		{
+			MCSessionRefreshExpireTime(p_session);
+			
+			t_success = p_session->filehandle->Seek(0, 1);
+			if (t_success)
+				t_success = write_cstring(p_session->filehandle, p_session->id) &&
+							write_cstring(p_session->filehandle, p_session->ip) &&
+							write_real64(p_session->filehandle, p_session->expires);
+			if (t_success)
+				t_success = MCSessionWriteSession(p_session);
+			if (t_success)
+				t_success = p_session->filehandle->Flush();
+			if (t_success)
+				t_success = p_session->filehandle->Truncate();
+		}
+		p_session->filehandle->Close();
+		
+		// Sessions which have been expired, or never got any content, have
+		// nothing in the expiry index to clean them up so are deleted now.
+		if (p_session->expired || (!p_update && p_session->is_new))
+			MCSessionShardedDeleteFile(p_session->filename);
+	}
+	
+	if (t_success && p_update)
+		t_success = MCSessionShardedIndexExpiry(p_session);
+	
+	MCSessionDisposeSession(p_session);
+	
+	return t_success;
+}
+
+static bool MCSessionShardedStart(const char *p_session_id, MCSessionRef &r_session)
+{
+	bool t_success = true;
+	
+	MCSession *t_session = NULL;
+	char *t_remote_addr;
+	t_remote_addr = MCS_getenv("REMOTE_ADDR");
+	
+	t_success = MCMemoryNew(t_session);
+	
+	if (t_success)
+		t_success = MCCStringClone(t_remote_addr ? t_remote_addr : "", t_session->ip);
+	
+	if (t_success)
+	{
+		if (p_session_id != NULL && p_session_id[0] != '\0')
+			t_success = MCCStringClone(p_session_id, t_session->id);
+		else
+			t_success = MCSessionGenerateID(t_session->id);
+	}
+	
+	if (t_success)
+		t_success = MCSessionShardedComputeFilename(t_session->id, t_session->ip, t_session->filename);
+	
+	if (t_success)
+		t_success = MCServerSetCookie(MCS_get_session_name(), t_session->id, 0, NULL, NULL, false, true);
+	
+	if (t_success)
+		t_success = MCSessionShardedOpenSession(t_session);
+	
+	if (t_success)
+	{
+		MCSessionRefreshExpireTime(t_session);
+		
+		t_session->next_open = s_sharded_open_sessions;
+		s_sharded_open_sessions = t_session;
+		
+		r_session = t_session;
+	}
+	else if (t_session != NULL)
+		MCSessionShardedCloseSession(t_session, false);
+	
+	return t_success;
+}
+
+static bool MCSessionShardedCommit(MCSessionRef p_session)
+{
+	return MCSessionShardedCloseSession(p_session, true);
+}
+
+static void MCSessionShardedDiscard(MCSessionRef p_session)
+{
+	MCSessionShardedCloseSession(p_session, false);
+}
+
+static bool MCSessionShardedExpire(const char *p_id)
+{
+	if (p_id == NULL)
+		return true;
+	
+	const char *t_remote_addr;
+	t_remote_addr = MCS_getenv("REMOTE_ADDR");
+	if (t_remote_addr == NULL)
+		t_remote_addr = "";
+	
+	// If the session is open in this process we can't take the lock on it, so
+	// just flag it to be deleted when it is closed.
+	for (MCSession *t_session = s_sharded_open_sessions; t_session != NULL; t_session = t_session->next_open)
+		if (MCCStringEqual(t_session->id, p_id) && MCCStringEqual(t_session->ip, t_remote_addr))
+		{
+			t_session->expired = true;
+			return true;
+		}
+	
+	char *t_filename = NULL;
+	if (!MCSessionShardedComputeFilename(p_id, t_remote_addr, t_filename))
+		return false;
+	
+	// Wait for any request using the session to finish before deleting it.
+	MCSystemFileHandle *t_file;
+	t_file = MCSessionShardedOpenFile(t_filename, kMCSystemFileModeRead);
+	if (t_file != NULL)
+	{
+		MCSystemLockFile(t_file, false, true);
+		t_file->Close();
+		MCSessionShardedDeleteFile(t_filename);
+	}
+	
+	MCCStringFree(t_filename);
+	
+	return true;
+}
+
+// Delete the session in the given file if it has expired and is not in use.
+static void MCSessionShardedCleanupSession(const char *p_filename, real64_t p_time)
+{
+	MCSystemFileHandle *t_file;
+	t_file = MCSessionShardedOpenFile(p_filename, kMCSystemFileModeRead);
+	if (t_file == NULL)
+		return;
+	
+	bool t_delete = false;
+	real64_t t_expires;
+	if (MCSystemLockFile(t_file, false, false) &&
+		(!MCSessionShardedReadHeader(t_file, NULL, NULL, t_expires) || t_expires <= p_time))
+		t_delete = true;
+	
+	// On POSIX deleting before closing means nobody can see the file between
+	// releasing the lock and it going; elsewhere the file must be closed first.
+#ifndef _WINDOWS_SERVER
+	if (t_delete)
+		MCSessionShardedDeleteFile(p_filename);
+	t_file->Close();
+#else
+	t_file->Close();
+	if (t_delete)
+		MCSessionShardedDeleteFile(p_filename);
+#endif
+}
+
+// Process all the sessions listed in the given expiry bucket file.
+static void MCSessionShardedCleanupBucket(const char *p_bucket, real64_t p_time)
+{
+	MCSystemFileHandle *t_file;
+	t_file = MCsystem->OpenFile(p_bucket, kMCSystemFileModeRead, false);
+	if (t_file == NULL)
+		return;
+	
+	char *t_entries = NULL;
+	uint32_t t_length;
+	t_length = (uint32_t)t_file->GetFileSize();
+	
+	uint32_t t_read = 0;
+	if (MCMemoryAllocate(t_length + 1, t_entries) && t_file->Read(t_entries, t_length, t_read))
+	{
+		t_entries[t_read] = '\0';
+		
+		char *t_entry = t_entries;
+		while (*t_entry != '\0')
+		{
+			char *t_end;
+			t_end = strchr(t_entry, '\n');
+			if (t_end == NULL)
+				break;
+			*t_end = '\0';
+			
+			MCSessionShardedCleanupSession(t_entry, p_time);
+			
+			t_entry = t_end + 1;
+		}
+	}
+	
+	MCMemoryDeallocate(t_entries);
+	t_file->Close();
+	
+	MCsystem->DeleteFile(p_bucket);
+}
+
+struct MCSessionShardedCleanupContext
+{
+	real64_t time;
+	uint32_t bucket;
+	char **buckets;
+	uint32_t bucket_count;
+};
+
+static bool MCSessionShardedCollectBucket(void *p_context, const MCSystemFolderEntry *p_entry)
+{
+	MCSessionShardedCleanupContext *t_context;
+	t_context = (MCSessionShardedCleanupContext *)p_context;
+	
+	if (p_entry->is_folder || !isdigit((uint1)p_entry->name[0]))
+		return true;
+	
+	if ((uint32_t)strtoul(p_entry->name, NULL, 10) >= t_context->bucket)
+		return true;
+	
+	if (!MCMemoryResizeArray(t_context->bucket_count + 1, t_context->buckets, t_context->bucket_count))
+		return false;
+	
+	return MCCStringClone(p_entry->name, t_context->buckets[t_context->bucket_count - 1]);
+}
+
+static bool MCSessionShardedCleanup(void)
+{
+	char *t_folder = NULL;
+	if (!MCCStringFormat(t_folder, "%s/%s/%s", MCS_get_session_save_path(), SESSION_STORE_FOLDER, SESSION_EXPIRY_FOLDER))
+		return false;
+	
+	MCSessionShardedCleanupContext t_context;
+	t_context.time = MCS_time();
+	t_context.bucket = (uint32_t)(t_context.time / SESSION_EXPIRY_BUCKET);
+	t_context.buckets = NULL;
+	t_context.bucket_count = 0;
+	
+	// Only buckets which are entirely in the past are visited, so sessions
+	// can't be added to a bucket while it is being cleaned. Two cleanups
+	// processing the same bucket is harmless - the session locks keep them
+	// apart and deleting is idempotent.
+	char *t_old_folder;
+	t_old_folder = MCsystem->GetCurrentFolder();
+	if (MCsystem->SetCurrentFolder(t_folder))
+		MCsystem->ListFolderEntries(MCSessionShardedCollectBucket, &t_context);
+	MCsystem->SetCurrentFolder(t_old_folder);
+	MCCStringFree(t_old_folder);
+	
+	for (uint32_t i = 0; i < t_context.bucket_count; i++)
+	{
+		char *t_path = NULL;
+		if (MCCStringFormat(t_path, "%s/%s", t_folder, t_context.buckets[i]))
+			MCSessionShardedCleanupBucket(t_path, t_context.time);
+		
+		MCCStringFree(t_path);
+		MCCStringFree(t_context.buckets[i]);
+	}
+	
+	MCMemoryDeleteArray(t_context.buckets);
+	MCCStringFree(t_folder);
+	
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A session store provides the persistence for session data. The store in use
+// is chosen by the SESSION_STORE_ENV_VAR environment variable: "index" selects
+// the original single index file store, otherwise the sharded store is used.
+
+#define SESSION_STORE_ENV_VAR "LIVECODE_SERVER_SESSION_STORE"
+
+struct MCSessionStore
+{
+	bool (*start)(const char *p_session_id, MCSessionRef &r_session);
+	bool (*commit)(MCSessionRef p_session);
+	void (*discard)(MCSessionRef p_session);
+	bool (*expire)(const char *p_id);
+	bool (*cleanup)(void);
+};
+
+static const MCSessionStore s_index_store =
+{
+	MCSessionIndexStart,
+	MCSessionIndexCommit,
+	MCSessionIndexDiscard,
+	MCSessionIndexExpire,
+	MCSessionIndexCleanup,
+};
+
+static const MCSessionStore s_sharded_store =
+{
+	MCSessionShardedStart,
+	MCSessionShardedCommit,
+	MCSessionShardedDiscard,
+	MCSessionShardedExpire,
+	MCSessionShardedCleanup,
+};
+
+static const MCSessionStore *MCSessionGetStore(void)
+{
+	static const MCSessionStore *s_store = NULL;
+	if (s_store == NULL)
+	{
+		const char *t_name;
+		t_name = MCS_getenv(SESSION_STORE_ENV_VAR);
+		if (t_name != NULL && MCCStringEqualCaseless(t_name, "index"))
+			s_store = &s_index_store;
+		else
+			s_store = &s_sharded_store;
+	}
+	
+	return s_store;
+}
+
+bool MCSessionStart(const char *p_session_id, MCSessionRef &r_session)
+{
+	return MCSessionGetStore()->start(p_session_id, r_session);
+}
+
+bool MCSessionCommit(MCSessionRef p_session)
+{
+	return MCSessionGetStore()->commit(p_session);
+}
+
+void MCSessionDiscard(MCSessionRef p_session)
+{
+	MCSessionGetStore()->discard(p_session);
+}
+
+bool MCSessionExpire(const char *p_id)
+{
+	return MCSessionGetStore()->expire(p_id) && MCSessionExpireCookie();
+}
+
+bool MCSessionCleanup(void)
+{
+	return MCSessionGetStore()->cleanup();
+}
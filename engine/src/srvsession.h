@@ -18,7 +18,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #define SRVSESSION_H
 
 // session
-typedef struct
+typedef struct mcsession_t
 {
 	char*		id;
 	char*		ip;
@@ -30,6 +30,13 @@ typedef struct
 	// session data
 	uint32_t	data_length;
 	char *		data;
+	
+	// sharded store state - whether the session's file was created by this
+	// request, whether it has been expired while open, and the linkage in the
+	// list of open sessions.
+	bool		is_new;
+	bool		expired;
+	struct mcsession_t *next_open;
 } MCSession, *MCSessionRef;
 
 bool MCSessionStart(const char *p_session_id, MCSessionRef &r_session);
@@ -623,6 +623,18 @@ struct MCWindowsSystem: public MCSystemInterface
 		return False;
 	}
 	
+	virtual bool GetFileInfo(const char *p_path, int64_t& r_size, uint32_t& r_modification_time)
+	{
+		struct _stati64 t_info;
+		if (_stati64(p_path, &t_info) != 0 || (t_info . st_mode & _S_IFDIR) != 0)
+			return false;
+		
+		r_size = t_info . st_size;
+		r_modification_time = (uint32_t)t_info . st_mtime;
+		
+		return true;
+	}
+	
 	virtual bool ChangePermissions(const char *p_path, uint2 p_mask)
 	{
 		return chmod(p_path, p_mask) == 0;
@@ -401,6 +401,7 @@ MCStack::~MCStack()
 	while (i < MCnusing)
 		if (MCusing[i] == this)
 		{
+			MCscriptepoch++;
 			MCnusing--;
 			uint2 j;
 			for (j = i ; j < MCnusing ; j++)
@@ -581,6 +582,7 @@ void MCStack::close()
 			stop_externals();
 			MCscreen->destroywindow(window);
 			window = DNULL;
+			MCscriptepoch++;
 			cursor = None;
 			delete titlestring;
 			titlestring = NULL;
@@ -590,7 +592,10 @@ void MCStack::close()
 	if (substacks == NULL)
 		MCObject::close();
 	else if (opened != 0)
+	{
 		opened--;
+		MCscriptepoch++;
+	}
 
 	// MW-2011-09-13: [[ Effects ]] Free any snapshot that we have.
 	MCscreen -> freepixmap(m_snapshot);
@@ -2182,6 +2187,9 @@ Exec_stat MCStack::setprop(uint4 parid, Properties which, MCExecPoint &ep, Boole
 					parent = stackptr;
 				}
 
+				// The stack's mainstack is part of its message path.
+				MCscriptepoch++;
+
 				// OK-2008-04-10 : Added parameters to mainstackChanged message to specify the new
 				// and old mainstack names.
 				message_with_args(MCM_main_stack_changed, t_old_stackptr -> getname(), stackptr -> getname());
@@ -2749,6 +2757,48 @@ Exec_stat MCStack::handle(Handler_type htype, MCNameRef message, MCParameter *pa
 	return stat;
 }
 
+bool MCStack::resolvehandler(Handler_type htype, MCNameRef message, MCObject *passing_object, MCObject*& r_owner, MCHandler*& r_handler)
+{
+	// If handling a message would realize the stack, the path can only be
+	// followed by sending it.
+	if (!opened)
+	{
+		if (window == DNULL && !MCNameIsEqualTo(message, MCM_start_up, kMCCompareCaseless)
+#ifdef _MACOSX
+		        && !(state & CS_DELETE_STACK))
+#else
+				&& externalfiles != NULL && !(state & CS_DELETE_STACK))
+#endif
+			return false;
+	}
+
+	// The dynamic path is never resolved in advance, so there is no need to
+	// check for it here.
+	if (!resolveself(htype, message, r_handler))
+		return false;
+
+	if (r_handler != nil)
+	{
+		r_owner = this;
+		return true;
+	}
+
+	// Externals can't be looked up without calling them.
+	if (m_externals != nil)
+		return false;
+
+	// This follows the same route to the dispatcher as 'handle'.
+	if (passing_object != nil && parent != NULL)
+	{
+		if (MCModeHasHomeStack() || parent != MCdispatcher -> gethome() || !MCdispatcher->ismainstack(this))
+			return parent -> resolvehandler(htype, message, this, r_owner, r_handler);
+		else if (parent->getparent() != NULL)
+			return parent -> getparent() -> resolvehandler(htype, message, this, r_owner, r_handler);
+	}
+
+	return true;
+}
+
 void MCStack::recompute()
 {
 	if (curcard != NULL)
@@ -2763,6 +2813,7 @@ void MCStack::loadexternals(void)
 		return;
 
 	m_externals = new MCExternalHandlerList;
+	MCscriptepoch++;
 
 	char *ename = strclone(externalfiles);
 	char *sptr = ename;
@@ -212,6 +212,7 @@ public:
 
 	virtual MCStack *getstack();
 	virtual Exec_stat handle(Handler_type, MCNameRef, MCParameter *, MCObject *pass_from);
+	virtual bool resolvehandler(Handler_type, MCNameRef, MCObject *pass_from, MCObject*& r_owner, MCHandler*& r_handler);
 	virtual void recompute();
 	
 	// MW-2011-09-20: [[ Collision ]] Compute shape of stack.
@@ -430,6 +430,7 @@ void MCStack::extraopen(bool p_force)
 			MCscreen->alloccolor(linkatts->visitedcolor);
 		}
 		opened--;
+		MCscriptepoch++;
 	}
 }
 
@@ -532,6 +533,7 @@ Boolean MCStack::takewindow(MCStack *sptr)
 	iconid = sptr->iconid;
 	sptr->stop_externals();
 	sptr->window = DNULL;
+	MCscriptepoch++;
 	
 	state = sptr->state;
 	state &= ~(CS_IGNORE_CLOSE | CS_NO_FOCUS | CS_DELETE_STACK);
@@ -1756,7 +1758,10 @@ Exec_stat MCStack::openrect(const MCRectangle &rel, Window_mode wm, MCStack *par
 		realize();
 
 	if (substacks != NULL)
+	{
 		opened++;
+		MCscriptepoch++;
+	}
 	else
 	{
 		MCObject::open();
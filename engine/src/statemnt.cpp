@@ -353,6 +353,10 @@ MCComref::MCComref(MCNameRef n)
 	/* UNCHECKED */ MCNameClone(n, name);
 	handler = nil;
 	params = NULL;
+	pathcache . object = nil;
+	pathcache . owner = nil;
+	pathcache . handler = nil;
+	pathcache . epoch = 0;
 	resolved = false;
 }
 
@@ -481,7 +485,7 @@ Exec_stat MCComref::exec(MCExecPoint &ep)
 		Boolean olddynamic = MCdynamicpath;
 		MCdynamicpath = MCdynamiccard != NULL;
 		if (stat == ES_PASS || stat == ES_NOT_HANDLED)
-			switch (stat = p->handle(HT_MESSAGE, name, params, p))
+			switch (stat = p -> handlecached(pathcache, HT_MESSAGE, name, params))
 			{
 			case ES_ERROR:
 			case ES_NOT_FOUND:
@@ -72,6 +72,7 @@ class MCComref : public MCStatement
 	MCNameRef name;
 		MCHandler *handler;
 	MCParameter *params;
+	MCHandlerPathCache pathcache;
 	bool resolved : 1;
 public:
 	MCComref(MCNameRef n);
@@ -80,6 +80,10 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #define MCSSL
 
+#if defined(_LINUX_SERVER)
+#define FEATURE_FASTCGI
+#endif
+
 #elif defined(_IOS_MOBILE)
 
 #define __MACROMAN__
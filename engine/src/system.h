@@ -116,6 +116,10 @@ struct MCSystemInterface
 	virtual bool FolderExists(const char *p_path) = 0;
 	virtual bool FileNotAccessible(const char *p_path) = 0;
 	
+	// Fetch the size and modification time of the given file, returning false
+	// if it cannot be found.
+	virtual bool GetFileInfo(const char *p_path, int64_t& r_size, uint32_t& r_modification_time) = 0;
+	
 	virtual bool ChangePermissions(const char *p_path, uint2 p_mask) = 0;
 	virtual uint2 UMask(uint2 p_mask) = 0;
 	
@@ -29,6 +29,12 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "tilecache.h"
 #include "region.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#define TILECACHE_SSE2
+#include <emmintrin.h>
+extern bool surface_has_sse2(void);
+#endif
+
 #ifdef _HAS_QSORT_R
 #define stdc_qsort(a, b, c, d, e) qsort_r(a, b, c, e, d)
 #elif defined(_HAS_QSORT_S)
@@ -836,29 +842,71 @@ static void MCTileCacheFlushTile(MCTileCacheRef self, uint32_t p_index, bool p_p
 		MCTileCacheTileListPush(self, self -> empty_tiles, p_index);
 }
 
-static void MCTileCacheCopyTileBits(int32_t p_size, uint32_t *p_dst_ptr, const uint32_t *p_src_ptr, uint32_t p_src_advance, uint32_t& r_or_mask, uint32_t& r_and_mask)
+// Compute the or and and of all the pixels in the tile at p_src_ptr, reading
+// in place so constant tiles never need to be copied.
+static void MCTileCacheComputeTileMasks(int32_t p_size, const uint32_t *p_src_ptr, uint32_t p_src_stride, uint32_t& r_or_mask, uint32_t& r_and_mask)
 {
 	uint32_t t_or_mask, t_and_mask;
 	t_or_mask = 0;
 	t_and_mask = 0xffffffff;
-	for(uint32_t y = p_size; y > 0; y--)
+
+	int32_t t_vector_width;
+	t_vector_width = 0;
+
+#ifdef TILECACHE_SSE2
+	if (surface_has_sse2())
 	{
-		for(uint32_t x = p_size; x > 0; x--)
+		t_vector_width = p_size & ~3;
+
+		__m128i t_or_vec, t_and_vec;
+		t_or_vec = _mm_setzero_si128();
+		t_and_vec = _mm_set1_epi32(-1);
+		for(int32_t y = 0; y < p_size; y++)
 		{
-			uint32_t t_pixel;
-			t_pixel = *p_src_ptr++;
-			*p_dst_ptr++ = t_pixel;
-			t_or_mask |= t_pixel;
-			t_and_mask &= t_pixel;
+			const uint32_t *t_row;
+			t_row = p_src_ptr + y * p_src_stride;
+			for(int32_t x = 0; x < t_vector_width; x += 4)
+			{
+				__m128i t_pixels;
+				t_pixels = _mm_loadu_si128((const __m128i *)(t_row + x));
+				t_or_vec = _mm_or_si128(t_or_vec, t_pixels);
+				t_and_vec = _mm_and_si128(t_and_vec, t_pixels);
+			}
 		}
-		
-		p_src_ptr += p_src_advance;
+
+		// Fold the four lanes together.
+		t_or_vec = _mm_or_si128(t_or_vec, _mm_shuffle_epi32(t_or_vec, _MM_SHUFFLE(1, 0, 3, 2)));
+		t_or_vec = _mm_or_si128(t_or_vec, _mm_shuffle_epi32(t_or_vec, _MM_SHUFFLE(2, 3, 0, 1)));
+		t_and_vec = _mm_and_si128(t_and_vec, _mm_shuffle_epi32(t_and_vec, _MM_SHUFFLE(1, 0, 3, 2)));
+		t_and_vec = _mm_and_si128(t_and_vec, _mm_shuffle_epi32(t_and_vec, _MM_SHUFFLE(2, 3, 0, 1)));
+		t_or_mask = (uint32_t)_mm_cvtsi128_si32(t_or_vec);
+		t_and_mask = (uint32_t)_mm_cvtsi128_si32(t_and_vec);
 	}
-	
+#endif
+
+	// Any columns the vector loop didn't cover.
+	if (t_vector_width != p_size)
+		for(int32_t y = 0; y < p_size; y++)
+		{
+			const uint32_t *t_row;
+			t_row = p_src_ptr + y * p_src_stride;
+			for(int32_t x = t_vector_width; x < p_size; x++)
+			{
+				t_or_mask |= t_row[x];
+				t_and_mask &= t_row[x];
+			}
+		}
+
 	r_or_mask = t_or_mask;
 	r_and_mask = t_and_mask;
 }
 
+static void MCTileCacheCopyTileBits(int32_t p_size, uint32_t *p_dst_ptr, const uint32_t *p_src_ptr, uint32_t p_src_stride)
+{
+	for(int32_t y = 0; y < p_size; y++)
+		memcpy(p_dst_ptr + y * p_size, p_src_ptr + y * p_src_stride, p_size * sizeof(uint32_t));
+}
+
 static bool MCTileCacheEnsureTile(MCTileCacheRef self)
 {
 	// Make sure we have room in the cache.
@@ -899,44 +947,12 @@ static void MCTileCacheFillTile(MCTileCacheRef self, uint32_t p_index, MCContext
 	t_src_bits = (uint32_t *)t_bitmap -> data + p_y * self -> tile_size * t_src_stride + p_x * self -> tile_size;
 
 	// First thing to do is to do the opacity and constancy check as if the
-	// tile is transparent, or constant we don't need to do anything. To avoid
-	// copying unless absolutely necessary, we check the stride of the context.
-	void *t_tile_ptr;
-	uint32_t t_tile_stride;
+	// tile is transparent, or constant we don't need to do anything. The check
+	// reads the context directly so that only tiles which are actually kept
+	// are copied.
 	uint32_t t_and_bits, t_or_bits;
-	if (t_src_stride != self -> tile_size)
-	{
-		// Allocate the temporary tile, if it isn't already there.
-		if (self -> temporary_tile == nil &&
-			!MCMemoryAllocate(self -> tile_size * self -> tile_size * sizeof(uint32_t), self -> temporary_tile))
-		{
-			MCTileCacheInvalidate(self);
-			return;
-		}
-		
-		// Copy the tile from the context into the temporary buffer,
-		// accumulating a running total of the alpha byte as we go.
-		// (might be quicker to a running and/or instead...)
-		MCTileCacheCopyTileBits(self -> tile_size, (uint32_t *)self -> temporary_tile, t_src_bits, t_src_stride - self -> tile_size, t_or_bits, t_and_bits); 
-			
-		// Make sure we use the temporary copy (faster path in compositor as
-		// stride is tile size).
-		t_tile_ptr = self -> temporary_tile;
-		t_tile_stride = self -> tile_size * sizeof(uint32_t);
-	}
-	else
-	{
-		// Just compute or/and masks (no need to copy).
-		t_and_bits = 0xffffffff;
-		t_or_bits = 0;
-		for(uint32_t i = 0; i < t_src_stride * self -> tile_size; i++)
-			t_and_bits &= t_src_bits[i], t_or_bits |= t_src_bits[i];
-	
-		// Use direct access to context back-buffer.
-		t_tile_ptr = (void *)t_src_bits;
-		t_tile_stride = t_bitmap -> bytes_per_line;
-	}
-	
+	MCTileCacheComputeTileMasks(self -> tile_size, t_src_bits, t_src_stride, t_or_bits, t_and_bits);
+
 	// The tile is constant if the or bits are the same as the and bits.
 	// The tile is opaque if the top byte of the and bits is 255.
 	// The tile is transparent if the top byte of the or bits is 0.
@@ -960,6 +976,33 @@ static void MCTileCacheFillTile(MCTileCacheRef self, uint32_t p_index, MCContext
 		t_tile -> constant = 0;
 		t_tile -> alpha = (t_and_bits >> 24) == 255 ? 255 : 127;
 		
+		// If the context is wider than a tile, copy the tile into the
+		// temporary buffer (faster path in compositor as stride is tile size),
+		// otherwise use direct access to the context back-buffer.
+		void *t_tile_ptr;
+		uint32_t t_tile_stride;
+		if (t_src_stride != self -> tile_size)
+		{
+			// Allocate the temporary tile, if it isn't already there.
+			if (self -> temporary_tile == nil &&
+				!MCMemoryAllocate(self -> tile_size * self -> tile_size * sizeof(uint32_t), self -> temporary_tile))
+			{
+				MCTileCacheInvalidate(self);
+				p_context -> unlock(t_bitmap);
+				return;
+			}
+
+			MCTileCacheCopyTileBits(self -> tile_size, (uint32_t *)self -> temporary_tile, t_src_bits, t_src_stride);
+
+			t_tile_ptr = self -> temporary_tile;
+			t_tile_stride = self -> tile_size * sizeof(uint32_t);
+		}
+		else
+		{
+			t_tile_ptr = (void *)t_src_bits;
+			t_tile_stride = t_bitmap -> bytes_per_line;
+		}
+
 		// Ask the compositor to allocate the tile.
 		if (self -> compositor . allocate_tile != nil &&
 			self -> compositor . allocate_tile(self -> compositor . context, self -> tile_size, t_tile_ptr, t_tile_stride, t_tile -> data))
@@ -185,8 +185,14 @@ MCMovingList::~MCMovingList()
 MCUIDC::MCUIDC()
 {
 	messageid = 0;
-	nmessages = maxmessages = 0;
+	timers = NULL;
+	ntimers = maxtimers = 0;
 	messages = NULL;
+	nmessages = maxmessages = 0;
+	messageids = NULL;
+	messageobjects = NULL;
+	nmessagebuckets = 0;
+	messagesequence = 0;
 	moving = NULL;
 	ncolors = 0;
 	colors = NULL;
@@ -199,9 +205,14 @@ MCUIDC::MCUIDC()
 
 MCUIDC::~MCUIDC()
 {
+	while (ntimers != 0)
+		cancelmessage(timers[0]);
 	while (nmessages != 0)
-		cancelmessageindex(0, True);
+		cancelmessage(messages[0]);
+	delete timers;
 	delete messages;
+	delete[] messageids;
+	delete[] messageobjects;
 }
 
 
@@ -677,15 +688,6 @@ Boolean MCUIDC::getmouseclick(uint2 button, Boolean& r_abort)
 
 void MCUIDC::delaymessage(MCObject *optr, MCNameRef mptr, char *p1, char *p2)
 {
-	if (nmessages == maxmessages)
-	{
-		maxmessages++;
-		MCU_realloc((char **)&messages, nmessages, maxmessages, sizeof(MCMessageList));
-	}
-	messages[nmessages].object = optr;
-	/* UNCHECKED */ MCNameClone(mptr, messages[nmessages].message);
-	messages[nmessages].time = MCS_time();
-	messages[nmessages].id = ++messageid;
 	MCParameter *params = NULL;
 	if (p1 != NULL)
 	{
@@ -697,25 +699,16 @@ void MCUIDC::delaymessage(MCObject *optr, MCNameRef mptr, char *p1, char *p2)
 			params->getnext()->setbuffer(p2, strlen(p2));
 		}
 	}
-	messages[nmessages++].params = params;
+	newmessage(optr, mptr, MCS_time(), params, ++messageid);
 }
 
 void MCUIDC::addmessage(MCObject *optr, MCNameRef mptr, real8 time, MCParameter *params)
 {
-	if (nmessages == maxmessages)
-	{
-		maxmessages++;
-		MCU_realloc((char **)&messages, nmessages,
-		            maxmessages, sizeof(MCMessageList));
-	}
-	messages[nmessages].object = optr;
-	/* UNCHECKED */ MCNameClone(mptr, messages[nmessages].message);
-	messages[nmessages].time = time;
-	messages[nmessages].id = ++messageid;
+	MCMessageList *t_msg;
+	t_msg = newmessage(optr, mptr, time, params, ++messageid);
 	char buffer[U4L];
-	sprintf(buffer, "%u", messages[nmessages].id);
+	sprintf(buffer, "%u", t_msg -> id);
 	MCresult->copysvalue(buffer);
-	messages[nmessages++].params = params;
 }
 
 Boolean MCUIDC::wait(real8 duration, Boolean dispatch, Boolean anyevent)
@@ -810,134 +803,354 @@ void MCUIDC::updatemenubar(Boolean force)
 	}
 };
 
+// Pending messages are held in binary min-heaps ordered on time, with ties
+// broken by the order they were queued in so that messages due at the same
+// time are still dispatched first-in first-out. Each message is also chained
+// into a hash index by id and one by object so that cancelling doesn't require
+// a search of the queue.
+
+static inline bool message_before(MCMessageList *p_left, MCMessageList *p_right)
+{
+	if (p_left -> time != p_right -> time)
+		return p_left -> time < p_right -> time;
+	return (int32_t)(p_left -> sequence - p_right -> sequence) < 0;
+}
+
+static void message_siftup(MCMessageList **p_heap, uint4 p_index)
+{
+	MCMessageList *t_msg;
+	t_msg = p_heap[p_index];
+	while (p_index > 0)
+	{
+		uint4 t_parent;
+		t_parent = (p_index - 1) / 2;
+		if (!message_before(t_msg, p_heap[t_parent]))
+			break;
+		p_heap[p_index] = p_heap[t_parent];
+		p_heap[p_index] -> index = p_index;
+		p_index = t_parent;
+	}
+	p_heap[p_index] = t_msg;
+	t_msg -> index = p_index;
+}
+
+static void message_siftdown(MCMessageList **p_heap, uint4 p_count, uint4 p_index)
+{
+	MCMessageList *t_msg;
+	t_msg = p_heap[p_index];
+	for(;;)
+	{
+		uint4 t_child;
+		t_child = p_index * 2 + 1;
+		if (t_child >= p_count)
+			break;
+		if (t_child + 1 < p_count && message_before(p_heap[t_child + 1], p_heap[t_child]))
+			t_child += 1;
+		if (!message_before(p_heap[t_child], t_msg))
+			break;
+		p_heap[p_index] = p_heap[t_child];
+		p_heap[p_index] -> index = p_index;
+		p_index = t_child;
+	}
+	p_heap[p_index] = t_msg;
+	t_msg -> index = p_index;
+}
+
+static inline uint4 message_object_hash(MCObject *p_object)
+{
+	uint4 t_hash;
+	t_hash = (uint4)((uintptr_t)p_object >> 3) * 2654435761U;
+	return t_hash ^ (t_hash >> 16);
+}
+
+static int message_compare_sequence(const void *p_left, const void *p_right)
+{
+	MCMessageList *t_left, *t_right;
+	t_left = *(MCMessageList **)p_left;
+	t_right = *(MCMessageList **)p_right;
+	return (int32_t)(t_left -> sequence - t_right -> sequence);
+}
+
+MCMessageList *MCUIDC::newmessage(MCObject *optr, MCNameRef mptr, real8 time, MCParameter *params, uint4 id)
+{
+	MCMessageList *t_msg;
+	t_msg = new MCMessageList;
+	t_msg -> object = optr;
+	/* UNCHECKED */ MCNameClone(mptr, t_msg -> message);
+	t_msg -> time = time;
+	t_msg -> params = params;
+	t_msg -> id = id;
+	t_msg -> sequence = messagesequence++;
+	queuemessage(t_msg);
+	return t_msg;
+}
+
+void MCUIDC::rehashmessages(void)
+{
+	uint4 t_new_count;
+	if (nmessagebuckets == 0)
+		t_new_count = 64;
+	else
+		t_new_count = nmessagebuckets * 2;
+
+	delete[] messageids;
+	delete[] messageobjects;
+	messageids = new MCMessageList *[t_new_count];
+	messageobjects = new MCMessageList *[t_new_count];
+	memset(messageids, 0, sizeof(MCMessageList *) * t_new_count);
+	memset(messageobjects, 0, sizeof(MCMessageList *) * t_new_count);
+	nmessagebuckets = t_new_count;
+
+	// Every message is in one of the heaps, so rebuild the chains from those.
+	for(uint4 i = 0; i < ntimers; i++)
+	{
+		uint4 t_bucket;
+		t_bucket = message_object_hash(timers[i] -> object) & (nmessagebuckets - 1);
+		timers[i] -> id_next = NULL;
+		timers[i] -> object_next = messageobjects[t_bucket];
+		messageobjects[t_bucket] = timers[i];
+	}
+	for(uint4 i = 0; i < nmessages; i++)
+	{
+		uint4 t_bucket;
+		t_bucket = messages[i] -> id & (nmessagebuckets - 1);
+		messages[i] -> id_next = messageids[t_bucket];
+		messageids[t_bucket] = messages[i];
+		t_bucket = message_object_hash(messages[i] -> object) & (nmessagebuckets - 1);
+		messages[i] -> object_next = messageobjects[t_bucket];
+		messageobjects[t_bucket] = messages[i];
+	}
+}
+
+void MCUIDC::queuemessage(MCMessageList *msg)
+{
+	// Keep the load factor of the indices at most one.
+	if (ntimers + nmessages >= nmessagebuckets)
+		rehashmessages();
+
+	MCMessageList **&t_heap = msg -> id == 0 ? timers : messages;
+	uint4 &t_count = msg -> id == 0 ? ntimers : nmessages;
+	uint4 &t_max = msg -> id == 0 ? maxtimers : maxmessages;
+	if (t_count == t_max)
+	{
+		uint4 t_new_max;
+		t_new_max = t_max == 0 ? 16 : t_max * 2;
+		MCU_realloc((char **)&t_heap, t_count, t_new_max, sizeof(MCMessageList *));
+		t_max = t_new_max;
+	}
+	t_heap[t_count] = msg;
+	message_siftup(t_heap, t_count++);
+
+	uint4 t_bucket;
+	if (msg -> id != 0)
+	{
+		t_bucket = msg -> id & (nmessagebuckets - 1);
+		msg -> id_next = messageids[t_bucket];
+		messageids[t_bucket] = msg;
+	}
+	else
+		msg -> id_next = NULL;
+
+	t_bucket = message_object_hash(msg -> object) & (nmessagebuckets - 1);
+	msg -> object_next = messageobjects[t_bucket];
+	messageobjects[t_bucket] = msg;
+}
+
+void MCUIDC::dequeuemessage(MCMessageList *msg)
+{
+	MCMessageList **t_link;
+	if (msg -> id != 0)
+	{
+		for(t_link = &messageids[msg -> id & (nmessagebuckets - 1)]; *t_link != msg; t_link = &(*t_link) -> id_next)
+			;
+		*t_link = msg -> id_next;
+	}
+	for(t_link = &messageobjects[message_object_hash(msg -> object) & (nmessagebuckets - 1)]; *t_link != msg; t_link = &(*t_link) -> object_next)
+		;
+	*t_link = msg -> object_next;
+
+	// Move the last entry of the heap into the hole and restore the ordering.
+	MCMessageList **t_heap;
+	uint4 *t_count;
+	t_heap = msg -> id == 0 ? timers : messages;
+	t_count = msg -> id == 0 ? &ntimers : &nmessages;
+	MCMessageList *t_last;
+	t_last = t_heap[--(*t_count)];
+	if (t_last != msg)
+	{
+		uint4 t_index;
+		t_index = msg -> index;
+		t_heap[t_index] = t_last;
+		t_last -> index = t_index;
+		message_siftup(t_heap, t_index);
+		message_siftdown(t_heap, *t_count, t_last -> index);
+	}
+}
+
+void MCUIDC::requeuemessage(MCMessageList *msg)
+{
+	MCMessageList **t_heap;
+	uint4 t_count;
+	t_heap = msg -> id == 0 ? timers : messages;
+	t_count = msg -> id == 0 ? ntimers : nmessages;
+	message_siftup(t_heap, msg -> index);
+	message_siftdown(t_heap, t_count, msg -> index);
+}
+
+MCMessageList *MCUIDC::nextmessage(Boolean dispatch)
+{
+	MCMessageList *t_timer;
+	t_timer = ntimers != 0 ? timers[0] : NULL;
+	if (!dispatch || nmessages == 0)
+		return t_timer;
+	if (t_timer == NULL || message_before(messages[0], t_timer))
+		return messages[0];
+	return t_timer;
+}
+
 void MCUIDC::addtimer(MCObject *optr, MCNameRef mptr, uint4 delay)
 {
-	uint2 i;
-	for (i = 0 ; i < nmessages ; i++)
-		if (messages[i].object == optr && MCNameIsEqualTo(messages[i].message, mptr, kMCCompareCaseless))
-		{
-			messages[i].time = MCS_time() + delay / 1000.0;
-			return;
-		}
-	if (nmessages == maxmessages)
+	// If the object already has a pending message of the same name, reset its
+	// time rather than queueing another - if there are several, the one queued
+	// first is used.
+	MCMessageList *t_existing;
+	t_existing = NULL;
+	if (nmessagebuckets != 0)
+		for(MCMessageList *t_msg = messageobjects[message_object_hash(optr) & (nmessagebuckets - 1)]; t_msg != NULL; t_msg = t_msg -> object_next)
+			if (t_msg -> object == optr && MCNameIsEqualTo(t_msg -> message, mptr, kMCCompareCaseless)
+			        && (t_existing == NULL || (int32_t)(t_msg -> sequence - t_existing -> sequence) < 0))
+				t_existing = t_msg;
+
+	if (t_existing != NULL)
 	{
-		maxmessages++;
-		MCU_realloc((char **)&messages, nmessages,
-		            maxmessages, sizeof(MCMessageList));
+		t_existing -> time = MCS_time() + delay / 1000.0;
+		requeuemessage(t_existing);
+		return;
 	}
-	messages[nmessages].object = optr;
-	/* UNCHECKED */ MCNameClone(mptr, messages[nmessages].message);
-	messages[nmessages].time = MCS_time() + delay / 1000.0;
-	messages[nmessages].id = 0;
-	messages[nmessages++].params = NULL;
+
+	newmessage(optr, mptr, MCS_time() + delay / 1000.0, NULL, 0);
 }
 
-void MCUIDC::cancelmessageindex(uint2 i, Boolean dodelete)
+void MCUIDC::cancelmessage(MCMessageList *msg)
 {
-	if (dodelete)
+	dequeuemessage(msg);
+	while (msg->params != NULL)
 	{
-		while (messages[i].params != NULL)
-		{
-			MCParameter *tmp = messages[i].params;
-			messages[i].params = messages[i].params->getnext();
-			delete tmp;
-		}
-		MCNameDelete(messages[i] . message);
+		MCParameter *tmp = msg->params;
+		msg->params = msg->params->getnext();
+		delete tmp;
 	}
-	nmessages--;
-	while (i++ < nmessages)
-		messages[i - 1] = messages[i];
+	MCNameDelete(msg -> message);
+	delete msg;
 }
 
 void MCUIDC::cancelmessageid(uint4 id)
 {
-	uint2 i;
-	for (i = 0 ; i < nmessages ; i++)
-		if (messages[i].id == id)
+	if (id == 0 || nmessagebuckets == 0)
+		return;
+	for(MCMessageList *t_msg = messageids[id & (nmessagebuckets - 1)]; t_msg != NULL; t_msg = t_msg -> id_next)
+		if (t_msg -> id == id)
 		{
-			cancelmessageindex(i, True);
+			cancelmessage(t_msg);
 			return;
 		}
 }
 
 void MCUIDC::cancelmessageobject(MCObject *optr, MCNameRef mptr)
 {
-	uint2 i;
-	for (i = 0 ; i < nmessages ; i++)
-		if (messages[i].object == optr
-		        && (mptr == NULL || MCNameIsEqualTo(messages[i].message, mptr, kMCCompareCaseless)))
-			cancelmessageindex(i--, True);
+	if (nmessagebuckets == 0)
+		return;
+	MCMessageList *t_msg;
+	t_msg = messageobjects[message_object_hash(optr) & (nmessagebuckets - 1)];
+	while (t_msg != NULL)
+	{
+		MCMessageList *t_next;
+		t_next = t_msg -> object_next;
+		if (t_msg->object == optr
+		        && (mptr == NULL || MCNameIsEqualTo(t_msg->message, mptr, kMCCompareCaseless)))
+			cancelmessage(t_msg);
+		t_msg = t_next;
+	}
+}
+
+void MCUIDC::cancelmessages(void)
+{
+	while (nmessages != 0)
+		cancelmessage(messages[0]);
 }
 
 void MCUIDC::listmessages(MCExecPoint &ep)
 {
-	uint2 i;
 	MCExecPoint ep1(ep);
 	bool first;
 	first = true;
 	ep.clear();
-	for (i = 0 ; i < nmessages ; i++)
+	if (nmessages == 0)
+		return;
+
+	// The heap isn't in any useful order, so list the messages in the order
+	// they were sent.
+	MCMessageList **t_list;
+	t_list = new MCMessageList *[nmessages];
+	memcpy(t_list, messages, sizeof(MCMessageList *) * nmessages);
+	qsort(t_list, nmessages, sizeof(MCMessageList *), message_compare_sequence);
+	for (uint4 i = 0 ; i < nmessages ; i++)
 	{
-		if (messages[i].id != 0)
-		{
-			ep.concatuint(messages[i].id, EC_RETURN, first);
-			ep.concatreal(messages[i].time, EC_COMMA, false);
-			ep.concatnameref(messages[i].message, EC_COMMA, false);
-			messages[i].object->getprop(0, P_LONG_ID, ep1, false);
-			ep.concatmcstring(ep1.getsvalue(), EC_COMMA, false);
-			first = false;
-		}
+		ep.concatuint(t_list[i]->id, EC_RETURN, first);
+		ep.concatreal(t_list[i]->time, EC_COMMA, false);
+		ep.concatnameref(t_list[i]->message, EC_COMMA, false);
+		t_list[i]->object->getprop(0, P_LONG_ID, ep1, false);
+		ep.concatmcstring(ep1.getsvalue(), EC_COMMA, false);
+		first = false;
 	}
+	delete[] t_list;
 }
 
 Boolean MCUIDC::handlepending(real8 &curtime, real8 &eventtime,
                               Boolean dispatch)
 {
 	Boolean doneone = False;
-	uint2 mdone = 0;
-	while (nmessages > mdone)
+	uint4 mdone = 0;
+	while (ntimers + nmessages > mdone)
 	{
-		int2 minindex = -1;
-		uint2 i;
-		for (i = 0 ; i < nmessages ; i++)
-			if ((dispatch || messages[i].id == 0)
-			        && (minindex == -1 || messages[i].time < messages[minindex].time))
-				minindex = i;
-		if (minindex == -1)
+		// When not dispatching, only engine timers are considered.
+		MCMessageList *t_msg;
+		t_msg = nextmessage(dispatch);
+		if (t_msg == NULL)
 			break;
-		if (curtime < messages[minindex].time)
+		if (curtime < t_msg->time)
 		{
-			if (eventtime > messages[minindex].time
-			        && (dispatch || messages[minindex].id == 0))
-				eventtime = messages[minindex].time;
+			if (eventtime > t_msg->time)
+				eventtime = t_msg->time;
 			break;
 		}
-		if (dispatch || messages[minindex].id == 0)
+		mdone++;
+		if (!dispatch && MCNameIsEqualTo(t_msg->message, MCM_idle, kMCCompareCaseless))
 		{
-			mdone++;
-			if (!dispatch && MCNameIsEqualTo(messages[minindex].message, MCM_idle, kMCCompareCaseless))
-				messages[minindex].time = curtime + ((real8)MCidleRate / 1000.0);
-			else
+			t_msg->time = curtime + ((real8)MCidleRate / 1000.0);
+			requeuemessage(t_msg);
+		}
+		else
+		{
+			doneone = True;
+			MCParameter *p = t_msg->params;
+			MCNameRef m = t_msg->message;
+			MCObject *o = t_msg->object;
+			dequeuemessage(t_msg);
+			delete t_msg;
+			MCSaveprops sp;
+			MCU_saveprops(sp);
+			MCU_resetprops(False);
+			o->timer(m, p);
+			MCU_restoreprops(sp);
+			while (p != NULL)
 			{
-				doneone = True;
-				MCParameter *p = messages[minindex].params;
-				MCNameRef m = messages[minindex].message;
-				MCObject *o = messages[minindex].object;
-				cancelmessageindex(minindex, False);
-				MCSaveprops sp;
-				MCU_saveprops(sp);
-				MCU_resetprops(False);
-				o->timer(m, p);
-				MCU_restoreprops(sp);
-				while (p != NULL)
-				{
-					MCParameter *tmp = p;
-					p = p->getnext();
-					delete tmp;
-				}
-				MCNameDelete(m);
-				curtime = MCS_time();
+				MCParameter *tmp = p;
+				p = p->getnext();
+				delete tmp;
 			}
+			MCNameDelete(m);
+			curtime = MCS_time();
 		}
 	}
 	if (moving != NULL)
@@ -949,9 +1162,10 @@ Boolean MCUIDC::handlepending(real8 &curtime, real8 &eventtime,
 	//   time of the next message to process in the queue.
 	if (doneone)
 	{
-		for(uint32_t i = 0; i < nmessages; i++)
-			if (eventtime > messages[i] . time)
-				eventtime = messages[i] . time;
+		if (ntimers != 0 && eventtime > timers[0] -> time)
+			eventtime = timers[0] -> time;
+		if (nmessages != 0 && eventtime > messages[0] -> time)
+			eventtime = messages[0] -> time;
 	}
 	return doneone;
 }
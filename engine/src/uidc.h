@@ -99,15 +99,25 @@ enum Transfer_mode {
     TRM_DRAGDROP
 };
 
-typedef struct
+// A pending message - script messages (sent 'in' a time) have a non-zero id,
+// engine timers have an id of 0.
+struct MCMessageList
 {
 	MCObject *object;
 	MCNameRef message;
 	real8 time;
 	MCParameter *params;
 	uint4 id;
-}
-MCMessageList;
+
+	// The order the message was queued in - messages due at the same time
+	// are dispatched in this order.
+	uint4 sequence;
+	// The message's position in its queue's heap.
+	uint4 index;
+	// The chains of the id and object indices.
+	MCMessageList *id_next;
+	MCMessageList *object_next;
+};
 
 struct MCDisplay
 {
@@ -233,11 +243,22 @@ enum MCPlatformFeature
 class MCUIDC
 {
 protected:
-	MCMessageList *messages;
+	// Pending messages are kept in two binary min-heaps ordered by time - one
+	// for engine timers, which are serviced even when not dispatching, and one
+	// for script messages. Both are indexed by id and by object, so finding a
+	// message to cancel doesn't need a search.
+	MCMessageList **timers;
+	uint4 ntimers;
+	uint4 maxtimers;
+	MCMessageList **messages;
+	uint4 nmessages;
+	uint4 maxmessages;
+	MCMessageList **messageids;
+	MCMessageList **messageobjects;
+	uint4 nmessagebuckets;
+	uint4 messagesequence;
 	MCMovingList *moving;
 	uint4 messageid;
-	uint2 nmessages;
-	uint2 maxmessages;
 	MCColor *colors;
 	char **colornames;
 	int2 *allocs;
@@ -251,6 +272,13 @@ protected:
 	uint2 greenbits;
 	uint2 bluebits;
 	const char *  m_sound_internal ;
+
+	MCMessageList *newmessage(MCObject *optr, MCNameRef mptr, real8 time, MCParameter *params, uint4 id);
+	void queuemessage(MCMessageList *msg);
+	void dequeuemessage(MCMessageList *msg);
+	void requeuemessage(MCMessageList *msg);
+	MCMessageList *nextmessage(Boolean dispatch);
+	void rehashmessages(void);
 public:
 	MCColor white_pixel;
 	MCColor black_pixel;
@@ -525,9 +553,10 @@ public:
 	//
 
 	void addtimer(MCObject *optr, MCNameRef name, uint4 delay);
-	void cancelmessageindex(uint2 i, Boolean dodelete);
+	void cancelmessage(MCMessageList *msg);
 	void cancelmessageid(uint4 id);
 	void cancelmessageobject(MCObject *optr, MCNameRef name);
+	void cancelmessages(void);
 	void listmessages(MCExecPoint &ep);
 	Boolean handlepending(real8 &curtime, real8 &eventtime, Boolean dispatch);
 	void addmove(MCObject *optr, MCPoint *pts, uint2 npts,
@@ -554,7 +583,7 @@ public:
 	void setpixel(MCBitmap *image, int2 x, int2 y, uint4 pixel);
 	Boolean hasmessages()
 	{
-		return nmessages != 0;
+		return ntimers + nmessages != 0;
 	}
 	void closemodal()
 	{
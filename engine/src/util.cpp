@@ -39,6 +39,12 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "globals.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#define UTIL_SSE2
+#include <emmintrin.h>
+extern bool surface_has_sse2(void);
+#endif
+
 #define QA_NPOINTS 10
 
 static MCPoint qa_points[QA_NPOINTS];
@@ -1087,11 +1093,263 @@ static void msort(MCSortnode *b, uint4 n, MCSortnode *t, Sort_type form, Boolean
 	memcpy(b, t, (n - n2) * sizeof(MCSortnode));
 }
 
+// The items are sorted through an array of keys, each referring back to its
+// item, so that the items themselves are only moved once at the end. As the
+// sorts are stable (equal items keep their order, whichever the direction)
+// the result is exactly that of msort, which is used when keys can't be made.
+
+struct MCSortStringKey
+{
+	// The first 8 bytes of the string, most significant first.
+	uint64_t prefix;
+	const char *string;
+	uint4 index;
+};
+
+struct MCSortNumberKey
+{
+	uint64_t key;
+	uint4 index;
+};
+
+static inline int MCU_comparesortstrings(const MCSortStringKey& p_left, const MCSortStringKey& p_right)
+{
+	if (p_left . prefix != p_right . prefix)
+		return p_left . prefix < p_right . prefix ? -1 : 1;
+
+	// If the last byte of the prefix is NUL, both strings ended within it.
+	if ((p_left . prefix & 0xff) == 0)
+		return 0;
+
+	return strcmp(p_left . string + 8, p_right . string + 8);
+}
+
+static inline bool MCU_sortstringsbefore(const MCSortStringKey& p_left, const MCSortStringKey& p_right, bool p_reverse)
+{
+	int t_compare;
+	t_compare = MCU_comparesortstrings(p_left, p_right);
+	return p_reverse ? t_compare >= 0 : t_compare <= 0;
+}
+
+static void MCU_mergesortstrings(MCSortStringKey *p_keys, uint4 p_count, MCSortStringKey *p_temp, bool p_reverse)
+{
+	// Short runs are insertion sorted, only moving an item past those it must
+	// come before - so it stays stable.
+	if (p_count <= 8)
+	{
+		for (uint4 i = 1; i < p_count; i++)
+		{
+			MCSortStringKey t_key;
+			t_key = p_keys[i];
+
+			uint4 j;
+			for (j = i; j > 0 && !MCU_sortstringsbefore(p_keys[j - 1], t_key, p_reverse); j--)
+				p_keys[j] = p_keys[j - 1];
+			p_keys[j] = t_key;
+		}
+		return;
+	}
+
+	uint4 t_left_count = p_count / 2;
+	uint4 t_right_count = p_count - t_left_count;
+	MCSortStringKey *t_left = p_keys;
+	MCSortStringKey *t_right = p_keys + t_left_count;
+
+	MCU_mergesortstrings(t_left, t_left_count, p_temp, p_reverse);
+	MCU_mergesortstrings(t_right, t_right_count, p_temp, p_reverse);
+
+	// If the halves are already in order there is nothing to merge.
+	if (MCU_sortstringsbefore(t_right[-1], t_right[0], p_reverse))
+		return;
+
+	MCSortStringKey *t_out = p_temp;
+	while (t_left_count > 0 && t_right_count > 0)
+	{
+		if (MCU_sortstringsbefore(*t_left, *t_right, p_reverse))
+		{
+			*t_out++ = *t_left++;
+			t_left_count--;
+		}
+		else
+		{
+			*t_out++ = *t_right++;
+			t_right_count--;
+		}
+	}
+	if (t_left_count > 0)
+		memcpy(t_out, t_left, t_left_count * sizeof(MCSortStringKey));
+	memcpy(p_keys, p_temp, (p_count - t_right_count) * sizeof(MCSortStringKey));
+}
+
+static void MCU_sortpermute(MCSortnode *p_items, uint4 p_count, const uint4 *p_order, uint4 p_order_stride)
+{
+	MCSortnode *t_sorted = new MCSortnode[p_count];
+	for (uint4 i = 0; i < p_count; i++)
+		t_sorted[i] = p_items[*(const uint4 *)((const char *)p_order + i * p_order_stride)];
+	memcpy(p_items, t_sorted, p_count * sizeof(MCSortnode));
+	delete[] t_sorted;
+}
+
+// Sort by svalue, either bytewise or by the collation order of the current
+// locale. For the latter, each string is transformed with strxfrm once, as
+// comparing the results bytewise gives the same order as strcoll.
+static bool MCU_sortstrings(MCSortnode *p_items, uint4 p_count, bool p_reverse, bool p_international)
+{
+	char *t_transformed = NULL;
+	if (p_international)
+	{
+		size_t t_total = 0;
+		for (uint4 i = 0; i < p_count; i++)
+			t_total += strxfrm(NULL, p_items[i] . svalue, 0) + 1;
+
+		t_transformed = new char[t_total];
+		t_total = 0;
+		for (uint4 i = 0; i < p_count; i++)
+		{
+			size_t t_length;
+			t_length = strxfrm(NULL, p_items[i] . svalue, 0);
+			strxfrm(t_transformed + t_total, p_items[i] . svalue, t_length + 1);
+			t_total += t_length + 1;
+		}
+	}
+
+	MCSortStringKey *t_keys = new MCSortStringKey[p_count];
+	const char *t_next_transformed = t_transformed;
+	for (uint4 i = 0; i < p_count; i++)
+	{
+		const char *t_string;
+		if (p_international)
+		{
+			t_string = t_next_transformed;
+			t_next_transformed += strlen(t_string) + 1;
+		}
+		else
+			t_string = p_items[i] . svalue;
+
+		uint64_t t_prefix = 0;
+		uint4 j;
+		for (j = 0; j < 8 && t_string[j] != '\0'; j++)
+			t_prefix = (t_prefix << 8) | (uint1)t_string[j];
+		t_prefix <<= 8 * (8 - j);
+
+		t_keys[i] . prefix = t_prefix;
+		t_keys[i] . string = t_string;
+		t_keys[i] . index = i;
+	}
+
+	MCSortStringKey *t_temp = new MCSortStringKey[p_count];
+	MCU_mergesortstrings(t_keys, p_count, t_temp, p_reverse);
+	delete[] t_temp;
+
+	MCU_sortpermute(p_items, p_count, &t_keys[0] . index, sizeof(MCSortStringKey));
+
+	delete[] t_keys;
+	delete[] t_transformed;
+
+	return true;
+}
+
+// Sort by nvalue with an LSD radix sort. Each number is mapped to an unsigned
+// integer with the same order, complemented when sorting descending. As the
+// radix sort is stable, equal numbers (including 0 and -0) keep their order.
+// If any of the numbers is a NaN, false is returned as they don't have an
+// order that can be reproduced.
+static bool MCU_sortnumbers(MCSortnode *p_items, uint4 p_count, bool p_reverse)
+{
+	MCSortNumberKey *t_keys = new MCSortNumberKey[p_count];
+	for (uint4 i = 0; i < p_count; i++)
+	{
+		real8 t_value;
+		t_value = p_items[i] . nvalue;
+		if (MCS_isnan(t_value))
+		{
+			delete[] t_keys;
+			return false;
+		}
+
+		if (t_value == 0.0)
+			t_value = 0.0;
+
+		uint64_t t_bits;
+		memcpy(&t_bits, &t_value, sizeof(uint64_t));
+		if ((t_bits >> 63) != 0)
+			t_bits = ~t_bits;
+		else
+			t_bits |= (uint64_t)1 << 63;
+
+		t_keys[i] . key = p_reverse ? ~t_bits : t_bits;
+		t_keys[i] . index = i;
+	}
+
+	// Count the occurrences of each byte value at every position in one pass.
+	uint4 *t_counts = new uint4[8 * 256];
+	memset(t_counts, 0, 8 * 256 * sizeof(uint4));
+	for (uint4 i = 0; i < p_count; i++)
+		for (uint4 t_byte = 0; t_byte < 8; t_byte++)
+			t_counts[t_byte * 256 + ((t_keys[i] . key >> (t_byte * 8)) & 0xff)]++;
+
+	MCSortNumberKey *t_temp = new MCSortNumberKey[p_count];
+	for (uint4 t_byte = 0; t_byte < 8; t_byte++)
+	{
+		uint4 *t_byte_counts = t_counts + t_byte * 256;
+
+		// If every key has the same value for this byte, it doesn't change
+		// the order.
+		if (t_byte_counts[(t_keys[0] . key >> (t_byte * 8)) & 0xff] == p_count)
+			continue;
+
+		uint4 t_offset = 0;
+		for (uint4 v = 0; v < 256; v++)
+		{
+			uint4 t_count = t_byte_counts[v];
+			t_byte_counts[v] = t_offset;
+			t_offset += t_count;
+		}
+
+		for (uint4 i = 0; i < p_count; i++)
+			t_temp[t_byte_counts[(t_keys[i] . key >> (t_byte * 8)) & 0xff]++] = t_keys[i];
+
+		MCSortNumberKey *t_swap = t_keys;
+		t_keys = t_temp;
+		t_temp = t_swap;
+	}
+	delete[] t_temp;
+	delete[] t_counts;
+
+	MCU_sortpermute(p_items, p_count, &t_keys[0] . index, sizeof(MCSortNumberKey));
+
+	delete[] t_keys;
+
+	return true;
+}
+
 void MCU_sort(MCSortnode *items, uint4 nitems,
               Sort_type dir, Sort_type form)
 {
 	if (nitems <= 1)
 		return;
+
+	bool t_sorted;
+	switch (form)
+	{
+	case ST_TEXT:
+		t_sorted = MCU_sortstrings(items, nitems, dir == ST_DESCENDING, false);
+		break;
+	case ST_INTERNATIONAL:
+#if defined(_MAC_DESKTOP) || defined(_IOS_MOBILE)
+		t_sorted = false;
+#else
+		t_sorted = MCU_sortstrings(items, nitems, dir == ST_DESCENDING, true);
+#endif
+		break;
+	default:
+		t_sorted = MCU_sortnumbers(items, nitems, dir == ST_DESCENDING);
+		break;
+	}
+
+	if (t_sorted)
+		return;
+
 	MCSortnode *tmp = new MCSortnode[nitems];
 	msort(items, nitems, tmp, form, dir == ST_DESCENDING);
 	delete tmp;
@@ -2229,41 +2487,363 @@ void MCU_get_color(MCExecPoint &ep, const char *name, MCColor &c)
 	ep.setcolor(c, name);
 }
 
-void MCU_dofunc(Functions func, uint4 &nparams, real8 &n,
-                real8 tn, real8 oldn, MCSortnode *titems)
+// The aggregate functions are applied to a contiguous buffer of values. Sums
+// are accumulated in order, so the results are exactly those of accumulating
+// one value at a time; max and min are done two values at a time with SSE2
+// where it is available; and median selects the middle values rather than
+// sorting them all.
+
+// Returns true if the values contain a NaN or a negative zero. Where these
+// end up after sorting depends on the order of the values, so median takes the
+// original sorting path for such lists.
+static bool MCU_aggregate_hasspecials(const real8 *p_values, uint4 p_count)
+{
+	for(uint4 i = 0; i < p_count; i++)
+		if (p_values[i] != p_values[i] || (p_values[i] == 0.0 && 1.0 / p_values[i] < 0.0))
+			return true;
+	return false;
+}
+
+static inline void MCU_aggregate_swap(real8 &x_left, real8 &x_right)
+{
+	real8 t_value;
+	t_value = x_left;
+	x_left = x_right;
+	x_right = t_value;
+}
+
+static real8 MCU_aggregate_max(const real8 *p_values, uint4 p_count)
 {
+	real8 t_max;
+	t_max = p_values[0];
+	for(uint4 i = 1; i < p_count; i++)
+		if (p_values[i] > t_max)
+			t_max = p_values[i];
+	return t_max;
+}
+
+static real8 MCU_aggregate_min(const real8 *p_values, uint4 p_count)
+{
+	real8 t_min;
+	t_min = p_values[0];
+	for(uint4 i = 1; i < p_count; i++)
+		if (p_values[i] < t_min)
+			t_min = p_values[i];
+	return t_min;
+}
+
+#ifdef UTIL_SSE2
+// Computes the max (or min) of the values four at a time. Values that compare
+// equal are identical unless they are zeros of different sign, so this gives
+// the same result as the scalar loop except when there are NaNs or the result
+// is zero - in those cases false is returned and the scalar loop is used.
+static bool MCU_aggregate_minmax_sse2(const real8 *p_values, uint4 p_count, bool p_max, real8& r_result)
+{
+	__m128d t_acc0, t_acc1, t_nans;
+	t_acc0 = _mm_set1_pd(p_values[0]);
+	t_acc1 = t_acc0;
+	t_nans = _mm_setzero_pd();
+
+	uint4 i;
+	for(i = 0; i + 4 <= p_count; i += 4)
+	{
+		__m128d t_first, t_second;
+		t_first = _mm_loadu_pd(p_values + i);
+		t_second = _mm_loadu_pd(p_values + i + 2);
+		t_nans = _mm_or_pd(t_nans, _mm_or_pd(_mm_cmpunord_pd(t_first, t_first), _mm_cmpunord_pd(t_second, t_second)));
+		if (p_max)
+		{
+			t_acc0 = _mm_max_pd(t_acc0, t_first);
+			t_acc1 = _mm_max_pd(t_acc1, t_second);
+		}
+		else
+		{
+			t_acc0 = _mm_min_pd(t_acc0, t_first);
+			t_acc1 = _mm_min_pd(t_acc1, t_second);
+		}
+	}
+
+	if (_mm_movemask_pd(t_nans) != 0)
+		return false;
+
+	real8 t_lanes[4];
+	_mm_storeu_pd(t_lanes, t_acc0);
+	_mm_storeu_pd(t_lanes + 2, t_acc1);
+
+	real8 t_result;
+	t_result = t_lanes[0];
+	for(uint4 j = 1; j < 4; j++)
+		if (p_max ? t_lanes[j] > t_result : t_lanes[j] < t_result)
+			t_result = t_lanes[j];
+	for(; i < p_count; i++)
+	{
+		if (p_values[i] != p_values[i])
+			return false;
+		if (p_max ? p_values[i] > t_result : p_values[i] < t_result)
+			t_result = p_values[i];
+	}
+
+	if (t_result == 0.0)
+		return false;
+
+	r_result = t_result;
+	return true;
+}
+#endif
+
+// Rearranges the values so that the one at p_index is the one that would be
+// there if they were sorted, with none smaller after it and none larger before
+// it.
+static void MCU_aggregate_select(real8 *p_values, uint4 p_count, uint4 p_index)
+{
+	uint4 t_left, t_right;
+	t_left = 0;
+	t_right = p_count - 1;
+	while (t_right > t_left)
+	{
+		if (t_right - t_left < 16)
+		{
+			for(uint4 i = t_left + 1; i <= t_right; i++)
+			{
+				real8 t_value;
+				t_value = p_values[i];
+				uint4 j;
+				for(j = i; j > t_left && p_values[j - 1] > t_value; j--)
+					p_values[j] = p_values[j - 1];
+				p_values[j] = t_value;
+			}
+			return;
+		}
+
+		// Partition around the median of the first, middle and last values.
+		uint4 t_middle;
+		t_middle = t_left + (t_right - t_left) / 2;
+		if (p_values[t_middle] < p_values[t_left])
+			MCU_aggregate_swap(p_values[t_middle], p_values[t_left]);
+		if (p_values[t_right] < p_values[t_left])
+			MCU_aggregate_swap(p_values[t_right], p_values[t_left]);
+		if (p_values[t_right] < p_values[t_middle])
+			MCU_aggregate_swap(p_values[t_right], p_values[t_middle]);
+
+		real8 t_pivot;
+		t_pivot = p_values[t_middle];
+
+		uint4 i, j;
+		i = t_left;
+		j = t_right;
+		for(;;)
+		{
+			do
+				i++;
+			while (p_values[i] < t_pivot);
+			do
+				j--;
+			while (p_values[j] > t_pivot);
+			if (i >= j)
+				break;
+			MCU_aggregate_swap(p_values[i], p_values[j]);
+		}
+
+		// Everything up to j is no larger than the pivot, everything after it
+		// no smaller.
+		if (p_index <= j)
+			t_right = j;
+		else
+			t_left = j + 1;
+	}
+}
+
+static real8 MCU_aggregate_median(real8 *p_values, uint4 p_count)
+{
+	uint4 t_offset;
+	t_offset = (p_count + 1) / 2 - 1;
+
+	if (MCU_aggregate_hasspecials(p_values, p_count))
+	{
+		MCSortnode *t_items;
+		t_items = new MCSortnode[p_count];
+		for(uint4 i = 0; i < p_count; i++)
+			t_items[i] . nvalue = p_values[i];
+		MCU_sort(t_items, p_count, ST_ASCENDING, ST_NUMERIC);
+
+		real8 t_median;
+		if ((p_count % 2) != 0)
+			t_median = t_items[t_offset] . nvalue;
+		else
+			t_median = (t_items[t_offset] . nvalue + t_items[t_offset + 1] . nvalue) / 2;
+		delete[] t_items;
+		return t_median;
+	}
+
+	MCU_aggregate_select(p_values, p_count, t_offset);
+	if ((p_count % 2) != 0)
+		return p_values[t_offset];
+
+	// The next value up is the smallest of those after the selected one.
+	return (p_values[t_offset] + MCU_aggregate_min(p_values + t_offset + 1, p_count - t_offset - 1)) / 2;
+}
+
+real8 MCU_dofunc(Functions func, real8 *p_values, uint4 p_count)
+{
+	if (p_count == 0)
+		return 0.0;
+
 	switch (func)
 	{
 	case F_AVERAGE:
-		n += tn;
-		nparams++;
-		break;
+	case F_SUM:
+	case F_STD_DEV:
+		{
+			real8 t_sum;
+			t_sum = 0.0;
+			for(uint4 i = 0; i < p_count; i++)
+				t_sum += p_values[i];
+			if (func == F_SUM)
+				return t_sum;
+
+			real8 t_average;
+			t_average = t_sum / p_count;
+			if (func == F_AVERAGE)
+				return t_average;
+
+			real8 t_squares;
+			t_squares = 0.0;
+			for(uint4 i = 0; i < p_count; i++)
+			{
+				real8 t_deviation;
+				t_deviation = p_values[i] - t_average;
+				t_squares += t_deviation * t_deviation;
+			}
+			return sqrt(t_squares / (p_count - 1));
+		}
 	case F_MAX:
-		if (nparams++ == 0 || tn > n)
-			n = tn;
-		break;
 	case F_MIN:
-		if (nparams++ == 0 || tn < n)
-			n = tn;
-		break;
-	case F_SUM:
-		n += tn;
-		break;
+#ifdef UTIL_SSE2
+		if (p_count >= 8 && surface_has_sse2())
+		{
+			real8 t_result;
+			if (MCU_aggregate_minmax_sse2(p_values, p_count, func == F_MAX, t_result))
+				return t_result;
+		}
+#endif
+		return func == F_MAX ? MCU_aggregate_max(p_values, p_count) : MCU_aggregate_min(p_values, p_count);
 	case F_MEDIAN:
-		titems[nparams].nvalue = tn;
-		nparams++;
-		break;
-	case F_STD_DEV:
-		tn = tn - oldn;
-		n += tn * tn;
-		nparams++;
-		break;
-	case  F_UNDEFINED:
-		nparams++;
-		break;
+		return MCU_aggregate_median(p_values, p_count);
+	case F_UNDEFINED:
+		return p_count;
 	default:
 		break;
 	}
+	return 0.0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MCLRUCacheInitialize(MCLRUCache& x_cache)
+{
+	x_cache . buckets = NULL;
+	x_cache . bucket_count = 0;
+	x_cache . count = 0;
+	x_cache . first_used = NULL;
+	x_cache . last_used = NULL;
+}
+
+void MCLRUCacheFinalize(MCLRUCache& x_cache)
+{
+	delete[] x_cache . buckets;
+	MCLRUCacheInitialize(x_cache);
+}
+
+MCLRUCacheEntry *MCLRUCacheGetBucket(MCLRUCache& x_cache, uint4 p_hash)
+{
+	if (x_cache . bucket_count == 0)
+		return NULL;
+	return x_cache . buckets[p_hash & (x_cache . bucket_count - 1)];
+}
+
+static void MCLRUCacheUnlinkUsed(MCLRUCache& x_cache, MCLRUCacheEntry *p_entry)
+{
+	if (p_entry -> prev_used != NULL)
+		p_entry -> prev_used -> next_used = p_entry -> next_used;
+	else
+		x_cache . first_used = p_entry -> next_used;
+
+	if (p_entry -> next_used != NULL)
+		p_entry -> next_used -> prev_used = p_entry -> prev_used;
+	else
+		x_cache . last_used = p_entry -> prev_used;
+}
+
+static void MCLRUCacheLinkUsed(MCLRUCache& x_cache, MCLRUCacheEntry *p_entry)
+{
+	p_entry -> prev_used = NULL;
+	p_entry -> next_used = x_cache . first_used;
+	if (x_cache . first_used != NULL)
+		x_cache . first_used -> prev_used = p_entry;
+	else
+		x_cache . last_used = p_entry;
+	x_cache . first_used = p_entry;
+}
+
+static void MCLRUCacheRehash(MCLRUCache& x_cache, uint4 p_bucket_count)
+{
+	MCLRUCacheEntry **t_buckets;
+	t_buckets = new MCLRUCacheEntry *[p_bucket_count];
+	memset(t_buckets, 0, sizeof(MCLRUCacheEntry *) * p_bucket_count);
+
+	for(MCLRUCacheEntry *t_entry = x_cache . first_used; t_entry != NULL; t_entry = t_entry -> next_used)
+	{
+		uint4 t_index;
+		t_index = t_entry -> hash & (p_bucket_count - 1);
+		t_entry -> next_in_bucket = t_buckets[t_index];
+		t_buckets[t_index] = t_entry;
+	}
+
+	delete[] x_cache . buckets;
+	x_cache . buckets = t_buckets;
+	x_cache . bucket_count = p_bucket_count;
+}
+
+void MCLRUCacheTouch(MCLRUCache& x_cache, MCLRUCacheEntry *p_entry)
+{
+	if (p_entry == x_cache . first_used)
+		return;
+	MCLRUCacheUnlinkUsed(x_cache, p_entry);
+	MCLRUCacheLinkUsed(x_cache, p_entry);
+}
+
+void MCLRUCacheInsert(MCLRUCache& x_cache, MCLRUCacheEntry *p_entry)
+{
+	// Keep the table at least as big as the cache so chains stay short.
+	if (x_cache . count + 1 > x_cache . bucket_count)
+	{
+		uint4 t_bucket_count;
+		t_bucket_count = x_cache . bucket_count == 0 ? 32 : x_cache . bucket_count;
+		while(t_bucket_count < x_cache . count + 1)
+			t_bucket_count *= 2;
+		MCLRUCacheRehash(x_cache, t_bucket_count);
+	}
+
+	uint4 t_index;
+	t_index = p_entry -> hash & (x_cache . bucket_count - 1);
+	p_entry -> next_in_bucket = x_cache . buckets[t_index];
+	x_cache . buckets[t_index] = p_entry;
+
+	MCLRUCacheLinkUsed(x_cache, p_entry);
+	x_cache . count++;
+}
+
+void MCLRUCacheRemove(MCLRUCache& x_cache, MCLRUCacheEntry *p_entry)
+{
+	MCLRUCacheEntry **t_link;
+	t_link = &x_cache . buckets[p_entry -> hash & (x_cache . bucket_count - 1)];
+	while(*t_link != p_entry)
+		t_link = &(*t_link) -> next_in_bucket;
+	*t_link = p_entry -> next_in_bucket;
+
+	MCLRUCacheUnlinkUsed(x_cache, p_entry);
+	x_cache . count--;
 }
 
 
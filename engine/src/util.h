@@ -153,8 +153,7 @@ extern void MCU_cleaninserted();
 extern Exec_stat MCU_change_color(MCColor &c, char *&n, MCExecPoint &ep,
 	                                  uint2 line, uint2 pos);
 extern void MCU_get_color(MCExecPoint &ep, const char *name, MCColor &c);
-extern void MCU_dofunc(Functions func, uint4 &nparams, real8 &n,
-	                       real8 tn, real8 oldn, MCSortnode *titems);
+extern real8 MCU_dofunc(Functions func, real8 *p_values, uint4 p_count);
 extern void MCU_geturl(MCExecPoint &ep);
 extern void MCU_puturl(MCExecPoint &ep, MCExecPoint &data);
 extern uint1 MCU_unicodetocharset(uint2 uchar);
@@ -188,6 +187,40 @@ IO_stat MCU_dofakewrite(char*& x_buffer, uint4& x_length, const void *p_data, ui
 
 //
 
+// An MCLRUCache is a hash table of entries which are also threaded onto a list
+// in order of use, the most recently used first. The owner derives its entries
+// from MCLRUCacheEntry, computes their hashes, compares keys and frees them -
+// the cache only links them together.
+struct MCLRUCacheEntry
+{
+	uint4 hash;
+	MCLRUCacheEntry *next_in_bucket;
+	MCLRUCacheEntry *prev_used;
+	MCLRUCacheEntry *next_used;
+};
+
+struct MCLRUCache
+{
+	MCLRUCacheEntry **buckets;
+	uint4 bucket_count;
+	uint4 count;
+	MCLRUCacheEntry *first_used;
+	MCLRUCacheEntry *last_used;
+};
+
+extern void MCLRUCacheInitialize(MCLRUCache& x_cache);
+// All entries must have been removed first.
+extern void MCLRUCacheFinalize(MCLRUCache& x_cache);
+// Returns the first entry in the chain holding entries with the given hash.
+extern MCLRUCacheEntry *MCLRUCacheGetBucket(MCLRUCache& x_cache, uint4 p_hash);
+// Makes the entry the most recently used.
+extern void MCLRUCacheTouch(MCLRUCache& x_cache, MCLRUCacheEntry *p_entry);
+// Adds the entry (whose hash must be set) as the most recently used.
+extern void MCLRUCacheInsert(MCLRUCache& x_cache, MCLRUCacheEntry *p_entry);
+extern void MCLRUCacheRemove(MCLRUCache& x_cache, MCLRUCacheEntry *p_entry);
+
+//
+
 inline bool MCU_empty_rect(const MCRectangle& a)
 {
 	return a . width == 0 || a . height == 0;
@@ -123,6 +123,24 @@ MCVariable::~MCVariable(void)
 	MCNameDelete(name);
 }
 
+void MCVariable::reset(MCNameRef p_name)
+{
+	value . reset();
+
+	MCNameRef t_old_name;
+	t_old_name = name;
+	/* UNCHECKED */ MCNameClone(p_name, name);
+	MCNameDelete(t_old_name);
+
+	next = nil;
+
+	is_msg = false;
+	is_env = false;
+	is_global = false;
+	is_deferred = false;
+	is_uql = false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void MCVariable::doclearuql(void)
@@ -664,6 +682,7 @@ bool MCDeferredVariable::createwithname_cstring(const char *p_name, MCDeferredVa
 
 	self -> m_callback = p_callback;
 	self -> m_context = p_context;
+	self -> m_computed = false;
 
 	r_var = self;
 
@@ -672,10 +691,13 @@ bool MCDeferredVariable::createwithname_cstring(const char *p_name, MCDeferredVa
 
 Exec_stat MCDeferredVariable::compute(void)
 {
-	// Compute can only be called once. By setting deferred to false here, any
-	// future access of the variable via an MCDeferredVarref will result in this
-	// not being called.
-	is_deferred = false;
+	// The value is only computed once, until the variable is invalidated. The
+	// variable stays deferred so that references to it parsed after this point
+	// will still compute it if it is invalidated.
+	if (m_computed)
+		return ES_NORMAL;
+
+	m_computed = true;
 
 	// Request the variable's value be computed.
 	Exec_stat t_stat;
@@ -687,6 +709,12 @@ Exec_stat MCDeferredVariable::compute(void)
 	return ES_NORMAL;
 }
 
+void MCDeferredVariable::invalidate(void)
+{
+	value . clear();
+	m_computed = false;
+}
+
 Exec_stat MCDeferredVarref::eval(MCExecPoint& ep)
 {
 	Exec_stat t_stat;
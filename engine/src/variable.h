@@ -50,20 +50,44 @@ arrayextent;
 
 struct MCHashentry;
 
+// The array's table is open-addressed with linear probing. Each slot caches the
+// (caseless) hash of its entry's key so that a probe sequence only touches the
+// entry itself when the hashes match. A slot is empty if its entry is NULL and
+// is a tombstone (a removed key) if its entry is HASH_SLOT_DELETED. Tombstones
+// are only reclaimed by a rehash, which means removing keys never moves any
+// other entries (so iteration by slot index is stable across removal).
+struct MCHashslot
+{
+	uint32_t hash;
+	MCHashentry *entry;
+};
+
+#define HASH_SLOT_DELETED ((MCHashentry *)1)
+
 class MCVariableArray
 {
-	MCHashentry **table;
+	MCHashslot *table;
 	uint32_t tablesize;
 	uint32_t nfilled;
+	uint32_t nused;
 	uint32_t keysize;
 	uint8_t dimensions;
 	arrayextent *extents;
 
+	// While the keys of the array are exactly the integers 1..nfilled, added in
+	// that order, 'vector' holds the entries indexed by key - 1. This allows
+	// lookups of integer keys to bypass the hash table entirely. As soon as any
+	// other key is added (or a key other than the last is removed) the vector
+	// is dropped, and it is only re-established once the array becomes empty.
+	MCHashentry **vector;
+
 public:
-	// Initialize the hash to the given size
+	// Initialize the hash with room for (at least) the given number of keys
 	void presethash(uint4 p_size);
 
-	// Increase the size of the hash to the next power of two
+	// Rehash the table, removing any tombstones. If a size is given the table
+	// is made large enough to hold that many keys, otherwise it is sized
+	// appropriately for the current number of keys.
 	void resizehash(uint32_t p_new_size = 0);
 
 	// Free the array's memory
@@ -76,9 +100,10 @@ public:
 
 	//
 
-	// Perform an iterated function on the keys of the value.
+	// Fetch the values of the elements as numbers into r_values, which must
+	// have room for getnfilled() of them.
 	// PRECONDITION: this is initialized
-	Exec_stat dofunc(MCExecPoint& ep, Functions func, uint4 &nparams, real8 &n, real8 oldn, void *titems);
+	Exec_stat getreals(MCExecPoint& ep, real8 *r_values, uint4 &r_count);
 
 	// Perform:
 	//    this = this op <ep>
@@ -211,6 +236,24 @@ private:
 	// Compute the hash value of the given string
 	uint4 computehash(const MCString &);
 
+	// Return the index of the slot containing the given entry.
+	// PRECONDITION: p_entry is a direct child
+	uint32_t findslot(MCHashentry *p_entry) const;
+
+	// Update the vector (if any) to account for the addition of the given entry
+	// with key p_key. This must be called before nfilled is incremented.
+	void vectoradd(MCHashentry *p_entry, const MCString& p_key);
+
+	// Discard the vector, reverting to hash-only lookup.
+	void vectordrop(void);
+
+	// Place the given entry into the first free slot in its probe sequence,
+	// growing the table if required. No check for an existing key is made.
+	void insertentry(MCHashentry *p_entry);
+
+	// Mark the given slot as a tombstone and delete its entry.
+	void removeslot(uint32_t p_index);
+
 	// Update the extents on the array appropriately using the given key
 	void extentfromkey(char *skey);
 
@@ -290,6 +333,10 @@ public:
 
 	void clear(void);
 
+	// Return the value to the state it has when first constructed, as if it
+	// had been destroyed and created afresh.
+	void reset(void);
+
 	bool assign(const MCVariableValue& v);
 	void exchange(MCVariableValue& v);
 
@@ -471,7 +518,6 @@ private:
 
 struct MCHashentry
 {
-	MCHashentry *next;
 	uint32_t hash;
 	MCVariableValue value;
 	char string[4];
@@ -493,21 +539,19 @@ struct MCHashentry
 };
 
 inline MCHashentry::MCHashentry(void)
-	: next(NULL)
+	: hash(0)
 {
 }
 
 inline MCHashentry::MCHashentry(const MCString& p_key, uint32_t p_hash)
-	: next(NULL),
-	  hash(p_hash)
+	: hash(p_hash)
 {
 	strncpy(string, p_key . getstring(), p_key . getlength());
 	string[p_key . getlength()] = '\0';
 }
 
 inline MCHashentry::MCHashentry(const MCHashentry& e)
-	: next(NULL),
-	  hash(e . hash),
+	: hash(e . hash),
 	  value(e . value)
 {
 	strcpy(string, e . string);
@@ -564,9 +608,10 @@ protected:
 	// MW-2011-08-28: [[ SERVER ]] Some variables must only be computed when they
 	//   are first requested - in particular $_POST and $_POST_RAW. To support this
 	//   a variable can be marked as 'deferred' which causes a special varref to
-	//   be constructed when a reference to the variable is parsed. This bit is
-	//   unset as soon as the value has been computed once. If this bit is set then
-	//   it means the variable is actually an instance of MCDeferredVariable.
+	//   be constructed when a reference to the variable is parsed. If this bit
+	//   is set then it means the variable is actually an instance of
+	//   MCDeferredVariable, which keeps track of whether its value has been
+	//   computed yet.
 	bool is_deferred : 1;
 
 	// If set, this means that the variable has been parsed as an 'unquoted-
@@ -775,6 +820,11 @@ public:
 	/* CAN FAIL */ static bool createwithname_cstring(const char *name, MCVariable*& r_var);
 
 	/* CAN FAIL */ static bool createcopy(MCVariable& other, MCVariable*& r_var);
+
+	// Return the variable to the state it would have had if it had just been
+	// created with the given name. This allows variables to be recycled rather
+	// than deleted and created again.
+	void reset(MCNameRef name);
 };
 
 //
@@ -953,10 +1003,18 @@ protected:
 	MCDeferredVariableComputeCallback m_callback;
 	void *m_context;
 
+	// True once the value has been computed.
+	bool m_computed;
+
 public:
 	static bool createwithname_cstring(const char *name, MCDeferredVariableComputeCallback callback, void *context, MCVariable*& r_var);
 
+	// Compute the value of the variable, if it hasn't been already.
 	Exec_stat compute(void);
+
+	// Clear the value of the variable so that it is computed again the next
+	// time it is needed.
+	void invalidate(void);
 };
 
 // A 'deferred' varref works identically to a normal varref except that it
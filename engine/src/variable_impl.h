@@ -245,6 +245,23 @@ inline void MCVariableValue::clear(void)
 	set_dbg_changed(true);
 }
 
+inline void MCVariableValue::reset(void)
+{
+	destroy();
+
+#ifdef _IREVIAM
+	extern void MCDebugNotifyValueDeleted(MCVariableValue *);
+	if (get_dbg_notify())
+		MCDebugNotifyValueDeleted(this);
+#endif
+
+	set_type(VF_UNDEFINED);
+	_flags = 0;
+
+	strnum . buffer . data = NULL;
+	strnum . buffer . size = 0;
+}
+
 inline bool MCVariableValue::assign(const MCVariableValue& v)
 {
 	destroy();
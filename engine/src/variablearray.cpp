@@ -41,14 +41,79 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "stacksecurity.h"
 
+// The table is kept at most 3/4 full (counting tombstones) so that probe
+// sequences stay short. This returns true if adding another slot to a table
+// with p_used slots in use would exceed that.
+static inline bool MCVariableArrayNeedsRehash(uint32_t p_used, uint32_t p_tablesize)
+{
+	return ((uint64_t)p_used + 1) * 4 > (uint64_t)p_tablesize * 3;
+}
+
+// Returns the smallest power-of-two table size that will hold p_count keys
+// without needing a rehash.
+static inline uint32_t MCVariableArrayTableSizeFor(uint32_t p_count)
+{
+	uint32_t t_size;
+	t_size = TABLE_SIZE;
+	while((uint64_t)p_count * 4 > (uint64_t)t_size * 3)
+		t_size <<= 1;
+	return t_size;
+}
+
+static inline bool MCHashslotIsLive(const MCHashslot& p_slot)
+{
+	return p_slot . entry != NULL && p_slot . entry != HASH_SLOT_DELETED;
+}
+
+// The vector's capacity is implied by its length - it is the smallest power of
+// two (at least TABLE_SIZE) that will hold that many entries.
+static inline uint32_t MCVariableArrayVectorCapacity(uint32_t p_length)
+{
+	uint32_t t_capacity;
+	t_capacity = TABLE_SIZE;
+	while(t_capacity < p_length)
+		t_capacity <<= 1;
+	return t_capacity;
+}
+
+// Returns true if the given key is the canonical decimal form of a non-zero
+// integer (i.e. no sign, leading zeros or whitespace) and places its value in
+// r_index. Only such keys can be held in an array's vector.
+static inline bool MCVariableArrayKeyToIndex(const char *p_key, uint32_t p_length, uint32_t& r_index)
+{
+	if (p_length == 0 || p_length > 10 || p_key[0] < '1' || p_key[0] > '9')
+		return false;
+
+	uint64_t t_index;
+	t_index = 0;
+	for(uint32_t i = 0; i < p_length; i++)
+	{
+		if (p_key[i] < '0' || p_key[i] > '9')
+			return false;
+		t_index = t_index * 10 + (p_key[i] - '0');
+	}
+
+	if (t_index > MAXUINT4)
+		return false;
+
+	r_index = (uint32_t)t_index;
+	return true;
+}
+
 void MCVariableArray::presethash(uint4 size)
 {
-	tablesize = size;
-	table = new MCHashentry *[tablesize];
-	memset((char *)table, 0, tablesize * sizeof(MCHashentry *));
-	nfilled = keysize = 0;
+	// Small arrays are common, so a request for the default size gets exactly
+	// TABLE_SIZE slots rather than enough room for TABLE_SIZE keys.
+	if (size <= TABLE_SIZE)
+		tablesize = TABLE_SIZE;
+	else
+		tablesize = MCVariableArrayTableSizeFor(size);
+	table = new MCHashslot[tablesize];
+	memset((char *)table, 0, tablesize * sizeof(MCHashslot));
+	nfilled = nused = keysize = 0;
 	dimensions = EXTENT_ALLOCEVAL;
 	extents = NULL;
+	vector = NULL;
 }
 
 void MCVariableArray::freehash(void)
@@ -56,50 +121,129 @@ void MCVariableArray::freehash(void)
 	uint4 i;
 	if (table != NULL)
 		for (i = 0 ; i < tablesize ; i++)
-			if (table[i] != NULL)
-			{
-				MCHashentry *e = table[i];
-				while (e != NULL)
-				{
-					MCHashentry *next = e->next;
-					delete e;
-					e = next;
-				}
-			}
-	delete table;
+			if (MCHashslotIsLive(table[i]))
+				delete table[i] . entry;
+	delete[] table;
 	if (extents != NULL)
 		delete extents;
+	free(vector);
 }
 
-void MCVariableArray::resizehash(uint32_t p_new_tablesize)
+void MCVariableArray::resizehash(uint32_t p_new_size)
 {
 	uint4 oldsize = tablesize;
+	MCHashslot *oldtable = table;
 
-	if (p_new_tablesize == 0)
-		tablesize <<= 1;
-	else
-		tablesize = p_new_tablesize;
+	if (p_new_size < nfilled)
+		p_new_size = nfilled;
+
+	tablesize = MCVariableArrayTableSizeFor(p_new_size);
+	table = new MCHashslot[tablesize];
+	memset((char *)table, 0, tablesize * sizeof(MCHashslot));
 
-	MCHashentry **oldtable = table;
-	table = new MCHashentry *[tablesize];
-	memset((char *)table, 0, tablesize * sizeof(MCHashentry *));
 	uint4 i;
 	for (i = 0 ; i < oldsize ; i++)
+		if (MCHashslotIsLive(oldtable[i]))
+		{
+			uint4 index = oldtable[i] . hash & (tablesize - 1);
+			while (table[index] . entry != NULL)
+				index = (index + 1) & (tablesize - 1);
+			table[index] = oldtable[i];
+		}
+	nused = nfilled;
+
+	delete[] oldtable;
+}
+
+uint32_t MCVariableArray::findslot(MCHashentry *p_entry) const
+{
+	uint4 index = p_entry -> hash & (tablesize - 1);
+	while (table[index] . entry != p_entry)
+		index = (index + 1) & (tablesize - 1);
+	return index;
+}
+
+void MCVariableArray::insertentry(MCHashentry *p_entry)
+{
+	if (MCVariableArrayNeedsRehash(nused, tablesize))
+		resizehash(nfilled + 1);
+
+	uint4 index = p_entry -> hash & (tablesize - 1);
+	while (MCHashslotIsLive(table[index]))
+		index = (index + 1) & (tablesize - 1);
+
+	if (table[index] . entry == NULL)
+		nused++;
+	table[index] . hash = p_entry -> hash;
+	table[index] . entry = p_entry;
+	nfilled++;
+}
+
+void MCVariableArray::vectoradd(MCHashentry *p_entry, const MCString& p_key)
+{
+	// The vector can only be started when the array is empty.
+	if (vector == NULL && nfilled != 0)
+		return;
+
+	uint32_t t_index;
+	if (!MCVariableArrayKeyToIndex(p_key . getstring(), p_key . getlength(), t_index) || t_index != nfilled + 1)
 	{
-		if (oldtable[i] != NULL)
+		vectordrop();
+		return;
+	}
+
+	// Grow the vector whenever its (implied) capacity is reached.
+	if (nfilled == 0 || (nfilled >= TABLE_SIZE && (nfilled & (nfilled - 1)) == 0))
+	{
+		MCHashentry **t_new_vector;
+		t_new_vector = (MCHashentry **)realloc(vector, MCVariableArrayVectorCapacity(nfilled + 1) * sizeof(MCHashentry *));
+		if (t_new_vector == NULL)
 		{
-			MCHashentry *e = oldtable[i];
-			while (e != NULL)
-			{
-				MCHashentry *next = e->next;
-				uint4 index = e->hash & tablesize - 1;
-				e->next = table[index];
-				table[index] = e;
-				e = next;
-			}
+			vectordrop();
+			return;
 		}
+		vector = t_new_vector;
 	}
-	delete oldtable;
+
+	vector[nfilled] = p_entry;
+}
+
+void MCVariableArray::vectordrop(void)
+{
+	free(vector);
+	vector = NULL;
+}
+
+void MCVariableArray::removeslot(uint32_t p_index)
+{
+	MCHashentry *e = table[p_index] . entry;
+
+	// Removing the last key of a vector leaves it dense, removing any other
+	// makes it sparse.
+	if (vector != NULL && (nfilled == 1 || vector[nfilled - 1] != e))
+		vectordrop();
+
+	keysize -= strlen(e -> string) + 1;
+	nfilled--;
+	delete e;
+
+	// If the table is now empty, there's no need to keep any tombstones around
+	// so clear them out - this stops a repeatedly filled and emptied array from
+	// needing rehashes.
+	if (nfilled == 0)
+	{
+		memset((char *)table, 0, tablesize * sizeof(MCHashslot));
+		nused = 0;
+	}
+	else
+		table[p_index] . entry = HASH_SLOT_DELETED;
+
+	delete extents;
+	extents = NULL;
+	if (nfilled == 0)
+		dimensions = EXTENT_ALLOCEVAL;
+	else
+		dimensions = EXTENT_RECALC;
 }
 
 ////
@@ -108,21 +252,27 @@ void MCVariableArray::taketable(MCVariableArray *v)
 {
 	tablesize = v->tablesize;
 	nfilled = v->nfilled;
+	nused = v->nused;
 	keysize = v->keysize;
 	table = v->table;
 	v->table = NULL;
 	extents = v->extents;
 	dimensions = v->dimensions;
+	vector = v->vector;
 	v->extents = NULL;
 	v->dimensions = EXTENT_NONNUM;
+	v->vector = NULL;
 }
 
 bool MCVariableArray::copytable(const MCVariableArray &v)
 {
 	tablesize = v.tablesize;
 	nfilled = v.nfilled;
+	nused = v.nused;
 	keysize = v.keysize;
 	dimensions = v.dimensions;
+	table = NULL;
+	vector = NULL;
 	if (v.extents != NULL)
 	{
 		extents = new arrayextent[dimensions];
@@ -132,27 +282,37 @@ bool MCVariableArray::copytable(const MCVariableArray &v)
 	}
 	else
 		extents = NULL;
-	table = new MCHashentry *[tablesize];
+	table = new MCHashslot[tablesize];
 	if (table == NULL)
 		goto no_memory;
-	memset((char *)table, 0, tablesize * sizeof(MCHashentry *));
+	memset((char *)table, 0, tablesize * sizeof(MCHashslot));
+	if (v.vector != NULL)
+	{
+		vector = (MCHashentry **)malloc(MCVariableArrayVectorCapacity(nfilled) * sizeof(MCHashentry *));
+		if (vector == NULL)
+			goto no_memory;
+	}
+
+	// The copy keeps the same layout as the source (tombstones included) so
+	// that both iterate in the same order.
 	uint4 i;
 	for (i = 0 ; i < tablesize ; i++)
 	{
-		if (v.table[i] != NULL)
+		if (MCHashslotIsLive(v.table[i]))
 		{
-			MCHashentry *e = v.table[i];
-			while (e != NULL)
-			{
-				MCHashentry *ne;
-				ne = e -> Clone();
-				if (ne == NULL)
-					goto no_memory;
-				ne->next = table[i];
-				table[i] = ne;
-				e = e->next;
-			}
+			MCHashentry *ne;
+			ne = v.table[i] . entry -> Clone();
+			if (ne == NULL)
+				goto no_memory;
+			table[i] . hash = v.table[i] . hash;
+			table[i] . entry = ne;
+
+			uint32_t t_index;
+			if (vector != NULL && MCVariableArrayKeyToIndex(ne -> string, strlen(ne -> string), t_index))
+				vector[t_index - 1] = ne;
 		}
+		else
+			table[i] = v.table[i];
 	}
 	return true;
 
@@ -244,36 +404,65 @@ void MCVariableArray::extentfromkey(char *skey)
 
 MCHashentry *MCVariableArray::lookuphash(const MCString &s, Boolean cs, Boolean add)
 {
+	// If the array is a vector, then any integer key within range must be present
+	// and can be found directly.
+	if (vector != NULL)
+	{
+		uint32_t t_index;
+		if (MCVariableArrayKeyToIndex(s . getstring(), s . getlength(), t_index) && t_index <= nfilled)
+			return vector[t_index - 1];
+	}
+
 	uint4 hash = computehash(s);
-	uint4 index = hash & tablesize - 1;
-	MCHashentry *e = table[index];
-	while (e != NULL)
+	uint4 mask = tablesize - 1;
+	uint4 index = hash & mask;
+	uint4 length = s.getlength();
+	uint4 firstfree = tablesize;
+	for(;;)
 	{
-		if (cs)
+		MCHashslot& t_slot = table[index];
+		if (t_slot . entry == NULL)
+			break;
+
+		if (t_slot . entry == HASH_SLOT_DELETED)
 		{
-			uint4 l = strlen(e->string);
-			if (hash == e->hash && s.getlength() == l
-			        && !strncmp(s.getstring(), e->string, l))
-				return e;
+			if (firstfree == tablesize)
+				firstfree = index;
 		}
-		else
-			if (hash == e->hash && s == e->string)
-				return e;
-		e = e->next;
+		else if (t_slot . hash == hash)
+		{
+			MCHashentry *e = t_slot . entry;
+			if (cs)
+			{
+				uint4 l = strlen(e->string);
+				if (length == l && !strncmp(s.getstring(), e->string, l))
+					return e;
+			}
+			else
+				if (s == e->string)
+					return e;
+		}
+
+		index = (index + 1) & mask;
 	}
+
 	if (add)
 	{
-		if (nfilled++ > tablesize)
-		{
-			resizehash();
-			index = hash & tablesize - 1;
-		}
-		e = MCHashentry::Create(s, hash);
-		uint4 length = s.getlength();
+		MCHashentry *e = MCHashentry::Create(s, hash);
 		extentfromkey(e->string);
 		keysize += length + 1;
-		e->next = table[index];
-		table[index] = e;
+		vectoradd(e, s);
+
+		// If there's a tombstone in the probe sequence we can reuse it without
+		// changing the load of the table, otherwise we may need to grow.
+		if (firstfree != tablesize)
+		{
+			table[firstfree] . hash = hash;
+			table[firstfree] . entry = e;
+			nfilled++;
+		}
+		else
+			insertentry(e);
 		return e;
 	}
 
@@ -282,72 +471,14 @@ MCHashentry *MCVariableArray::lookuphash(const MCString &s, Boolean cs, Boolean
 
 void MCVariableArray::removehash(const MCString& s, Boolean cs)
 {
-	uint4 hash = computehash(s);
-	uint4 index = hash & tablesize - 1;
-	MCHashentry *e = table[index];
-	MCHashentry *last = NULL;
-	Boolean match = False;
-	while (e != NULL)
-	{
-		if (cs)
-		{
-			uint4 l = strlen(e->string);
-			if (hash == e->hash && s.getlength() == l
-			        && !strncmp(s.getstring(), e->string, l))
-				match = True;
-		}
-		else
-			if (hash == e->hash && s == e->string)
-				match = True;
-		if (match)
-		{
-			if (last == NULL)
-				table[index] = e->next;
-			else
-				last->next = e->next;
-			delete e;
-			keysize -= s.getlength() + 1;
-			nfilled--;
-			delete extents;
-			extents = NULL;
-			if (nfilled == 0)
-				dimensions = EXTENT_ALLOCEVAL;
-			else
-				dimensions = EXTENT_RECALC;
-			return;
-		}
-		last = e;
-		e = e->next;
-	}
+	MCHashentry *e = lookuphash(s, cs, False);
+	if (e != NULL)
+		removeslot(findslot(e));
 }
 
 void MCVariableArray::removehash(MCHashentry *p_hash)
 {
-	uint4 index;
-	index = p_hash -> hash & (tablesize - 1);
-	
-	MCHashentry *last;
-	if (table[index] == p_hash)
-		last = NULL;
-	else
-		for(last = table[index]; last -> next != p_hash; last = last -> next)
-			;
-	
-	if (last == NULL)
-		table[index] = p_hash -> next;
-	else
-		last -> next = p_hash -> next;
-		
-	keysize -= strlen(p_hash -> string) + 1;
-	nfilled -= 1;
-	delete extents;
-	extents = NULL;
-	if (nfilled == 0)
-		dimensions = EXTENT_ALLOCEVAL;
-	else
-		dimensions = EXTENT_RECALC;
-	
-	delete p_hash;
+	removeslot(findslot(p_hash));
 }
 
 void MCVariableArray::getextents(MCExecPoint &ep)
@@ -368,19 +499,9 @@ void MCVariableArray::getkeys(char **keylist, uint4 kcount)
 {
 	uint4 i;
 	uint4 count = 0;
-	for (i = 0 ; i < tablesize ; i++)
-		if (table[i] != NULL)
-		{
-			MCHashentry *e = table[i];
-			while (e != NULL)
-			{
-				keylist[count] = e->string;
-				e = e->next;
-				count++;
-				if (count == kcount)
-					break;
-			}
-		}
+	for (i = 0 ; i < tablesize && count < kcount ; i++)
+		if (MCHashslotIsLive(table[i]))
+			keylist[count++] = table[i] . entry -> string;
 }
 
 void MCVariableArray::getkeys(MCExecPoint &ep)
@@ -390,17 +511,13 @@ void MCVariableArray::getkeys(MCExecPoint &ep)
 	char *dptr = startptr;
 	uint4 i;
 	for (i = 0 ; i < tablesize ; i++)
-		if (table[i] != NULL)
+		if (MCHashslotIsLive(table[i]))
 		{
-			MCHashentry *e = table[i];
-			while (e != NULL)
-			{
-				uint4 length = strlen(e->string);
-				memcpy(dptr, e->string, length);
-				dptr += length;
-				*dptr++ = '\n';
-				e = e->next;
-			}
+			MCHashentry *e = table[i] . entry;
+			uint4 length = strlen(e->string);
+			memcpy(dptr, e->string, length);
+			dptr += length;
+			*dptr++ = '\n';
 		}
 	if (dptr != startptr)
 		dptr--;
@@ -429,21 +546,17 @@ Exec_stat MCVariableArray::transpose(MCVariableArray& v)
 	return ES_NORMAL;
 }
 
-Exec_stat MCVariableArray::dofunc(MCExecPoint& ep, Functions func, uint4 &nparams, real8 &n, real8 oldn, void *titems)
+Exec_stat MCVariableArray::getreals(MCExecPoint& ep, real8 *r_values, uint4 &r_count)
 {
 	uint4 i;
+	r_count = 0;
 	for (i = 0 ; i < tablesize ; i++)
-		if (table[i] != NULL)
+		if (MCHashslotIsLive(table[i]))
 		{
-			MCHashentry *e = table[i];
-			while (e != NULL)
-			{
-				real64_t value;
-				if (!e -> value . get_as_real(ep, value))
-					return ES_ERROR;
-				MCU_dofunc(func, nparams, n, value, oldn, (MCSortnode *)titems);
-				e = e->next;
-			}
+			real64_t value;
+			if (!table[i] . entry -> value . get_as_real(ep, value))
+				return ES_ERROR;
+			r_values[r_count++] = value;
 		}
 	return ES_NORMAL;
 }
@@ -456,136 +569,128 @@ Exec_stat MCVariableArray::factorarray(MCExecPoint &ep, Operators op)
 	{
 		MCVariableArray *v = ep.getarray() -> get_array();
 		for (i = 0 ; i < v->tablesize ; i++)
-			if (v->table[i] != NULL)
+			if (MCHashslotIsLive(v->table[i]))
 			{
-				MCHashentry *e = v->table[i];
+				MCHashentry *e = v->table[i] . entry;
 				MCHashentry *de;
 				real64_t dst_value, src_value;
-				while (e != NULL)
+				if ((de = lookuphash(e->string, False, False)) == NULL ||
+				        !de -> value . get_as_real(ep, dst_value) || !e -> value . get_as_real(ep, src_value))
+					return ES_ERROR;
+				switch (op)
 				{
-					if ((de = lookuphash(e->string, False, False)) == NULL ||
-					        !de -> value . get_as_real(ep, dst_value) || !e -> value . get_as_real(ep, src_value))
-						return ES_ERROR;
-					switch (op)
+				case O_PLUS:
+					dst_value += src_value;
+					break;
+				case O_MINUS:
+					dst_value -= src_value;
+					break;
+				case O_TIMES:
+					dst_value *= src_value;
+					break;
+				case O_DIV:
+					dst_value /= src_value;
+					if (dst_value != MCinfinity && MCS_geterrno() == 0)
+					{
+						if (dst_value < 0.0)
+							dst_value = ceil(dst_value);
+						else
+							dst_value = floor(dst_value);
+					}
+					break;
+				case O_MOD:
 					{
-					case O_PLUS:
-						dst_value += src_value;
-						break;
-					case O_MINUS:
-						dst_value -= src_value;
-						break;
-					case O_TIMES:
-						dst_value *= src_value;
-						break;
-					case O_DIV:
-						dst_value /= src_value;
+						real8 n = dst_value;
+						dst_value = n/src_value;
 						if (dst_value != MCinfinity && MCS_geterrno() == 0)
-						{
-							if (dst_value < 0.0)
-								dst_value = ceil(dst_value);
-							else
-								dst_value = floor(dst_value);
-						}
-						break;
-					case O_MOD:
-						{
-							real8 n = dst_value;
-							dst_value = n/src_value;
-							if (dst_value != MCinfinity && MCS_geterrno() == 0)
-								dst_value = fmod(n, src_value);
-						}
-						break;
-					case O_WRAP:
-						{
-							real8 n = dst_value;
-							dst_value = n/src_value;
-							if (dst_value != MCinfinity && MCS_geterrno() == 0)
-								dst_value = MCU_fwrap(n, src_value);
-						}
-						break;
-					default:
-						dst_value /= src_value;
-						break;
+							dst_value = fmod(n, src_value);
 					}
-					if (src_value == MCinfinity || MCS_geterrno() != 0)
+					break;
+				case O_WRAP:
 					{
-						MCS_seterrno(0);
-						if (src_value == 0.0)
-							MCeerror->add(EE_DIVIDE_ZERO, 0, 0);
-						else
-							MCeerror->add(EE_MATRIX_RANGE, 0, 0);
-						return ES_ERROR;
+						real8 n = dst_value;
+						dst_value = n/src_value;
+						if (dst_value != MCinfinity && MCS_geterrno() == 0)
+							dst_value = MCU_fwrap(n, src_value);
 					}
-					de -> value . assign_real(dst_value);
-					e = e->next;
+					break;
+				default:
+					dst_value /= src_value;
+					break;
 				}
+				if (src_value == MCinfinity || MCS_geterrno() != 0)
+				{
+					MCS_seterrno(0);
+					if (src_value == 0.0)
+						MCeerror->add(EE_DIVIDE_ZERO, 0, 0);
+					else
+						MCeerror->add(EE_MATRIX_RANGE, 0, 0);
+					return ES_ERROR;
+				}
+				de -> value . assign_real(dst_value);
 			}
 	}
 	else
 	{
 		real8 tnum = ep.getnvalue();
 		for (i = 0 ; i < tablesize ; i++)
-			if (table[i] != NULL)
+			if (MCHashslotIsLive(table[i]))
 			{
-				MCHashentry *e = table[i];
-				while (e != NULL)
+				MCHashentry *e = table[i] . entry;
+				real64_t value;
+				if (!e -> value . get_as_real(ep, value))
+					return ES_ERROR;
+				switch (op)
 				{
-					real64_t value;
-					if (!e -> value . get_as_real(ep, value))
-						return ES_ERROR;
-					switch (op)
+				case O_PLUS:
+					value += tnum;
+					break;
+				case O_MINUS:
+					value -= tnum;
+					break;
+				case O_TIMES:
+					value *= tnum;
+					break;
+				case O_DIV:
+					value /= tnum;
+					if (value != MCinfinity && MCS_geterrno() == 0)
+					{
+						if (value < 0.0)
+							value = ceil(value);
+						else
+							value = floor(value);
+					}
+					break;
+				case O_MOD:
 					{
-					case O_PLUS:
-						value += tnum;
-						break;
-					case O_MINUS:
-						value -= tnum;
-						break;
-					case O_TIMES:
-						value *= tnum;
-						break;
-					case O_DIV:
-						value /= tnum;
+						real8 n = value;
+						value = n / tnum;
 						if (value != MCinfinity && MCS_geterrno() == 0)
-						{
-							if (value < 0.0)
-								value = ceil(value);
-							else
-								value = floor(value);
-						}
-						break;
-					case O_MOD:
-						{
-							real8 n = value;
-							value = n / tnum;
-							if (value != MCinfinity && MCS_geterrno() == 0)
-								value = fmod(n, tnum);
-						}
-						break;					
-					case O_WRAP:
-						{
-							real8 n = value;
-							value = n / tnum;
-							if (value != MCinfinity && MCS_geterrno() == 0)
-								value = MCU_fwrap(n, tnum);
-						}
-						break;
-					default:
-						value /= tnum;
-						break;
+							value = fmod(n, tnum);
 					}
-					if (value == MCinfinity || MCS_geterrno() != 0)
+					break;					
+				case O_WRAP:
 					{
-						MCS_seterrno(0);
-						if (tnum == 0.0)
-							MCeerror->add(EE_DIVIDE_ZERO, 0, 0);
-						else
-							MCeerror->add(EE_MATRIX_RANGE, 0, 0);
-						return ES_ERROR;
+						real8 n = value;
+						value = n / tnum;
+						if (value != MCinfinity && MCS_geterrno() == 0)
+							value = MCU_fwrap(n, tnum);
 					}
-					e -> value . assign_real(value);
-					e = e->next;
+					break;
+				default:
+					value /= tnum;
+					break;
 				}
+				if (value == MCinfinity || MCS_geterrno() != 0)
+				{
+					MCS_seterrno(0);
+					if (tnum == 0.0)
+						MCeerror->add(EE_DIVIDE_ZERO, 0, 0);
+					else
+						MCeerror->add(EE_MATRIX_RANGE, 0, 0);
+					return ES_ERROR;
+				}
+				e -> value . assign_real(value);
 			}
 	}
 	return ES_NORMAL;
@@ -594,36 +699,9 @@ Exec_stat MCVariableArray::factorarray(MCExecPoint &ep, Operators op)
 Exec_stat MCVariableArray::intersectarray(MCVariableArray& v)
 {
 	uint4 i;
-	MCHashentry *last;
-	for (i = 0 ; i < tablesize ; i++)
-		if (table[i] != NULL)
-		{
-			last = NULL;
-			MCHashentry *e = table[i];
-			while (e != NULL)
-			{
-				if (v.lookuphash(e->string, False, False) == NULL)
-				{
-					if (last == NULL)
-						table[i] = e->next;
-					else
-						last->next = e->next;
-					keysize -= strlen(e->string) + 1;
-					nfilled--;
-					MCHashentry *tmp = e->next;
-					delete e;
-					e = tmp;
-					delete extents;//clear extents
-					extents = NULL;
-					dimensions = nfilled == 0 ? EXTENT_ALLOCEVAL : EXTENT_RECALC;
-				}
-				else
-				{
-					last = e;
-					e = e->next;
-				}
-			}
-		}
+	for (i = 0 ; i < tablesize && nfilled != 0 ; i++)
+		if (MCHashslotIsLive(table[i]) && v.lookuphash(table[i] . entry -> string, False, False) == NULL)
+			removeslot(i);
 
 	return ES_NORMAL;
 }
@@ -632,17 +710,13 @@ Exec_stat MCVariableArray::unionarray(MCVariableArray& v)
 {
 	uint4 i;
 	for (i = 0 ; i < v.tablesize ; i++)
-		if (v.table[i] != NULL)
+		if (MCHashslotIsLive(v.table[i]))
 		{
-			MCHashentry *e = v.table[i];
-			while (e != NULL)
+			MCHashentry *e = v.table[i] . entry;
+			if (lookuphash(e->string, False, False) == NULL)
 			{
-				if (lookuphash(e->string, False, False) == NULL)
-				{
-					MCHashentry *ne = lookuphash(e->string, False, True);
-					ne -> value . assign(e -> value);
-				}
-				e = e->next;
+				MCHashentry *ne = lookuphash(e->string, False, True);
+				ne -> value . assign(e -> value);
 			}
 		}
 	return ES_NORMAL;
@@ -655,14 +729,10 @@ void MCVariableArray::calcextents(void)
 	dimensions = EXTENT_ALLOCEVAL;
 	uint4 i;
 	for (i = 0 ; i < tablesize ; i++)
-		if (table[i] != NULL)
+		if (MCHashslotIsLive(table[i]))
 		{
-			MCHashentry *e = table[i];
-			while (e != NULL)
-			{
-				extentfromkey(e->string);
-				e = e->next;
-			}
+			MCHashentry *e = table[i] . entry;
+			extentfromkey(e->string);
 			if (dimensions == EXTENT_NONNUM)
 				break;
 		}
@@ -696,38 +766,67 @@ Exec_stat MCVariableArray::matrixmultiply(MCExecPoint& ep, MCVariableArray &va,
 	        !(va.getextent(COL_DIM) == vb.getextent(ROW_DIM)) ||
 	        !(!va.ismissingelement() && !vb.ismissingelement()))
 		return ES_ERROR; //columns does not equal rows
-	presethash(va.getextent(ROW_DIM) * vb.getextent(COL_DIM));
-	uint2 i,j,k;
-	char tbuf[(U2L * 2) + 1];
-	MCHashentry *vaptr,*vbptr,*vcptr;
-	for (i = va.extents[ROW_DIM].min; i <= va.extents[ROW_DIM].max; i++)
+
+	// Fetch the numeric value of each element of the operands once up front, rather
+	// than looking up (and converting) each element once per row or column of the
+	// result.
+	uint4 t_rows, t_inner, t_cols;
+	t_rows = va.extents[ROW_DIM].max - va.extents[ROW_DIM].min + 1;
+	t_inner = va.extents[COL_DIM].max - va.extents[COL_DIM].min + 1;
+	t_cols = vb.extents[COL_DIM].max - vb.extents[COL_DIM].min + 1;
+
+	real64_t *t_a, *t_b;
+	t_a = new real64_t[t_rows * t_inner];
+	t_b = new real64_t[t_inner * t_cols];
+	if (t_a == NULL || t_b == NULL)
 	{
-		for (j = vb.extents[COL_DIM].min; j <= vb.extents[COL_DIM].max ; j++)
+		delete[] t_a;
+		delete[] t_b;
+		return ES_ERROR;
+	}
+
+	uint4 i,j,k;
+	char tbuf[(U4L * 2) + 1];
+	Exec_stat t_stat;
+	t_stat = ES_NORMAL;
+	for (i = 0; t_stat == ES_NORMAL && i < t_rows; i++)
+		for (k = 0; t_stat == ES_NORMAL && k < t_inner; k++)
 		{
-			real64_t value;
+			sprintf(tbuf, "%u,%u", va.extents[ROW_DIM].min + i, va.extents[COL_DIM].min + k);
+			MCHashentry *vaptr = va.lookuphash(tbuf, False, False);
+			if (vaptr == NULL || !vaptr -> value . get_as_real(ep, t_a[i * t_inner + k]))
+				t_stat = ES_ERROR;
+		}
+	for (k = 0; t_stat == ES_NORMAL && k < t_inner; k++)
+		for (j = 0; t_stat == ES_NORMAL && j < t_cols; j++)
+		{
+			sprintf(tbuf, "%u,%u", va.extents[COL_DIM].min + k, vb.extents[COL_DIM].min + j);
+			MCHashentry *vbptr = vb.lookuphash(tbuf, False, False);
+			if (vbptr == NULL || !vbptr -> value . get_as_real(ep, t_b[k * t_cols + j]))
+				t_stat = ES_ERROR;
+		}
 
-			sprintf(tbuf,"%d,%d",i,j);
-			vcptr = lookuphash(tbuf, False, True);
-			value = 0.0;
-			for (k = va.extents[COL_DIM].min; k <= va.extents[COL_DIM].max; k++)
+	if (t_stat == ES_NORMAL)
+	{
+		presethash(t_rows * t_cols);
+		for (i = 0; i < t_rows; i++)
+			for (j = 0; j < t_cols; j++)
 			{
-				sprintf(tbuf,"%d,%d",i,k);
-				vaptr = va.lookuphash(tbuf, False, False);
-				sprintf(tbuf,"%d,%d",k,j);
-				vbptr = vb.lookuphash(tbuf, False, False);
-
-				real64_t avalue, bvalue;
-				if ((vaptr == NULL || vbptr == NULL) ||
-				        (!vaptr -> value . get_as_real(ep, avalue) || !vbptr -> value . get_as_real(ep, bvalue)))
-					return ES_ERROR;
+				real64_t value;
+				value = 0.0;
+				for (k = 0; k < t_inner; k++)
+					value += t_a[i * t_inner + k] * t_b[k * t_cols + j];
 
-				value += avalue * bvalue;
+				sprintf(tbuf, "%u,%u", va.extents[ROW_DIM].min + i, vb.extents[COL_DIM].min + j);
+				MCHashentry *vcptr = lookuphash(tbuf, False, True);
+				vcptr -> value . assign_real(value);
 			}
-
-			vcptr -> value . assign_real(value);
-		}
 	}
-	return ES_NORMAL;
+
+	delete[] t_a;
+	delete[] t_b;
+
+	return t_stat;
 }
 
 Boolean MCVariableArray::isnumeric(void)
@@ -743,29 +842,16 @@ MCHashentry *MCVariableArray::getnextelement(uint4 &l, MCHashentry *e, Boolean d
 	MCHashentry *ne = NULL;
 	if (donumeric && dimensions == 1)
 	{ //use numeric
-		char tbuf[U4L];
 		uint32_t i;
 		i = extents[ROW_DIM].min + l;
 		if (i > extents[ROW_DIM].max)
 			return NULL;
-		sprintf(tbuf, "%d", i);
-		ne = lookuphash(tbuf, False, False);
+		ne = lookupindex(i, False);
 		l++;
 	}
 	else
 	{
-		if (table == NULL)
-			return NULL;
-		if (e != NULL && e->next != NULL)
-			ne = e->next;
-		else
-			while (l < tablesize)
-			{
-				ne = table[l];
-				l++;
-				if (ne != NULL)
-					break;
-			}
+		ne = getnextkey(l, e);
 	}
 	
 	if (ne != NULL && ne -> value . is_number())
@@ -775,32 +861,28 @@ MCHashentry *MCVariableArray::getnextelement(uint4 &l, MCHashentry *e, Boolean d
 }
 
 MCHashentry *MCVariableArray::getnextkey(uint4& l, MCHashentry *e) const
-{	
-	if (e != NULL && e -> next != NULL)
-		return e -> next;
-	
+{
+	// The slot index is all that's needed to continue iterating as each slot
+	// holds at most one entry.
+	if (table == NULL)
+		return NULL;
+
 	while(l < tablesize)
-		if (table[l++] != NULL)
-			return table[l - 1];
+		if (MCHashslotIsLive(table[l++]))
+			return table[l - 1] . entry;
 
 	return NULL;
 }
 
 MCHashentry *MCVariableArray::getnextkey(MCHashentry *e) const
 {
-	if (e != NULL && e -> next != NULL)
-		return e -> next;
-
 	uint32_t l;
 	if (e != NULL)
-		l = (( e -> hash) & (tablesize - 1)) + 1;
+		l = findslot(e) + 1;
 	else
 		l = 0;
-	while(l < tablesize)
-		if (table[l++] != NULL)
-			return table[l - 1];
 
-	return NULL;
+	return getnextkey(l, NULL);
 }
 
 void MCVariableArray::combine(MCExecPoint& ep, char el, char k, char*& r_buffer, uint32_t& r_length)
@@ -810,18 +892,14 @@ void MCVariableArray::combine(MCExecPoint& ep, char el, char k, char*& r_buffer,
 	uint4 ncount = 0;
 	uint4 ssize = 0;
 	for (i = 0 ; i < tablesize ; i++)
-		if (table[i] != NULL)
+		if (MCHashslotIsLive(table[i]))
 		{
-			MCHashentry *e = table[i];
-			while (e != NULL)
+			MCHashentry *e = table[i] . entry;
+			if (e -> value . ensure_string(ep))
 			{
-				if (e -> value . ensure_string(ep))
-				{
-					ssize += e -> value . get_string() . getlength() + 2;
-					items[ncount].data = e;
-					items[ncount++].svalue = e->string;
-				}
-				e = e->next;
+				ssize += e -> value . get_string() . getlength() + 2;
+				items[ncount].data = e;
+				items[ncount++].svalue = e->string;
 			}
 		}
 
@@ -976,26 +1054,30 @@ void MCVariableArray::combine_column(MCExecPoint& ep, char p_row_delimiter, char
 	t_size = 0;
 	for(uint4 t_index = 0; t_index < tablesize; ++t_index)
 	{
-		for(MCHashentry *t_entry = table[t_index]; t_entry != NULL; t_entry = t_entry -> next)
-			if (!t_entry -> value . is_undefined())
-			{
-				uint2 t_column;
-				if (!MCU_stoui2(t_entry -> string, t_column))
-					assert(false);
+		if (!MCHashslotIsLive(table[t_index]))
+			continue;
 
-				if (t_entry -> value . ensure_string(ep))
-				{
-					t_entries[t_column - 1] = t_entry -> value . get_string();
-					t_size += t_entries[t_column - 1] . getlength() + 2;
-				}
-				else
-				{
-					t_entries[t_column - 1] . set("", 0);
-					t_size += 2;
-				}
+		MCHashentry *t_entry;
+		t_entry = table[t_index] . entry;
+		if (!t_entry -> value . is_undefined())
+		{
+			uint2 t_column;
+			if (!MCU_stoui2(t_entry -> string, t_column))
+				assert(false);
 
-				t_live_column_count += 1;
+			if (t_entry -> value . ensure_string(ep))
+			{
+				t_entries[t_column - 1] = t_entry -> value . get_string();
+				t_size += t_entries[t_column - 1] . getlength() + 2;
 			}
+			else
+			{
+				t_entries[t_column - 1] . set("", 0);
+				t_size += 2;
+			}
+
+			t_live_column_count += 1;
+		}
 	}
 
 	char *t_output;
@@ -1296,18 +1378,14 @@ void MCVariableArray::combine_as_set(MCExecPoint& ep, char el, char*& r_buffer,
 	uint4 ncount = 0;
 	uint4 ssize = 0;
 	for (i = 0 ; i < tablesize ; i++)
-		if (table[i] != NULL)
+		if (MCHashslotIsLive(table[i]))
 		{
-			MCHashentry *e = table[i];
-			while (e != NULL)
+			MCHashentry *e = table[i] . entry;
+			if (e -> value . is_string() && e -> value . get_string() == MCtruemcstring)
 			{
-				if (e -> value . is_string() && e -> value . get_string() == MCtruemcstring)
-				{
-					ssize += strlen(e -> string) + 1;
-					items[ncount].data = e;
-					items[ncount++].svalue = e->string;
-				}
-				e = e->next;
+				ssize += strlen(e -> string) + 1;
+				items[ncount].data = e;
+				items[ncount++].svalue = e->string;
 			}
 		}
 
@@ -1376,21 +1454,17 @@ Exec_stat MCVariableArray::setprops(uint4 parid, MCObject *optr)
 	MCerrorlock++;
 	uint4 i;
 	for (i = 0 ; i < tablesize ; i++)
-		if (table[i] != NULL)
+		if (MCHashslotIsLive(table[i]))
 		{
-			MCHashentry *e = table[i];
-			while (e != NULL)
+			MCHashentry *e = table[i] . entry;
+			MCScriptPoint sp(e->string);
+			Symbol_type type;
+			const LT *te;
+			if (sp.next(type) && sp.lookup(SP_FACTOR, te) == PS_NORMAL
+			        && te->type == TT_PROPERTY && te->which != P_ID)
 			{
-				MCScriptPoint sp(e->string);
-				Symbol_type type;
-				const LT *te;
-				if (sp.next(type) && sp.lookup(SP_FACTOR, te) == PS_NORMAL
-				        && te->type == TT_PROPERTY && te->which != P_ID)
-				{
-					e -> value . fetch(ep);
-					optr->setprop(parid, (Properties)te->which, ep, False);
-				}
-				e = e->next;
+				e -> value . fetch(ep);
+				optr->setprop(parid, (Properties)te->which, ep, False);
 			}
 		}
 	MCerrorlock--;
@@ -1421,23 +1495,15 @@ IO_stat MCVariableArray::loadkeys(IO_handle stream, bool p_merge)
 	MCStackSecuritySetIOEncryptionEnabled(decrypt);
 	if (!p_merge)
 	{
-		nfilled = t_new_nfilled;
-		extents = NULL;
+		presethash(t_new_nfilled);
 		dimensions = EXTENT_NONNUM;
-		keysize = 0;
-		tablesize = TABLE_SIZE;
-		while (tablesize < nfilled)
-			tablesize <<= 1;
-		table = new MCHashentry *[tablesize];
-		memset((char *)table, 0, tablesize * sizeof(MCHashentry *));
 	}
-	else if (t_new_nfilled > tablesize)
+	else
 	{
-		uint32_t t_new_tablesize;
-		t_new_tablesize = tablesize;
-		while(t_new_tablesize < t_new_nfilled)
-			t_new_tablesize <<= 1;
-		resizehash(t_new_tablesize);
+		// Keys are loaded directly into the table, so the vector can't be kept.
+		vectordrop();
+		if (MCVariableArrayTableSizeFor(nused + t_new_nfilled) > tablesize)
+			resizehash(nfilled + t_new_nfilled);
 	}
 
 	uint32_t t_size;
@@ -1462,9 +1528,7 @@ IO_stat MCVariableArray::loadkeys(IO_handle stream, bool p_merge)
 			MCCStringFree(t_string);
 			t_string = nil;
 
-			uint4 index = e->hash & tablesize - 1;
-			e->next = table[index];
-			table[index] = e;
+			insertentry(e);
 
 			stat = IO_read_string(t_string, t_length, stream, t_size, false, false);
 		}
@@ -1478,6 +1542,14 @@ IO_stat MCVariableArray::loadkeys(IO_handle stream, bool p_merge)
 		}
 	}
 	
+	// If no keys could be read, the caller will treat this as an empty value so
+	// make sure the table isn't leaked.
+	if (!p_merge && nfilled == 0)
+	{
+		delete[] table;
+		table = NULL;
+	}
+
 	MCStackSecuritySetIOEncryptionEnabled(t_encrypted);
 	return stat;
 }
@@ -1494,19 +1566,14 @@ IO_stat MCVariableArray::savekeys(IO_handle stream)
 	Boolean large = False;
 	for (i = 0 ; i < tablesize ; i++)
 	{
-		if (table[i] != NULL)
+		if (MCHashslotIsLive(table[i]))
 		{
-			MCHashentry *e = table[i];
-			while (e != NULL)
-			{
-				if (e -> value . is_string() && e -> value . get_string() . getlength() > MAXUINT2)
-					large = True;
-		
-				if (!e -> value . is_array())
-					t_writable_nfilled += 1;
-
-				e = e->next;
-			}
+			MCHashentry *e = table[i] . entry;
+			if (e -> value . is_string() && e -> value . get_string() . getlength() > MAXUINT2)
+				large = True;
+	
+			if (!e -> value . is_array())
+				t_writable_nfilled += 1;
 		}
 	}
 
@@ -1521,62 +1588,55 @@ IO_stat MCVariableArray::savekeys(IO_handle stream)
 		return stat;
 	
 	for (i = 0 ; i < tablesize ; i++)
-		if (table[i] != NULL)
+		if (MCHashslotIsLive(table[i]))
 		{
-			MCHashentry *e = table[i];
-			while (e != NULL)
-			{
-				// Skip any array valued keys.
-				if (e -> value . is_array())
-				{
-					e = e -> next;
-					continue;
-				}
+			MCHashentry *e = table[i] . entry;
 
-				// IM-2013-04-04: [[ BZ 10811 ]] pre 6.0 versions of loadkeys() expect
-				// a null-terminated string of non-zero length (including null),
-				// but IO_write_string() writes a single zero byte for an empty string
-				// so we need a special case here.
-				if (e->string == nil || e->string[0] == '\0')
-				{
-					// write length + null
-					if ((stat = IO_write_uint1(1, stream)) != IO_NORMAL)
-						return stat;
-					// write null
-					if ((stat = IO_write_uint1(0, stream)) != IO_NORMAL)
-						return stat;
-				}
-				else
-				{
-					if ((stat = IO_write_string(e->string, stream, 1)) != IO_NORMAL)
-						return stat;
-				}
-
-				const char *t_value_str;
-				uint32_t t_value_length;
-				MCExecPoint ep;
-				if (e -> value . ensure_string(ep))
-				{
-					t_value_str = e -> value . get_string() . getstring();
-					t_value_length = e -> value . get_string() . getlength();
-				}
-				else
-				{
-					t_value_str = NULL;
-					t_value_length = 0;
-				}
+			// Skip any array valued keys.
+			if (e -> value . is_array())
+				continue;
 
-				uint32_t t_size;
-				if (large)
-					t_size = 4;
-				else
-					t_size = 2;
-				MCString t_string(t_value_str, t_value_length);
-				if ((stat = IO_write_string(t_string, stream, t_size, false)) != IO_NORMAL)
+			// IM-2013-04-04: [[ BZ 10811 ]] pre 6.0 versions of loadkeys() expect
+			// a null-terminated string of non-zero length (including null),
+			// but IO_write_string() writes a single zero byte for an empty string
+			// so we need a special case here.
+			if (e->string == nil || e->string[0] == '\0')
+			{
+				// write length + null
+				if ((stat = IO_write_uint1(1, stream)) != IO_NORMAL)
+					return stat;
+				// write null
+				if ((stat = IO_write_uint1(0, stream)) != IO_NORMAL)
+					return stat;
+			}
+			else
+			{
+				if ((stat = IO_write_string(e->string, stream, 1)) != IO_NORMAL)
 					return stat;
+			}
 
-				e = e->next;
+			const char *t_value_str;
+			uint32_t t_value_length;
+			MCExecPoint ep;
+			if (e -> value . ensure_string(ep))
+			{
+				t_value_str = e -> value . get_string() . getstring();
+				t_value_length = e -> value . get_string() . getlength();
 			}
+			else
+			{
+				t_value_str = NULL;
+				t_value_length = 0;
+			}
+
+			uint32_t t_size;
+			if (large)
+				t_size = 4;
+			else
+				t_size = 2;
+			MCString t_string(t_value_str, t_value_length);
+			if ((stat = IO_write_string(t_string, stream, t_size, false)) != IO_NORMAL)
+				return stat;
 		}
 	return IO_NORMAL;
 }
@@ -1678,18 +1738,14 @@ IO_stat MCVariableArray::load(MCObjectInputStream& p_stream, bool p_merge)
 
 	if (t_stat == IO_NORMAL)
 	{
-		uint32_t t_table_size;
-		t_table_size = TABLE_SIZE;
-		while(t_table_size < t_nfilled)
-			t_table_size <<= 1;
-
 		if (p_merge)
 		{
-			if (tablesize < t_table_size)
-				resizehash(t_table_size);
+			vectordrop();
+			if (MCVariableArrayTableSizeFor(nused + t_nfilled) > tablesize)
+				resizehash(nfilled + t_nfilled);
 		}
 		else
-			presethash(t_table_size);
+			presethash(t_nfilled);
 	}
 
 	while(t_stat == IO_NORMAL)
@@ -1701,17 +1757,11 @@ IO_stat MCVariableArray::load(MCObjectInputStream& p_stream, bool p_merge)
 
 		t_entry -> hash = computehash(t_entry -> string);
 
-		uint32_t t_index;
-		t_index = t_entry -> hash & (tablesize - 1);
-
 		uint4 t_length;
 		t_length = strlen(t_entry -> string);
 		extentfromkey(t_entry -> string);
 		keysize += t_length + 1;
-		t_entry -> next = table[t_index];
-		table[t_index] = t_entry;
-
-		nfilled += 1;
+		insertentry(t_entry);
 	}
 
 	return t_stat;
@@ -1721,19 +1771,9 @@ void MCVariableArray::listelements(MCHashentry **p_entries)
 {
 	uint4 t_count;
 	t_count = 0;
-	for(uint32_t i = 0 ; i < tablesize ; i++)
-	if (table[i] != NULL)
-	{
-		MCHashentry *e = table[i];
-		while (e != NULL)
-		{
-			p_entries[t_count] = e;
-			e = e->next;
-			t_count++;
-			if (t_count == nfilled)
-				break;
-		}
-	}
+	for(uint32_t i = 0 ; i < tablesize && t_count < nfilled ; i++)
+		if (MCHashslotIsLive(table[i]))
+			p_entries[t_count++] = table[i] . entry;
 }
 
 uint4 MCHashentry::Measure(void)
@@ -1217,6 +1217,11 @@ IO_stat MCVariableValue::loadarray(MCObjectInputStream& p_stream, bool p_merge)
 
 MCHashentry *MCVariableArray::lookupindex(uint32_t p_index, Boolean add)
 {
+	// If the array is a vector then existing indices can be fetched directly
+	// without formatting and hashing the key.
+	if (vector != NULL && p_index >= 1 && p_index <= nfilled)
+		return vector[p_index - 1];
+
 	char t_buffer[U4L];
 	sprintf(t_buffer, "%u", p_index);
 	return lookuphash(t_buffer, True, add);
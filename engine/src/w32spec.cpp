@@ -1627,7 +1627,7 @@ Boolean MCS_poll(real8 delay, int fd)
 {
 	Boolean handled = False;
 	int4 n;
-	uint2 i;
+	uint4 i;
 	fd_set rmaskfd, wmaskfd, emaskfd;
 	FD_ZERO(&rmaskfd);
 	FD_ZERO(&wmaskfd);
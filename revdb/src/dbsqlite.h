@@ -95,11 +95,30 @@ class DBConnection_SQLITE : public CDBConnection
 		int getVersion(void) { return 2; }
 
 	protected:
+		// The number of compiled statements kept by each connection.
+		enum { kStatementCacheSize = 16 };
+
+		struct CachedStatement
+		{
+			char *sql;
+			sqlite3_stmt *statement;
+			unsigned int last_used;
+		};
+
 		char *BindVariables(char *query, int oldsize, DBString *args, int numargs, int &newsize);
 		void setErrorStr(const char *msg);
 
+		bool preparedExec(const char *query, DBString *args, int numargs, unsigned int &affectedrows, int &r_result);
+		sqlite3_stmt *getStatement(const char *sql);
+		void flushStatements();
+
 		SqliteDatabase mDB;
 		char *mErrorStr;
 		bool mIsError;
+
+		// Statements compiled by sqlExecute, keyed by the text of the query with
+		// its placeholders rewritten in SQLite's ?N form.
+		CachedStatement mStatements[kStatementCacheSize];
+		unsigned int mStatementClock;
 };
 #endif
@@ -48,6 +48,22 @@ public:
 		m_frontier = m_frontier + p_length;
 	}
 
+	const void *getdata(void) const
+	{
+		return m_data;
+	}
+
+	unsigned int getlength(void) const
+	{
+		return m_frontier - m_data;
+	}
+
+	// Empty the buffer, keeping its storage for reuse.
+	void clear(void)
+	{
+		m_frontier = m_data;
+	}
+
 	void grab(void*& r_data, unsigned int& r_length)
 	{
 		r_length = m_frontier - m_data;
@@ -63,6 +63,7 @@ enum RevDBErrs
 	REVDBERR_NOT_SUPPORTED,
 	REVDBERR_NOFILEPERMS,
 	REVDBERR_NONETPERMS,
+	REVDBERR_FILEIO,
 };
 
 const char *errors[] = {
@@ -77,6 +78,7 @@ const char *errors[] = {
 	"revdberr,not supported by driver",
 	"revdberr,file access not permitted",
 	"revdberr,network access not permitted",
+	"revdberr,unable to write file",
 };
 
 #define REVDB_PERMISSION_NONE		(0)
@@ -1144,6 +1146,59 @@ void REVDB_Query(char *p_arguments[], int p_argument_count, char **p_return_stri
 	*p_return_string = (t_result != NULL ? t_result : (char *)calloc(1,1));
 }
 
+// Append the given column of the cursor's current record to the buffer.
+static void AppendCursorField(DBCursor *p_cursor, int p_column, large_buffer_t& x_buffer)
+{
+	unsigned int t_column_size;
+	char *t_column_data;
+	t_column_data = p_cursor -> getFieldDataBinary(p_column, t_column_size);
+
+	if (p_cursor -> getFieldType(p_column) != FT_WSTRING)
+		x_buffer . append(t_column_data, t_column_size);
+	else
+	{
+		char *t_converted_string;
+		t_converted_string = string_from_utf16((unsigned short *)t_column_data, t_column_size / 2);
+		x_buffer . append(t_converted_string, t_column_size / 2);
+		free(t_converted_string);
+	}
+}
+
+// Append the cursor's current record to the buffer, separating its columns with
+// the given delimiter.
+static void AppendCursorRecord(DBCursor *p_cursor, large_buffer_t& x_buffer, const char *p_column_delimiter, unsigned int p_column_delimiter_length)
+{
+	int t_field_count;
+	t_field_count = p_cursor -> getFieldCount();
+
+	for (int i = 1; i <= t_field_count; i++)
+	{
+		AppendCursorField(p_cursor, i, x_buffer);
+
+		if (i != t_field_count)
+			x_buffer . append(p_column_delimiter, p_column_delimiter_length);
+	}
+}
+
+// Hand the contents of the buffer back as a nul-terminated return string.
+static char *GrabResultString(large_buffer_t& x_buffer)
+{
+	x_buffer . append('\0');
+
+	void *t_data;
+	unsigned int t_data_length;
+	x_buffer . grab(t_data, t_data_length);
+
+	// Make sure we null terminate the buffer at the last byte - we need to do this
+	// in case the memory allocation in x_buffer fails (and so subsequent appends
+	// fail).
+	if (t_data == NULL)
+		return (char *)calloc(1, 1);
+	((char *)t_data)[t_data_length - 1] = '\0';
+
+	return (char *)t_data;
+}
+
 void REVDB_QueryList(char *p_arguments[], int p_argument_count, char **p_return_string, Bool *p_pass, Bool *p_error)
 {
 	*p_error = True;
@@ -1216,35 +1271,14 @@ void REVDB_QueryList(char *p_arguments[], int p_argument_count, char **p_return_
 	}
 
 	// Build up the return data
-	int t_field_count;
-	t_field_count = t_cursor -> getFieldCount();
-
 	large_buffer_t t_result;
 
 	if (!t_cursor -> getEOF())
 	{
 		while (True)
 		{
-			for (int i = 1; i <= t_field_count; i++)
-			{
-				unsigned int t_column_size;
-				char *t_column_data;
-				t_column_data = t_cursor -> getFieldDataBinary(i, t_column_size);
-
-				if (t_cursor -> getFieldType(i) != FT_WSTRING)
-					t_result . append(t_column_data, t_column_size);
-				else
-				{
-					char *t_converted_string;
-					t_converted_string = string_from_utf16((unsigned short *)t_column_data, t_column_size / 2);
-					t_result . append(t_converted_string, t_column_size / 2);
-					free(t_converted_string);
-				}
+			AppendCursorRecord(t_cursor, t_result, t_column_delimiter, t_column_delimiter_length);
 
-				if (i != t_field_count)
-					t_result . append(t_column_delimiter, t_column_delimiter_length);
-
-			}
 			t_cursor -> next();
 			if (t_cursor -> getEOF())
 				break;
@@ -1265,18 +1299,239 @@ void REVDB_QueryList(char *p_arguments[], int p_argument_count, char **p_return_
 		delete[] t_values;
 	}
 
-	t_result . append('\0');
+	*p_return_string = GrabResultString(t_result);
+}
 
-	void *t_data;
-	unsigned int t_data_length;
-	t_result . grab(t_data, t_data_length);
+/// @brief Returns a block of records from a cursor, moving past them.
+/// @param pCursorId The integer id of the cursor
+/// @param pRecordCount The maximum number of records to return
+/// @param pColumnDelimiter (optional) The column delimiter, tab by default
+/// @param pRowDelimiter (optional) The row delimiter, return by default
+///
+/// Records are returned in the same form as revDataFromQuery, starting with the
+/// current record. Calling this repeatedly until the cursor is at its end
+/// fetches a result set a block at a time, rather than all at once.
+void REVDB_CursorRows(char *p_arguments[], int p_argument_count, char **p_return_string, Bool *p_pass, Bool *p_error)
+{
+	*p_error = True;
+	*p_pass = False;
 
-	// Make sure we null terminate the buffer at the last byte - we need to do this
-	// in case the memory allocation in t_result fails (and so subsequent appends
-	// fail).
-	((char *)t_data)[t_data_length - 1] = '\0';
+	if (p_argument_count < 2 || atoi(p_arguments[1]) < 1)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_SYNTAX]);
+		return;
+	}
+
+	DBCursor *t_cursor;
+	t_cursor = findcursor(atoi(p_arguments[0]));
+	if (t_cursor == NULL)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_BADCURSOR]);
+		return;
+	}
+
+	*p_error = False;
+
+	int t_record_count;
+	t_record_count = atoi(p_arguments[1]);
+
+	const char *t_column_delimiter;
+	t_column_delimiter = p_argument_count > 2 && p_arguments[2][0] != '\0' ? p_arguments[2] : "\t";
+
+	const char *t_row_delimiter;
+	t_row_delimiter = p_argument_count > 3 && p_arguments[3][0] != '\0' ? p_arguments[3] : "\n";
+
+	large_buffer_t t_result;
+	for(int i = 0; i < t_record_count && !t_cursor -> getEOF(); i++)
+	{
+		if (i != 0)
+			t_result . append(t_row_delimiter, strlen(t_row_delimiter));
+
+		AppendCursorRecord(t_cursor, t_result, t_column_delimiter, strlen(t_column_delimiter));
+
+		t_cursor -> next();
+	}
+
+	*p_return_string = GrabResultString(t_result);
+}
+
+/// @brief Returns one column of a block of records from a cursor.
+/// @param pCursorId The integer id of the cursor
+/// @param pColumnNumber The number of the column to return
+/// @param pRecordCount The maximum number of records to return
+/// @param pRowDelimiter (optional) The row delimiter, return by default
+///
+/// The values are taken from the current record onwards, and the cursor is left
+/// where it was so that the other columns of the same records can be fetched.
+/// The cursor must support moving to a given record.
+void REVDB_CursorColumn(char *p_arguments[], int p_argument_count, char **p_return_string, Bool *p_pass, Bool *p_error)
+{
+	*p_error = True;
+	*p_pass = False;
+
+	if (p_argument_count < 3 || atoi(p_arguments[2]) < 1)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_SYNTAX]);
+		return;
+	}
+
+	DBCursor *t_cursor;
+	t_cursor = findcursor(atoi(p_arguments[0]));
+	if (t_cursor == NULL)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_BADCURSOR]);
+		return;
+	}
+
+	int t_column;
+	t_column = atoi(p_arguments[1]);
+	if (t_column < 1 || t_column > t_cursor -> getFieldCount())
+	{
+		*p_return_string = istrdup(errors[REVDBERR_BADCOLUMNNUM]);
+		return;
+	}
+
+	// Restoring the position needs random access.
+	if (((CDBConnection *)t_cursor -> getConnection()) -> isLegacy() || static_cast<DBCursor2 *>(t_cursor) -> getVersion() < 3)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_NOT_SUPPORTED]);
+		return;
+	}
+
+	*p_error = False;
+
+	int t_record_count;
+	t_record_count = atoi(p_arguments[2]);
+
+	const char *t_row_delimiter;
+	t_row_delimiter = p_argument_count > 3 && p_arguments[3][0] != '\0' ? p_arguments[3] : "\n";
+
+	if (t_cursor -> getEOF())
+	{
+		*p_return_string = (char *)calloc(1, 1);
+		return;
+	}
+
+	int t_start_record;
+	t_start_record = t_cursor -> getRecordNumber();
+
+	large_buffer_t t_result;
+	for(int i = 0; i < t_record_count && !t_cursor -> getEOF(); i++)
+	{
+		if (i != 0)
+			t_result . append(t_row_delimiter, strlen(t_row_delimiter));
+
+		AppendCursorField(t_cursor, t_column, t_result);
+
+		t_cursor -> next();
+	}
+
+	static_cast<DBCursor3 *>(t_cursor) -> move(t_start_record);
+
+	*p_return_string = GrabResultString(t_result);
+}
+
+/// @brief Writes the remaining records of a cursor to a file.
+/// @param pCursorId The integer id of the cursor
+/// @param pFilename The file to write the records to
+/// @param pColumnDelimiter (optional) The column delimiter, tab by default
+/// @param pRowDelimiter (optional) The row delimiter, return by default
+///
+/// The records are written from the current record onwards in the same form as
+/// revDataFromQuery, a block at a time, so the text of the whole result set is
+/// never held in memory. The result is the number of records written.
+void REVDB_CursorToFile(char *p_arguments[], int p_argument_count, char **p_return_string, Bool *p_pass, Bool *p_error)
+{
+	*p_error = True;
+	*p_pass = False;
+
+	if (p_argument_count < 2)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_SYNTAX]);
+		return;
+	}
+
+	DBCursor *t_cursor;
+	t_cursor = findcursor(atoi(p_arguments[0]));
+	if (t_cursor == NULL)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_BADCURSOR]);
+		return;
+	}
+
+	if (!SecurityCanAccessFile(p_arguments[1]))
+	{
+		*p_return_string = istrdup(errors[REVDBERR_NOFILEPERMS]);
+		return;
+	}
+
+	const char *t_column_delimiter;
+	t_column_delimiter = p_argument_count > 2 && p_arguments[2][0] != '\0' ? p_arguments[2] : "\t";
+
+	const char *t_row_delimiter;
+	t_row_delimiter = p_argument_count > 3 && p_arguments[3][0] != '\0' ? p_arguments[3] : "\n";
+
+	char *t_native_path;
+	t_native_path = os_path_to_native(p_arguments[1]);
+
+	char *t_resolved_path;
+	t_resolved_path = os_path_resolve(t_native_path);
+	free(t_native_path);
+
+	FILE *t_file;
+	t_file = fopen(t_resolved_path, "wb");
+	free(t_resolved_path);
+
+	if (t_file == NULL)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_FILEIO]);
+		return;
+	}
 
-	*p_return_string = (char *)t_data;
+	*p_error = False;
+
+	// Records are accumulated in the buffer and written out whenever it grows
+	// beyond this many bytes.
+	const unsigned int t_block_size = 65536;
+
+	bool t_success;
+	t_success = true;
+
+	int t_records;
+	t_records = 0;
+
+	large_buffer_t t_buffer;
+	while(t_success && !t_cursor -> getEOF())
+	{
+		if (t_records != 0)
+			t_buffer . append(t_row_delimiter, strlen(t_row_delimiter));
+
+		AppendCursorRecord(t_cursor, t_buffer, t_column_delimiter, strlen(t_column_delimiter));
+		t_records++;
+
+		t_cursor -> next();
+
+		if (t_buffer . getlength() >= t_block_size || t_cursor -> getEOF())
+		{
+			if (fwrite(t_buffer . getdata(), 1, t_buffer . getlength(), t_file) != t_buffer . getlength())
+				t_success = false;
+			t_buffer . clear();
+		}
+	}
+
+	if (fclose(t_file) != 0)
+		t_success = false;
+
+	if (!t_success)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_FILEIO]);
+		return;
+	}
+
+	char *t_result;
+	t_result = (char *)malloc(INTSTRSIZE);
+	sprintf(t_result, "%d", t_records);
+	*p_return_string = t_result;
 }
 
 //revdb_closecursor(cursorid) - close database cursor
@@ -2281,6 +2536,9 @@ EXTERNAL_BEGIN_DECLARATIONS("revDB")
 	EXTERNAL_DECLARE_FUNCTION("revdb_valentinadbref", REVDB_ValentinaConnectionRef)
 	EXTERNAL_DECLARE_FUNCTION("revdb_valentinacursorref", REVDB_ValentinaCursorRef)
 	EXTERNAL_DECLARE_FUNCTION("revdb_querylist", REVDB_QueryList)
+	EXTERNAL_DECLARE_FUNCTION("revdb_cursorrows", REVDB_CursorRows)
+	EXTERNAL_DECLARE_FUNCTION("revdb_cursorcolumn", REVDB_CursorColumn)
+	EXTERNAL_DECLARE_FUNCTION("revdb_cursortofile", REVDB_CursorToFile)
 	EXTERNAL_DECLARE_FUNCTION("revdb_valentinadbreftoconnection", REVDB_ValentinaDBRefToConnection)
 	EXTERNAL_DECLARE_FUNCTION("revdb_getvalentinadbref", REVDB_GetValentinaDBRef)
 	EXTERNAL_DECLARE_FUNCTION("revdb_valentina", REVDB_Valentina)
@@ -2327,6 +2585,9 @@ EXTERNAL_BEGIN_DECLARATIONS("revDB")
 	EXTERNAL_DECLARE_FUNCTION("revdb_valentinadbref", REVDB_ValentinaConnectionRef)
 	EXTERNAL_DECLARE_FUNCTION("revdb_valentinacursorref", REVDB_ValentinaCursorRef)
 	EXTERNAL_DECLARE_FUNCTION("revDataFromQuery", REVDB_QueryList)
+	EXTERNAL_DECLARE_FUNCTION("revDataFromCursor", REVDB_CursorRows)
+	EXTERNAL_DECLARE_FUNCTION("revColumnDataFromCursor", REVDB_CursorColumn)
+	EXTERNAL_DECLARE_FUNCTION("revExportCursorToFile", REVDB_CursorToFile)
 	EXTERNAL_DECLARE_FUNCTION("revdb_valentinadbreftoconnection", REVDB_ValentinaDBRefToConnection)
 	EXTERNAL_DECLARE_FUNCTION("revdb_getvalentinadbref", REVDB_GetValentinaDBRef)
 	EXTERNAL_DECLARE_FUNCTION("revdb_valentina", REVDB_Valentina)
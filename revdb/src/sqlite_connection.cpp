@@ -20,6 +20,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include <sqlitedecode.h>
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 
 #include <sstream>
@@ -28,9 +29,11 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 DBConnection_SQLITE::DBConnection_SQLITE() :
 	mErrorStr(0),
-	mIsError(false)
+	mIsError(false),
+	mStatementClock(0)
 {
 	connectionType = CT_SQLITE;
+	memset(mStatements, 0, sizeof(mStatements));
 }
 
 DBConnection_SQLITE::~DBConnection_SQLITE()
@@ -96,6 +99,9 @@ void DBConnection_SQLITE::disconnect()
 		//close all open cursors from this connection
 		closeCursors();
 
+		// Compiled statements must be finalized before the database can close.
+		flushStatements();
+
 		//close mysql connection
 		mDB.disconnect();
 		isConnected = False;
@@ -123,14 +129,25 @@ Bool DBConnection_SQLITE::sqlExecute(char *query, DBString *args, int numargs, u
 
 		MDEBUG("args=%d, numargs=%d\n", args != 0);
 
-		if(numargs > 0)
+		// Single statements are compiled once and run with their arguments
+		// bound. Anything else (multiple statements, or ones SQLite won't
+		// prepare) falls back to substituting the arguments into the text.
+		int rv;
+		if (!preparedExec(query, args, numargs, affectedrows, rv))
 		{
-			int newsize;
-			newquery = BindVariables(query, qlength, args, numargs, newsize);
-			qlength = newsize;
+			if(numargs > 0)
+			{
+				int newsize;
+				newquery = BindVariables(query, qlength, args, numargs, newsize);
+				qlength = newsize;
+			}
+
+			rv = basicExec(newquery, &affectedrows);
+
+			if (numargs > 0)
+				free(newquery);
 		}
 
-		int rv = basicExec(newquery, &affectedrows);
 		if(rv != SQLITE_OK)
 		{
 			// MW-2008-07-29: [[ Bug 6639 ]] Executing a query doesn't return meaningful error messages.
@@ -541,6 +558,201 @@ int DBConnection_SQLITE::basicExec(const char *q, unsigned int *rows)
 	return t_return_value;
 }
 
+// Rewrite each :N placeholder as SQLite's own ?N parameter syntax so that the
+// statement can be compiled once and the arguments bound natively.
+static bool placeholderCallback(void *p_context, int p_placeholder, DBBuffer& p_output)
+{
+	char t_parameter[16];
+	sprintf(t_parameter, "?%d", p_placeholder);
+	return p_output . append(t_parameter, strlen(t_parameter));
+}
+
+// Returns true if only whitespace and semicolons remain after a statement.
+static bool isEmptyTail(const char *p_tail)
+{
+	if (p_tail == NULL)
+		return true;
+
+	for(; *p_tail != '\0'; p_tail++)
+		if (*p_tail != ';' && !isspace((unsigned char)*p_tail))
+			return false;
+
+	return true;
+}
+
+// Find the compiled statement for the given (rewritten) query, compiling and
+// caching it if needed. Returns NULL if the query isn't a single statement that
+// SQLite can prepare.
+sqlite3_stmt *DBConnection_SQLITE::getStatement(const char *p_sql)
+{
+	mStatementClock++;
+
+	// Look for the statement, keeping track of the least recently used entry
+	// in case we need to replace it.
+	int t_oldest;
+	t_oldest = 0;
+	for(int i = 0; i < kStatementCacheSize; i++)
+	{
+		if (mStatements[i] . sql != NULL && strcmp(mStatements[i] . sql, p_sql) == 0)
+		{
+			mStatements[i] . last_used = mStatementClock;
+			return mStatements[i] . statement;
+		}
+
+		if (mStatements[i] . sql == NULL || mStatements[i] . last_used < mStatements[t_oldest] . last_used)
+			t_oldest = i;
+	}
+
+	sqlite3_stmt *t_statement;
+	t_statement = NULL;
+
+	const char *t_tail;
+	t_tail = NULL;
+
+	if (sqlite3_prepare_v2(mDB.getHandle(), p_sql, -1, &t_statement, &t_tail) != SQLITE_OK || t_statement == NULL)
+		return NULL;
+
+	// Scripts of several statements are left to sqlite3_exec.
+	char *t_sql;
+	t_sql = NULL;
+	if (!isEmptyTail(t_tail) || (t_sql = strdup(p_sql)) == NULL)
+	{
+		sqlite3_finalize(t_statement);
+		return NULL;
+	}
+
+	if (mStatements[t_oldest] . sql != NULL)
+	{
+		sqlite3_finalize(mStatements[t_oldest] . statement);
+		free(mStatements[t_oldest] . sql);
+	}
+
+	mStatements[t_oldest] . sql = t_sql;
+	mStatements[t_oldest] . statement = t_statement;
+	mStatements[t_oldest] . last_used = mStatementClock;
+
+	return t_statement;
+}
+
+void DBConnection_SQLITE::flushStatements()
+{
+	for(int i = 0; i < kStatementCacheSize; i++)
+	{
+		if (mStatements[i] . sql == NULL)
+			continue;
+
+		sqlite3_finalize(mStatements[i] . statement);
+		free(mStatements[i] . sql);
+
+		mStatements[i] . sql = NULL;
+		mStatements[i] . statement = NULL;
+	}
+}
+
+/*preparedExec - executes query through a cached compiled statement, binding
+the arguments rather than substituting them into the text. Arguments are
+stored exactly as the substituted form would store them: text up to any nul,
+and binary data in the same sqlite_encode_binary form.
+Output: false if the query can't be executed this way, otherwise true with the
+sqlite result code in r_result*/
+bool DBConnection_SQLITE::preparedExec(const char *p_query, DBString *p_arguments, int p_argument_count, unsigned int &r_affected_rows, int &r_result)
+{
+	DBBuffer t_query_buffer(strlen(p_query) + 1);
+	if (!processQuery(p_query, t_query_buffer, placeholderCallback, NULL) ||
+		!t_query_buffer . append("", 1))
+		return false;
+
+	sqlite3_stmt *t_statement;
+	t_statement = getStatement(t_query_buffer . borrow());
+	if (t_statement == NULL)
+		return false;
+
+	// Bind every parameter the statement has, so none are left over from the
+	// previous execution. Parameters with no corresponding argument are NULL.
+	int t_result;
+	t_result = SQLITE_OK;
+
+	int t_parameter_count;
+	t_parameter_count = sqlite3_bind_parameter_count(t_statement);
+	for(int i = 1; i <= t_parameter_count && t_result == SQLITE_OK; i++)
+	{
+		const char *t_name;
+		t_name = sqlite3_bind_parameter_name(t_statement, i);
+
+		int t_argument;
+		t_argument = 0;
+		if (t_name != NULL && t_name[0] == '?')
+			t_argument = atoi(t_name + 1);
+
+		if (t_argument < 1 || t_argument > p_argument_count)
+		{
+			t_result = sqlite3_bind_null(t_statement, i);
+			continue;
+		}
+
+		const DBString &t_value = p_arguments[t_argument - 1];
+		if (t_value . isbinary)
+		{
+			// According to documentation in sqlitedecode.cpp, this is the required size of output buffer
+			unsigned char *t_encoded;
+			t_encoded = (unsigned char *)malloc(2 + (257 * t_value . length) / 254);
+			if (t_encoded == NULL)
+				t_result = SQLITE_NOMEM;
+			else
+			{
+				int t_encoded_length;
+				t_encoded_length = sqlite_encode_binary((const unsigned char *)t_value . sptr, t_value . length, t_encoded);
+				t_result = sqlite3_bind_text(t_statement, i, (const char *)t_encoded, t_encoded_length, SQLITE_TRANSIENT);
+				free(t_encoded);
+			}
+		}
+		else
+		{
+			const char *t_nul;
+			t_nul = t_value . length != 0 ? (const char *)memchr(t_value . sptr, '\0', t_value . length) : NULL;
+			
+			int t_length;
+			t_length = t_nul != NULL ? t_nul - t_value . sptr : t_value . length;
+
+			t_result = sqlite3_bind_text(t_statement, i, t_length != 0 ? t_value . sptr : "", t_length, SQLITE_TRANSIENT);
+		}
+	}
+
+	// Run the statement, counting changes in the same way as basicExec: if the
+	// statement returns rows, no rows are considered affected.
+	bool t_has_rows;
+	t_has_rows = false;
+
+	int t_changed_row_count;
+	t_changed_row_count = 0;
+
+	if (t_result == SQLITE_OK)
+	{
+		sqlite3_update_hook(mDB.getHandle(), dataChangeCallback, &t_changed_row_count);
+
+		while((t_result = sqlite3_step(t_statement)) == SQLITE_ROW)
+			t_has_rows = true;
+
+		sqlite3_update_hook(mDB.getHandle(), NULL, NULL);
+
+		if (t_result == SQLITE_DONE)
+			t_result = SQLITE_OK;
+	}
+
+	if (t_result != SQLITE_OK)
+	{
+		mIsError = true;
+		setErrorStr(sqlite3_errmsg(mDB.getHandle()));
+	}
+
+	sqlite3_reset(t_statement);
+
+	r_affected_rows = t_has_rows ? 0 : t_changed_row_count;
+	r_result = t_result;
+
+	return true;
+}
+
 void DBConnection_SQLITE::setErrorStr(const char *msg)
 {
 	MDEBUG("\nsetErrorStr(%s)\n", msg);
@@ -0,0 +1,59 @@
+#!/bin/sh
+# Sends requests to the server engine running as a FastCGI responder. Checks
+# that the workers serve several requests each, and that a global set by one
+# request is empty in the next.
+#
+# Needs cgi-fcgi from the FastCGI development kit (libfcgi-bin on Debian).
+#
+# Usage: tools/benchmarks/fastcgi.sh <server-engine> [<count>]
+
+ENGINE=$1
+COUNT=${2:-200}
+if [ -z "$ENGINE" ]; then
+	echo "usage: $0 <server-engine> [<count>]" >&2
+	exit 2
+fi
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+SOCKET=${TMPDIR:-/tmp}/lcfastcgi.$$
+PIDS=${TMPDIR:-/tmp}/lcfastcgi.$$.pids
+
+LIVECODE_SERVER_FASTCGI_WORKERS=2 LIVECODE_SERVER_FASTCGI_MAX_REQUESTS=50 \
+	cgi-fcgi -start -connect "$SOCKET" "$ENGINE" || exit 1
+
+FAILURES=0
+START=$(date +%s%N)
+i=1
+while [ $i -le $COUNT ]; do
+	LINE=$(env -i GATEWAY_INTERFACE=CGI/1.1 REQUEST_METHOD=GET \
+		SCRIPT_FILENAME="$DIR/fastcgi.lc" PATH_TRANSLATED="$DIR/fastcgi.lc" \
+		QUERY_STRING="n=$i" cgi-fcgi -bind -connect "$SOCKET" | tail -n 1)
+	set -- $LINE
+	if [ "$2" != "[]" ] || [ "$3" != "$i" ]; then
+		echo "FAILED: request $i returned '$LINE'"
+		FAILURES=$((FAILURES + 1))
+	fi
+	echo "$1" >> "$PIDS"
+	i=$((i + 1))
+done
+END=$(date +%s%N)
+
+echo "$COUNT requests: $(( (END - START) / 1000000 )) ms"
+
+WORKERS=$(sort -u "$PIDS" | wc -l)
+echo "Served by $WORKERS workers"
+if [ "$WORKERS" -ge "$COUNT" ]; then
+	echo "FAILED: no worker served more than one request"
+	FAILURES=$((FAILURES + 1))
+fi
+
+# Stop the master, which is the parent of the workers.
+MASTER=$(ps -o ppid= -p "$(tail -n 1 "$PIDS")")
+[ -n "$MASTER" ] && kill $MASTER
+rm -f "$PIDS" "$SOCKET"
+
+if [ $FAILURES -gt 0 ]; then
+	echo "$FAILURES checks failed"
+	exit 1
+fi
+echo "All checks passed"
@@ -0,0 +1,80 @@
+#!/bin/sh
+# Runs concurrent CGI requests against the server engine's session store. Each
+# request adds one to a count held in its session. Timings are reported with
+# every writer sharing one session, where no update may be lost, and with a
+# session per writer, where the writers shouldn't contend at all.
+#
+# Setting LIVECODE_SERVER_SESSION_STORE=index selects the old single index
+# file store for comparison.
+#
+# Usage: tools/benchmarks/sessions.sh <server-engine> [<writers> [<requests>]]
+
+ENGINE=$1
+WRITERS=${2:-8}
+REQUESTS=${3:-100}
+if [ -z "$ENGINE" ]; then
+	echo "usage: $0 <server-engine> [<writers> [<requests>]]" >&2
+	exit 2
+fi
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+SAVE_PATH=$(mktemp -d) || exit 1
+FAILURES=0
+
+# Run one request against the session with the given id and output the count.
+request()
+{
+	GATEWAY_INTERFACE=CGI/1.1 REQUEST_METHOD=GET REMOTE_ADDR=127.0.0.1 \
+		PATH_TRANSLATED="$DIR/sessions.lc" QUERY_STRING="id=$1&path=$SAVE_PATH" \
+		"$ENGINE" | tail -n 1
+}
+
+# Run the writers concurrently. Each uses the session "<prefix><n>", where n is
+# the writer's number if 'separate' is given and 0 otherwise.
+run()
+{
+	START=$(date +%s%N)
+	w=1
+	while [ $w -le $WRITERS ]; do
+		if [ "$2" = separate ]; then ID=$1$w; else ID=${1}0; fi
+		(
+			r=1
+			while [ $r -le $REQUESTS ]; do
+				request $ID > /dev/null
+				r=$((r + 1))
+			done
+		) &
+		w=$((w + 1))
+	done
+	wait
+	END=$(date +%s%N)
+	if [ "$2" = separate ]; then LABEL="a session each"; else LABEL="one session"; fi
+	echo "$WRITERS writers, $REQUESTS requests each, $LABEL: $(( (END - START) / 1000000 )) ms"
+}
+
+check()
+{
+	COUNT=$(request $1)
+	if [ "$COUNT" != "$2" ]; then
+		echo "FAILED: session $1 has count '$COUNT', expected $2"
+		FAILURES=$((FAILURES + 1))
+	fi
+}
+
+run shared shared
+check shared0 $((WRITERS * REQUESTS + 1))
+
+run separate separate
+w=1
+while [ $w -le $WRITERS ]; do
+	check separate$w $((REQUESTS + 1))
+	w=$((w + 1))
+done
+
+rm -rf "$SAVE_PATH"
+
+if [ $FAILURES -gt 0 ]; then
+	echo "$FAILURES checks failed"
+	exit 1
+fi
+echo "All checks passed"